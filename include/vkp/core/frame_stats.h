@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vkp::core {
+
+    struct FrameSample {
+        uint64_t end_ns;   // core::Profiler::now() when the frame finished on the CPU
+        float    frame_ms; // interval since the previous frame started
+        float    cpu_ms;   // render-thread time spent on this frame, including waits
+        float    gpu_ms;   // timestamp span of a completed frame (lags by the frames in flight), 0 if unknown
+    };
+
+    // Fixed-size ring of per-frame samples with a single writer. push() never blocks or
+    // allocates; readers on any thread get consistent copies through per-slot sequence
+    // numbers and skip slots the writer has lapped meanwhile.
+    class FrameStatsRing {
+    public:
+        static constexpr size_t CAPACITY = 1 << 13; // ~68 s at 120 Hz
+
+        FrameStatsRing();
+
+        FrameStatsRing(const FrameStatsRing&) = delete;
+        FrameStatsRing& operator=(const FrameStatsRing&) = delete;
+
+        // Writer thread only.
+        void push(const FrameSample& sample);
+
+        // Up to `maxCount` of the newest samples, oldest first.
+        [[nodiscard]] std::vector<FrameSample> latest(size_t maxCount) const;
+        // Samples that ended at or after `since_ns`, oldest first.
+        [[nodiscard]] std::vector<FrameSample> since(uint64_t since_ns) const;
+        // Number of samples ever pushed.
+        [[nodiscard]] uint64_t total() const { return head_.load(std::memory_order_acquire); }
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> seq{ 0 }; // 2*i+1 while sample i is written, 2*i+2 once complete
+            std::atomic<uint64_t> end_ns{ 0 };
+            std::atomic<float>    frame_ms{ 0.f };
+            std::atomic<float>    cpu_ms{ 0.f };
+            std::atomic<float>    gpu_ms{ 0.f };
+        };
+
+        bool read(uint64_t index, FrameSample& out) const;
+
+        std::unique_ptr<Slot[]> slots_;
+        std::atomic<uint64_t>   head_{ 0 };
+    };
+
+    struct FrameStatsSummary {
+        size_t count       = 0;
+        float  p50_ms      = 0.f;
+        float  p99_ms      = 0.f;
+        float  max_ms      = 0.f;
+        float  gpu_p50_ms  = 0.f;
+        float  gpu_p99_ms  = 0.f;
+        float  gpu_max_ms  = 0.f;
+        size_t over_budget = 0;   // frames whose frame_ms exceeded the budget
+    };
+
+    // Nearest-rank percentiles of frame and GPU times; GPU samples of 0 are ignored.
+    FrameStatsSummary summarize(const std::vector<FrameSample>& samples, float budget_ms);
+
+} // namespace vkp::core
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "profiler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace vkp::core {
+
+    // Flags a frame over budget and appends a short report of what it did: its CPU scopes
+    // (with REND_PROFILE), its GPU timestamps and any blocking events noted while it ran.
+    // note() may be called from any thread; everything else belongs to the render thread.
+    class HitchDetector {
+    public:
+        enum Event : uint32_t {
+            SwapchainRecreate = 1u << 0,
+            PipelineCreate    = 1u << 1,
+            QueueWaitIdle     = 1u << 2,
+            DeviceWaitIdle    = 1u << 3,
+        };
+
+        static HitchDetector& get();
+
+        void configure(float budgetMs, std::string reportPath);
+
+        void note(Event event) { events_.fetch_or(event, std::memory_order_relaxed); }
+
+        void beginFrame(uint64_t startNs);
+        // `submitted` is false when the frame recorded no GPU work (e.g. it recreated the
+        // swap chain instead); otherwise the report waits for that frame's GPU results.
+        void endFrame(uint64_t frameNumber, uint64_t endNs, bool submitted);
+
+        [[nodiscard]] bool awaitingGpu() const { return !pending_.empty(); }
+        // GPU scopes of `frameNumber`, in the CPU timebase.
+        void gpuResults(uint64_t frameNumber, const std::vector<ProfileEvent>& scopes);
+
+        // Writes hitches still waiting for GPU results.
+        void flush();
+
+        [[nodiscard]] uint64_t hitchCount() const { return hitchCount_; }
+
+    private:
+        struct Hitch {
+            uint64_t                  frameNumber;
+            uint64_t                  startNs;
+            float                     ms;
+            uint32_t                  events;
+            std::vector<ProfileEvent> cpu;
+            std::vector<ProfileEvent> gpu;
+        };
+
+        HitchDetector() = default;
+
+        void write(const Hitch& hitch) const;
+
+        float                  budgetMs_   = 1000.f / 60.f;
+        std::string            reportPath_ = "engine/logs/hitches.txt";
+        std::atomic<uint32_t>  events_{ 0 };
+        uint64_t               frameStartNs_ = 0;
+        std::deque<Hitch>      pending_;
+        uint64_t               hitchCount_   = 0;
+    };
+
+} // namespace vkp::core
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vkp::core {
+
+    enum class ImageFileFormat {
+        PNG,
+        PPM,
+        RAW
+    };
+
+    // Byte order of 8-bit, 4-channel source pixels.
+    enum class PixelOrder {
+        RGBA,
+        BGRA
+    };
+
+    // Tightly packed 8-bit RGBA/BGRA rows, top row first.
+    struct ImageView8 {
+        const uint8_t* pixels;
+        uint32_t       width;
+        uint32_t       height;
+        PixelOrder     order;
+    };
+
+    [[nodiscard]] const char* fileExtension(ImageFileFormat format);
+    [[nodiscard]] bool parseImageFileFormat(const std::string& name, ImageFileFormat& format);
+
+    // PNG (RGBA, stored deflate blocks: no compression, but fast and dependency-free),
+    // binary PPM (RGB) or the raw source bytes.
+    bool writeImage(const std::string& path, const ImageView8& image, ImageFileFormat format);
+
+} // namespace vkp::core
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkp::core {
+
+    using Job = std::function<void()>;
+
+    // Outstanding jobs scheduled against it. Jobs can be chained behind a counter with
+    // JobSystem::scheduleAfter, and the first exception thrown by one of its jobs is rethrown
+    // by JobSystem::wait. Reusable once waited on; destroy it only after wait() returned.
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        [[nodiscard]] bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        struct Deferred {
+            Job         job;
+            JobCounter* counter;
+        };
+
+        std::atomic<uint32_t> pending_{ 0 };
+        std::mutex            mutex_;
+        std::vector<Deferred> continuations_;
+        std::exception_ptr    error_;
+    };
+
+    // The engine's shared task runtime. Each worker owns a deque: it pushes and pops its own jobs
+    // at the back, while idle workers steal the oldest from the front of others. Jobs scheduled
+    // from outside the pool are spread round-robin. A thread waiting on a counter runs jobs
+    // instead of blocking, so jobs may wait on jobs they scheduled. GLFW may only be called from
+    // the main thread: scheduleOnMain queues such work for pumpMain(), which the frame loop and
+    // any wait() on the main thread run. Long blocking loops (sockets, pipes) keep their own threads.
+    class JobSystem {
+    public:
+        struct Options {
+            uint32_t workers    = 0;       // 0: one per hardware thread besides the main thread
+            bool     pinThreads = false;   // pin worker i to core i + 1, leaving core 0 to the main thread
+        };
+
+        // Takes effect only before the first get().
+        static void configure(const Options& options);
+        // Created on first use; the thread that first calls it is the main thread.
+        static JobSystem& get();
+
+        ~JobSystem();
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // `counter`, if given, counts the job as outstanding until it has run.
+        void schedule(Job job, JobCounter* counter = nullptr);
+        // Schedules `job` once `dependency` has no outstanding jobs; `counter` counts it from now.
+        void scheduleAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+        void scheduleOnMain(Job job, JobCounter* counter = nullptr);
+
+        // Runs jobs until `counter` has none outstanding, then rethrows the first exception of its jobs.
+        void wait(JobCounter& counter);
+        // Calls fn(begin, end) over [0, count) in chunks of `grain` and waits for all of them.
+        void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)>& fn);
+        // Runs the jobs queued for the main thread. Only on the main thread.
+        void pumpMain();
+
+        [[nodiscard]] bool     isMainThread() const { return std::this_thread::get_id() == mainThread_; }
+        [[nodiscard]] uint32_t workerCount()  const { return static_cast<uint32_t>(workers_.size()); }
+
+        struct Stats {
+            uint64_t executed = 0;
+            uint64_t stolen   = 0;
+        };
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        explicit JobSystem(const Options& options);
+
+        using Entry = JobCounter::Deferred;
+        struct Worker {
+            std::mutex        mutex;
+            std::deque<Entry> jobs;
+            std::thread       thread;
+        };
+
+        void push(Entry entry);
+        bool take(Entry& entry);
+        bool runMainJob();
+        void run(Entry& entry);
+        void finish(JobCounter* counter);
+        void wakeAll();
+        void workerLoop(uint32_t index, bool pin);
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::thread::id                      mainThread_;
+        std::atomic<uint32_t>                nextWorker_{ 0 };
+        std::atomic<uint32_t>                queued_{ 0 };
+
+        std::mutex                           mainMutex_;
+        std::deque<Entry>                    mainJobs_;
+        std::atomic<uint32_t>                mainQueued_{ 0 };
+
+        std::mutex                           wakeMutex_;
+        std::condition_variable              wake_;
+        bool                                 stopping_ = false;
+
+        std::atomic<uint64_t>                executed_{ 0 };
+        std::atomic<uint64_t>                stolen_{ 0 };
+    };
+
+} // namespace vkp::core
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace vkp::core {
+
+    // A whole file mapped read-only. Pages are read in on first touch, so parsing a header
+    // doesn't pull in the rest of the file.
+    class MappedFile {
+    public:
+        // Throws std::runtime_error if the file can't be opened or mapped.
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // nullptr for an empty file.
+        [[nodiscard]] const std::byte* data() const { return data_; }
+        [[nodiscard]] size_t           size() const { return size_; }
+
+    private:
+        const std::byte* data_ = nullptr;
+        size_t           size_ = 0;
+#ifdef _WIN32
+        void*            file_    = nullptr;
+        void*            mapping_ = nullptr;
+#endif
+    };
+
+} // namespace vkp::core
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkp::core {
+
+    // Monotonic count. Updates are a single relaxed atomic add.
+    class Counter {
+    public:
+        void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value_{ 0 };
+    };
+
+    // Last-written value.
+    class Gauge {
+    public:
+        void set(double v) { value_.store(v, std::memory_order_relaxed); }
+        [[nodiscard]] double value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> value_{ 0.0 };
+    };
+
+    // Fixed upper bounds chosen at registration; observe() is a bucket scan plus three atomic adds.
+    class Histogram {
+    public:
+        explicit Histogram(std::vector<double> bounds);
+
+        void observe(double v);
+
+        [[nodiscard]] const std::vector<double>& bounds() const { return bounds_; }
+        // Per-bucket (not cumulative) counts; the last entry is the +Inf bucket.
+        [[nodiscard]] std::vector<uint64_t> counts() const;
+        [[nodiscard]] double   sum()   const { return sum_.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    private:
+        std::vector<double>                    bounds_;
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+        std::atomic<double>                    sum_{ 0.0 };
+        std::atomic<uint64_t>                  count_{ 0 };
+    };
+
+    // Process-wide set of named metrics. Registration takes a lock and is meant for setup or a
+    // function-local static; the returned references stay valid for the process lifetime, so
+    // hot paths only touch atomics. Registering an existing name returns the same metric.
+    class MetricsRegistry {
+    public:
+        static MetricsRegistry& get();
+
+        Counter&   counter(const std::string& name, const std::string& help);
+        Gauge&     gauge(const std::string& name, const std::string& help);
+        Histogram& histogram(const std::string& name, const std::string& help, std::initializer_list<double> bounds);
+
+        // Prometheus text exposition format (version 0.0.4).
+        [[nodiscard]] std::string exposition() const;
+
+    private:
+        enum class Kind { Counter, Gauge, Histogram };
+        struct Entry {
+            std::string name;
+            std::string help;
+            Kind        kind;
+            void*       metric;
+        };
+
+        MetricsRegistry() = default;
+        Entry* find(const std::string& name);
+
+        mutable std::mutex     mutex_;
+        std::vector<Entry>     entries_;
+        std::deque<Counter>    counters_;
+        std::deque<Gauge>      gauges_;
+        std::deque<Histogram>  histograms_;
+    };
+
+} // namespace vkp::core
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace vkp::core {
+
+    // Serves MetricsRegistry::exposition() over HTTP/1.0 from a background thread, on a Unix
+    // domain socket ("unix:/path/to.sock") or on a localhost TCP port ("9464" or
+    // "localhost:9464"). Scrapes only read atomics, so the render thread never waits on them.
+    class MetricsServer {
+    public:
+        explicit MetricsServer(const std::string& endpoint);
+        ~MetricsServer();
+
+        MetricsServer(const MetricsServer&) = delete;
+        MetricsServer& operator=(const MetricsServer&) = delete;
+
+        [[nodiscard]] bool listening() const { return listenFd_ != INVALID; }
+
+    private:
+        static constexpr intptr_t INVALID = -1;
+
+        bool openUnix(const std::string& path);
+        bool openTcp(uint16_t port);
+        void serve();
+        void respond(intptr_t client) const;
+
+        intptr_t          listenFd_ = INVALID;
+        std::string       unixPath_;
+        std::atomic<bool> stopping_{ false };
+        std::thread       thread_;
+    };
+
+} // namespace vkp::core
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkp::core {
+
+    // One completed scope. Names must be string literals (or otherwise outlive the capture).
+    struct ProfileEvent {
+        const char* name;
+        uint64_t    start_ns;
+        uint64_t    end_ns;
+        uint32_t    depth;
+    };
+
+    // Fixed-size ring written only by its owning thread; old events are overwritten.
+    struct ProfileRing {
+        static constexpr size_t CAPACITY = 1 << 16;
+
+        std::array<ProfileEvent, CAPACITY> events{};
+        std::atomic<uint64_t>              head{ 0 };
+        uint32_t                           depth = 0;
+        uint32_t                           tid   = 0;
+        std::string                        thread_name;
+        bool                               in_use = false;  // guarded by the registry mutex
+
+        void push(const ProfileEvent& event) {
+            const uint64_t h = head.load(std::memory_order_relaxed);
+            events[h % CAPACITY] = event;
+            head.store(h + 1, std::memory_order_release);
+        }
+    };
+
+    // Process-wide registry of per-thread rings plus a GPU track, exportable as Chrome
+    // trace_event JSON (chrome://tracing, Perfetto).
+    class Profiler {
+    public:
+        static Profiler& get();
+
+        // Nanoseconds on the steady clock; the shared timebase for CPU and GPU events.
+        static uint64_t now();
+
+        // Ring of the calling thread, registered on first use and reused after the thread exits.
+        ProfileRing& threadRing();
+        void releaseRing(ProfileRing& ring);
+        void setThreadName(const std::string& name);
+
+        // GPU timestamps already converted to the CPU timebase.
+        void recordGpu(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+        // Copies the events of the calling thread that started at or after `since_ns`.
+        std::vector<ProfileEvent> threadEventsSince(uint64_t since_ns);
+        std::vector<ProfileEvent> gpuEventsSince(uint64_t since_ns);
+
+        bool writeChromeTrace(const std::string& path);
+
+        // Forgets every recorded event, e.g. before unloading the code their names live in.
+        // No other thread may be recording meanwhile.
+        void discardEvents();
+
+    private:
+        Profiler();
+
+        static std::vector<ProfileEvent> eventsSince(const ProfileRing& ring, uint64_t since_ns);
+
+        std::mutex                                registry_mutex_;
+        std::vector<std::unique_ptr<ProfileRing>> rings_;
+        std::vector<ProfileRing*>                 free_rings_;
+        std::mutex                                gpu_mutex_;
+        std::unique_ptr<ProfileRing>              gpu_ring_;
+        std::atomic<uint32_t>                     next_tid_{ 1 };
+    };
+
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const char* name)
+            : ring_(Profiler::get().threadRing())
+            , name_(name)
+            , depth_(ring_.depth++)
+            , start_(Profiler::now())
+        {
+        }
+
+        ~ProfileScope() {
+            --ring_.depth;
+            ring_.push({ name_, start_, Profiler::now(), depth_ });
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        ProfileRing& ring_;
+        const char*  name_;
+        uint32_t     depth_;
+        uint64_t     start_;
+    };
+
+} // namespace vkp::core
+
+#define VKP_PROFILE_CONCAT_INNER(a, b) a##b
+#define VKP_PROFILE_CONCAT(a, b) VKP_PROFILE_CONCAT_INNER(a, b)
+
+// Scopes compile to nothing unless the build enables REND_PROFILE.
+#ifdef VKP_PROFILE_ENABLED
+#define VKP_PROFILE_SCOPE(name) \
+    ::vkp::core::ProfileScope VKP_PROFILE_CONCAT(vkp_profile_scope_, __LINE__){ name }
+#define VKP_PROFILE_THREAD(name) ::vkp::core::Profiler::get().setThreadName(name)
+#else
+#define VKP_PROFILE_SCOPE(name) ((void)0)
+#define VKP_PROFILE_THREAD(name) ((void)0)
+#endif
+#define VKP_PROFILE_FUNCTION() VKP_PROFILE_SCOPE(__func__)
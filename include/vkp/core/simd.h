@@ -0,0 +1,258 @@
+#pragma once
+
+// Eight float lanes behind one interface, for CPU code written once for every target:
+// AVX2/FMA when the translation unit is compiled for it (REND_AVX2), two SSE2 or NEON
+// registers otherwise, and plain loops as the last resort. Masks are lane-wide bit patterns,
+// as the comparisons of every backend produce them. Each backend lives in its own inline
+// namespace, so translation units built for different targets can be linked together.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// MSVC's /arch:AVX2 implies FMA but defines no __FMA__.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+    #define VKP_SIMD_AVX2 1
+    #define VKP_SIMD_BACKEND avx2
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VKP_SIMD_SSE2 1
+    #define VKP_SIMD_BACKEND sse2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define VKP_SIMD_NEON 1
+    #define VKP_SIMD_BACKEND neon
+    #include <arm_neon.h>
+#else
+    #define VKP_SIMD_SCALAR 1
+    #define VKP_SIMD_BACKEND scalar
+#endif
+
+namespace vkp::core::simd {
+
+    constexpr int LANES = 8;
+
+inline namespace VKP_SIMD_BACKEND {
+
+    [[nodiscard]] constexpr const char* backendName() {
+#if defined(VKP_SIMD_AVX2)
+        return "avx2";
+#elif defined(VKP_SIMD_SSE2)
+        return "sse2";
+#elif defined(VKP_SIMD_NEON)
+        return "neon";
+#else
+        return "scalar";
+#endif
+    }
+
+#if defined(VKP_SIMD_AVX2)
+
+    struct Mask8 { __m256 v; };
+    struct Float8 {
+        __m256 v;
+        Float8() : v(_mm256_setzero_ps()) {}
+        Float8(const float x) : v(_mm256_set1_ps(x)) {}
+        explicit Float8(const __m256 x) : v(x) {}
+        static Float8 load(const float* p) { return Float8(_mm256_loadu_ps(p)); }
+        void store(float* p) const { _mm256_storeu_ps(p, v); }
+    };
+
+    inline Float8 operator+(const Float8 a, const Float8 b) { return Float8(_mm256_add_ps(a.v, b.v)); }
+    inline Float8 operator-(const Float8 a, const Float8 b) { return Float8(_mm256_sub_ps(a.v, b.v)); }
+    inline Float8 operator*(const Float8 a, const Float8 b) { return Float8(_mm256_mul_ps(a.v, b.v)); }
+    inline Float8 operator/(const Float8 a, const Float8 b) { return Float8(_mm256_div_ps(a.v, b.v)); }
+    inline Float8 min(const Float8 a, const Float8 b) { return Float8(_mm256_min_ps(a.v, b.v)); }
+    inline Float8 max(const Float8 a, const Float8 b) { return Float8(_mm256_max_ps(a.v, b.v)); }
+    inline Float8 sqrt(const Float8 a) { return Float8(_mm256_sqrt_ps(a.v)); }
+    inline Float8 abs(const Float8 a) { return Float8(_mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v)); }
+    inline Float8 round(const Float8 a) {
+        return Float8(_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    // a * b + c
+    inline Float8 fma(const Float8 a, const Float8 b, const Float8 c) { return Float8(_mm256_fmadd_ps(a.v, b.v, c.v)); }
+
+    inline Mask8 operator<(const Float8 a, const Float8 b)  { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+    inline Mask8 operator<=(const Float8 a, const Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+    inline Mask8 operator>(const Float8 a, const Float8 b)  { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    inline Mask8 operator>=(const Float8 a, const Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+    inline Mask8 operator&(const Mask8 a, const Mask8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+    inline Mask8 operator|(const Mask8 a, const Mask8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+    // a && !b
+    inline Mask8 andNot(const Mask8 a, const Mask8 b) { return { _mm256_andnot_ps(b.v, a.v) }; }
+    inline bool any(const Mask8 m) { return _mm256_movemask_ps(m.v) != 0; }
+    inline bool all(const Mask8 m) { return _mm256_movemask_ps(m.v) == 0xFF; }
+    // Lanes of `a` where `m` is set, `b` elsewhere.
+    inline Float8 select(const Mask8 m, const Float8 a, const Float8 b) { return Float8(_mm256_blendv_ps(b.v, a.v, m.v)); }
+
+#elif defined(VKP_SIMD_SSE2) || defined(VKP_SIMD_NEON)
+
+    #if defined(VKP_SIMD_SSE2)
+    using Half = __m128;
+    inline Half halfSet(const float x) { return _mm_set1_ps(x); }
+    inline Half halfLoad(const float* p) { return _mm_loadu_ps(p); }
+    inline void halfStore(float* p, const Half a) { _mm_storeu_ps(p, a); }
+    inline Half halfAdd(const Half a, const Half b) { return _mm_add_ps(a, b); }
+    inline Half halfSub(const Half a, const Half b) { return _mm_sub_ps(a, b); }
+    inline Half halfMul(const Half a, const Half b) { return _mm_mul_ps(a, b); }
+    inline Half halfDiv(const Half a, const Half b) { return _mm_div_ps(a, b); }
+    inline Half halfMin(const Half a, const Half b) { return _mm_min_ps(a, b); }
+    inline Half halfMax(const Half a, const Half b) { return _mm_max_ps(a, b); }
+    inline Half halfSqrt(const Half a) { return _mm_sqrt_ps(a); }
+    inline Half halfAbs(const Half a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    // Exact for |a| < 2^31, which covers every use here.
+    inline Half halfRound(const Half a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+    inline Half halfLt(const Half a, const Half b) { return _mm_cmplt_ps(a, b); }
+    inline Half halfLe(const Half a, const Half b) { return _mm_cmple_ps(a, b); }
+    inline Half halfAnd(const Half a, const Half b) { return _mm_and_ps(a, b); }
+    inline Half halfOr(const Half a, const Half b) { return _mm_or_ps(a, b); }
+    inline Half halfAndNot(const Half a, const Half b) { return _mm_andnot_ps(b, a); }
+    inline int  halfMoveMask(const Half m) { return _mm_movemask_ps(m); }
+    inline Half halfSelect(const Half m, const Half a, const Half b) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+    #else
+    using Half = float32x4_t;
+    inline Half halfSet(const float x) { return vdupq_n_f32(x); }
+    inline Half halfLoad(const float* p) { return vld1q_f32(p); }
+    inline void halfStore(float* p, const Half a) { vst1q_f32(p, a); }
+    inline Half halfAdd(const Half a, const Half b) { return vaddq_f32(a, b); }
+    inline Half halfSub(const Half a, const Half b) { return vsubq_f32(a, b); }
+    inline Half halfMul(const Half a, const Half b) { return vmulq_f32(a, b); }
+    inline Half halfDiv(const Half a, const Half b) { return vdivq_f32(a, b); }
+    inline Half halfMin(const Half a, const Half b) { return vminq_f32(a, b); }
+    inline Half halfMax(const Half a, const Half b) { return vmaxq_f32(a, b); }
+    inline Half halfSqrt(const Half a) { return vsqrtq_f32(a); }
+    inline Half halfAbs(const Half a) { return vabsq_f32(a); }
+    inline Half halfRound(const Half a) { return vrndnq_f32(a); }
+    inline Half halfLt(const Half a, const Half b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+    inline Half halfLe(const Half a, const Half b) { return vreinterpretq_f32_u32(vcleq_f32(a, b)); }
+    inline Half halfAnd(const Half a, const Half b) {
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    inline Half halfOr(const Half a, const Half b) {
+        return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    inline Half halfAndNot(const Half a, const Half b) {
+        return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    inline int halfMoveMask(const Half m) {
+        const uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(m), 31);
+        return static_cast<int>(vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1)
+                              | (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3));
+    }
+    inline Half halfSelect(const Half m, const Half a, const Half b) {
+        return vbslq_f32(vreinterpretq_u32_f32(m), a, b);
+    }
+    #endif
+
+    struct Mask8 { Half lo, hi; };
+    struct Float8 {
+        Half lo, hi;
+        Float8() : lo(halfSet(0.f)), hi(halfSet(0.f)) {}
+        Float8(const float x) : lo(halfSet(x)), hi(halfSet(x)) {}
+        Float8(const Half l, const Half h) : lo(l), hi(h) {}
+        static Float8 load(const float* p) { return { halfLoad(p), halfLoad(p + 4) }; }
+        void store(float* p) const { halfStore(p, lo); halfStore(p + 4, hi); }
+    };
+
+    inline Float8 operator+(const Float8 a, const Float8 b) { return { halfAdd(a.lo, b.lo), halfAdd(a.hi, b.hi) }; }
+    inline Float8 operator-(const Float8 a, const Float8 b) { return { halfSub(a.lo, b.lo), halfSub(a.hi, b.hi) }; }
+    inline Float8 operator*(const Float8 a, const Float8 b) { return { halfMul(a.lo, b.lo), halfMul(a.hi, b.hi) }; }
+    inline Float8 operator/(const Float8 a, const Float8 b) { return { halfDiv(a.lo, b.lo), halfDiv(a.hi, b.hi) }; }
+    inline Float8 min(const Float8 a, const Float8 b) { return { halfMin(a.lo, b.lo), halfMin(a.hi, b.hi) }; }
+    inline Float8 max(const Float8 a, const Float8 b) { return { halfMax(a.lo, b.lo), halfMax(a.hi, b.hi) }; }
+    inline Float8 sqrt(const Float8 a) { return { halfSqrt(a.lo), halfSqrt(a.hi) }; }
+    inline Float8 abs(const Float8 a) { return { halfAbs(a.lo), halfAbs(a.hi) }; }
+    inline Float8 round(const Float8 a) { return { halfRound(a.lo), halfRound(a.hi) }; }
+    inline Float8 fma(const Float8 a, const Float8 b, const Float8 c) { return a * b + c; }
+
+    inline Mask8 operator<(const Float8 a, const Float8 b)  { return { halfLt(a.lo, b.lo), halfLt(a.hi, b.hi) }; }
+    inline Mask8 operator<=(const Float8 a, const Float8 b) { return { halfLe(a.lo, b.lo), halfLe(a.hi, b.hi) }; }
+    inline Mask8 operator>(const Float8 a, const Float8 b)  { return b < a; }
+    inline Mask8 operator>=(const Float8 a, const Float8 b) { return b <= a; }
+    inline Mask8 operator&(const Mask8 a, const Mask8 b) { return { halfAnd(a.lo, b.lo), halfAnd(a.hi, b.hi) }; }
+    inline Mask8 operator|(const Mask8 a, const Mask8 b) { return { halfOr(a.lo, b.lo), halfOr(a.hi, b.hi) }; }
+    inline Mask8 andNot(const Mask8 a, const Mask8 b) { return { halfAndNot(a.lo, b.lo), halfAndNot(a.hi, b.hi) }; }
+    inline bool any(const Mask8 m) { return (halfMoveMask(m.lo) | halfMoveMask(m.hi)) != 0; }
+    inline bool all(const Mask8 m) { return (halfMoveMask(m.lo) & halfMoveMask(m.hi)) == 0xF; }
+    inline Float8 select(const Mask8 m, const Float8 a, const Float8 b) {
+        return { halfSelect(m.lo, a.lo, b.lo), halfSelect(m.hi, a.hi, b.hi) };
+    }
+
+#else
+
+    struct Mask8 { bool v[LANES]; };
+    struct Float8 {
+        float v[LANES];
+        Float8() : v{} {}
+        Float8(const float x) { for (float& lane : v) lane = x; }
+        static Float8 load(const float* p) { Float8 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+        void store(float* p) const { std::memcpy(p, v, sizeof(v)); }
+    };
+
+    #define VKP_SIMD_LANEWISE(expr) { for (int i = 0; i < LANES; i++) r.v[i] = (expr); return r; }
+    inline Float8 operator+(const Float8 a, const Float8 b) { Float8 r; VKP_SIMD_LANEWISE(a.v[i] + b.v[i]) }
+    inline Float8 operator-(const Float8 a, const Float8 b) { Float8 r; VKP_SIMD_LANEWISE(a.v[i] - b.v[i]) }
+    inline Float8 operator*(const Float8 a, const Float8 b) { Float8 r; VKP_SIMD_LANEWISE(a.v[i] * b.v[i]) }
+    inline Float8 operator/(const Float8 a, const Float8 b) { Float8 r; VKP_SIMD_LANEWISE(a.v[i] / b.v[i]) }
+    inline Float8 min(const Float8 a, const Float8 b) { Float8 r; VKP_SIMD_LANEWISE(b.v[i] < a.v[i] ? b.v[i] : a.v[i]) }
+    inline Float8 max(const Float8 a, const Float8 b) { Float8 r; VKP_SIMD_LANEWISE(b.v[i] > a.v[i] ? b.v[i] : a.v[i]) }
+    inline Float8 sqrt(const Float8 a) { Float8 r; VKP_SIMD_LANEWISE(std::sqrt(a.v[i])) }
+    inline Float8 abs(const Float8 a) { Float8 r; VKP_SIMD_LANEWISE(std::fabs(a.v[i])) }
+    inline Float8 round(const Float8 a) { Float8 r; VKP_SIMD_LANEWISE(std::nearbyint(a.v[i])) }
+    inline Float8 fma(const Float8 a, const Float8 b, const Float8 c) { return a * b + c; }
+    inline Mask8 operator<(const Float8 a, const Float8 b)  { Mask8 r; VKP_SIMD_LANEWISE(a.v[i] < b.v[i]) }
+    inline Mask8 operator<=(const Float8 a, const Float8 b) { Mask8 r; VKP_SIMD_LANEWISE(a.v[i] <= b.v[i]) }
+    inline Mask8 operator>(const Float8 a, const Float8 b)  { return b < a; }
+    inline Mask8 operator>=(const Float8 a, const Float8 b) { return b <= a; }
+    inline Mask8 operator&(const Mask8 a, const Mask8 b) { Mask8 r; VKP_SIMD_LANEWISE(a.v[i] && b.v[i]) }
+    inline Mask8 operator|(const Mask8 a, const Mask8 b) { Mask8 r; VKP_SIMD_LANEWISE(a.v[i] || b.v[i]) }
+    inline Mask8 andNot(const Mask8 a, const Mask8 b) { Mask8 r; VKP_SIMD_LANEWISE(a.v[i] && !b.v[i]) }
+    inline Float8 select(const Mask8 m, const Float8 a, const Float8 b) { Float8 r; VKP_SIMD_LANEWISE(m.v[i] ? a.v[i] : b.v[i]) }
+    #undef VKP_SIMD_LANEWISE
+    inline bool any(const Mask8 m) { for (const bool lane : m.v) if (lane) return true; return false; }
+    inline bool all(const Mask8 m) { for (const bool lane : m.v) if (!lane) return false; return true; }
+
+#endif
+
+    inline Float8 operator-(const Float8 a) { return Float8(0.f) - a; }
+    inline Float8& operator+=(Float8& a, const Float8 b) { return a = a + b; }
+    inline Float8& operator*=(Float8& a, const Float8 b) { return a = a * b; }
+    inline Float8 clamp(const Float8 x, const Float8 lo, const Float8 hi) { return min(max(x, lo), hi); }
+
+    // Lane i holds base + i.
+    inline Float8 iota(const float base) {
+        const float lanes[LANES] = { base, base + 1, base + 2, base + 3, base + 4, base + 5, base + 6, base + 7 };
+        return Float8::load(lanes);
+    }
+
+    // Sine and cosine with about 1e-6 absolute error, plenty for shading. The argument is reduced
+    // to [-pi, pi] and then folded onto [-pi/2, pi/2], where odd and even polynomials are used.
+    inline void sincos(const Float8 x, Float8& s, Float8& c) {
+        constexpr float PI = 3.14159265358979f;
+        const Float8 r = x - round(x * Float8(0.5f / PI)) * Float8(2.f * PI);
+
+        // sin(r) = sin(pi - r) folds the upper and lower quarters in; cos flips sign there.
+        const Mask8 upper = r > Float8(PI * 0.5f);
+        const Mask8 lower = r < Float8(-PI * 0.5f);
+        const Float8 folded = select(upper, Float8(PI) - r, select(lower, Float8(-PI) - r, r));
+        const Float8 sign = select(upper | lower, Float8(-1.f), Float8(1.f));
+
+        const Float8 f2 = folded * folded;
+        Float8 sp = fma(f2, Float8(-2.5052108e-8f), Float8(2.7557319e-6f));
+        sp = fma(sp, f2, Float8(-1.9841270e-4f));
+        sp = fma(sp, f2, Float8(8.3333333e-3f));
+        sp = fma(sp, f2, Float8(-1.6666667e-1f));
+        s = fma(sp * f2, folded, folded);
+
+        Float8 cp = fma(f2, Float8(-2.7557319e-7f), Float8(2.4801587e-5f));
+        cp = fma(cp, f2, Float8(-1.3888889e-3f));
+        cp = fma(cp, f2, Float8(4.1666667e-2f));
+        cp = fma(cp, f2, Float8(-0.5f));
+        c = fma(cp, f2, Float8(1.f)) * sign;
+    }
+
+} // inline namespace VKP_SIMD_BACKEND
+
+} // namespace vkp::core::simd
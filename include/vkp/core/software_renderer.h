@@ -0,0 +1,55 @@
+#pragma once
+
+#include "image_writer.h"
+
+#include <cstdint>
+
+namespace vkp::core {
+
+    // The raymarched scene of shaders/scene.glsl on the CPU, for machines without a usable Vulkan
+    // driver and as a golden reference to diff GPU frames against. Rays are traced in packets of
+    // simd::LANES horizontally adjacent pixels; lanes that hit or miss are masked off and a packet
+    // stops once all of them have. Tiles are handed out one at a time to jobs on the JobSystem, so
+    // threads that draw empty tiles simply take more of them.
+    class SoftwareRenderer {
+    public:
+        static constexpr uint32_t TILE_WIDTH  = 32;   // a multiple of simd::LANES
+        static constexpr uint32_t TILE_HEIGHT = 8;
+
+        // At most `threads` threads render tiles at once, the caller included; 0 uses every job
+        // worker as well as the caller.
+        explicit SoftwareRenderer(uint32_t threads = 0);
+
+        // Renders the scene at shader time `time` into `pixels`, tightly packed rows of 4 bytes per
+        // pixel, top row first like the Vulkan image. `srgb` encodes the colours as a *_SRGB
+        // attachment would; the default matches the B8G8R8A8_SRGB swap chain. Blocks until done.
+        void render(uint8_t* pixels, uint32_t width, uint32_t height, float time,
+                    PixelOrder order = PixelOrder::BGRA, bool srgb = true);
+
+        [[nodiscard]] uint32_t threads() const { return threads_; }
+
+    private:
+        struct Frame;
+        void renderTile(const Frame& frame, uint32_t tile) const;
+
+        uint32_t threads_;
+    };
+
+    struct SoftwareSequence {
+        uint32_t        width     = 1280;
+        uint32_t        height    = 720;
+        uint32_t        frames    = 1;
+        double          startTime = 0.0;
+        double          timeStep  = 1.0 / 60.0;
+        uint32_t        threads   = 0;
+        // Optional: write each frame as "{dir}/frame_{n:06}_{w}x{h}.{ext}", named like FrameCapture's.
+        const char*     captureDir    = nullptr;
+        ImageFileFormat captureFormat = ImageFileFormat::PNG;
+        // First render the sequence with 1, 2, 4, ... threads up to `threads` and log the speedup.
+        bool            scaling   = false;
+    };
+
+    // Renders the sequence on the CPU and logs the frame rate and pixel throughput.
+    bool renderSoftwareSequence(const SoftwareSequence& sequence);
+
+} // namespace vkp::core
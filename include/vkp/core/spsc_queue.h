@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace vkp::core {
+
+    // Bounded lock-free queue for exactly one producer thread and one consumer thread. Head and
+    // tail are free-running counters on separate cache lines; each side only writes its own and
+    // publishes slots with release stores. Neither side ever blocks: a full queue rejects pushes.
+    template <typename T, size_t Capacity>
+    class SpscQueue {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        // Producer only.
+        bool tryPush(T value) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+            slots_[tail & (Capacity - 1)] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only.
+        bool tryPop(T& value) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire)) return false;
+            value = std::move(slots_[head & (Capacity - 1)]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Either side; exact only when the other side is idle.
+        [[nodiscard]] size_t size() const {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+
+    private:
+        alignas(64) std::atomic<size_t> head_{ 0 };
+        alignas(64) std::atomic<size_t> tail_{ 0 };
+        alignas(64) std::array<T, Capacity> slots_{};
+    };
+
+} // namespace vkp::core
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vkp::core {
+
+    // Collects wall-clock timings of named startup phases (from any thread) and
+    // reports them once initialization is done, together with time-to-first-frame.
+    class StartupProfiler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // RAII timer: records the enclosing block as one startup phase.
+        class Scope {
+        public:
+            explicit Scope(const char* phase);
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char*       phase_;
+            clock::time_point start_;
+        };
+
+        static StartupProfiler& get();
+
+        void record(const char* phase, clock::time_point start, clock::time_point end);
+        void report();
+        void markFirstFrame();
+        // Starts over from now, e.g. to time a reloaded renderer up to its first frame.
+        void restart();
+
+    private:
+        StartupProfiler();
+
+        struct Phase {
+            std::string name;
+            double      start_ms;
+            double      duration_ms;
+            bool        main_thread;
+        };
+
+        [[nodiscard]] double sinceOrigin(clock::time_point t) const;
+
+        clock::time_point  origin_;
+        std::thread::id    main_thread_;
+        std::mutex         mutex_;
+        std::vector<Phase> phases_;
+        std::atomic<bool>  first_frame_seen_{ false };
+    };
+
+} // namespace vkp::core
+
+#define VKP_STARTUP_CONCAT_INNER(a, b) a##b
+#define VKP_STARTUP_CONCAT(a, b) VKP_STARTUP_CONCAT_INNER(a, b)
+#define VKP_STARTUP_SCOPE(phase) \
+    ::vkp::core::StartupProfiler::Scope VKP_STARTUP_CONCAT(vkp_startup_scope_, __LINE__){ phase }
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <vkp/core/metrics.h>
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // Messages that passed the filter. Performance messages count only as performance, whatever
+    // their severity.
+    struct DebugMessageCounts {
+        uint64_t errors      = 0;
+        uint64_t warnings    = 0;
+        uint64_t performance = 0;
+        uint64_t info        = 0;   // info and verbose
+    };
+
+    // One distinct performance warning, for the overlay.
+    struct PerformanceWarning {
+        std::string id;        // message ID name, or its number
+        std::string message;   // the first occurrence, shortened
+        uint64_t    count = 0;
+    };
+
+    // Receives the debug utils messenger's output instead of printing it. Messages are filtered by
+    // severity and type, counted, and deduplicated by message ID: an ID is logged once, then
+    // summarized at most every REPEAT_INTERVAL. On top of that, a token bucket caps the log rate
+    // across all IDs. The callback can run on any thread that calls into Vulkan.
+    class DebugMessageCollector {
+    public:
+        static constexpr std::chrono::seconds REPEAT_INTERVAL{ 5 };
+        static constexpr double LOGS_PER_SECOND          = 10.0;
+        static constexpr double LOG_BURST                = 20.0;
+        static constexpr size_t MAX_MESSAGE_LENGTH       = 200;
+        static constexpr size_t MAX_PERFORMANCE_WARNINGS = 32;
+
+        // Everything the collector understands; setFilter() masks with these.
+        static constexpr VkDebugUtilsMessageSeverityFlagsEXT ALL_SEVERITIES =
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        static constexpr VkDebugUtilsMessageTypeFlagsEXT ALL_TYPES =
+            VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+        static constexpr VkDebugUtilsMessageSeverityFlagsEXT DEFAULT_SEVERITIES =
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+
+        DebugMessageCollector();
+        // Logs what rate limiting held back.
+        ~DebugMessageCollector();
+
+        DebugMessageCollector(const DebugMessageCollector&) = delete;
+        DebugMessageCollector& operator=(const DebugMessageCollector&) = delete;
+
+        // PFN_vkDebugUtilsMessengerCallbackEXT; pUserData is the collector.
+        static VKAPI_ATTR VkBool32 VKAPI_CALL callback(
+            VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+            VkDebugUtilsMessageTypeFlagsEXT types,
+            const VkDebugUtilsMessengerCallbackDataEXT* data,
+            void* userData);
+
+        // Any thread. Calls the filter listener when the filter changed.
+        void setFilter(VkDebugUtilsMessageSeverityFlagsEXT severities, VkDebugUtilsMessageTypeFlagsEXT types);
+        // Device recreates its messenger with the new masks from here. Set before the collector is
+        // shared; the listener runs on the thread that called setFilter().
+        void setFilterListener(std::function<void()> listener) { filterListener_ = std::move(listener); }
+        [[nodiscard]] VkDebugUtilsMessageSeverityFlagsEXT severityFilter() const {
+            return severities_.load(std::memory_order_relaxed);
+        }
+        [[nodiscard]] VkDebugUtilsMessageTypeFlagsEXT typeFilter() const {
+            return types_.load(std::memory_order_relaxed);
+        }
+
+        // Render thread, once per frame: closes the counts of the frame that just ended.
+        void endFrame();
+        [[nodiscard]] DebugMessageCounts lastFrame() const;
+        [[nodiscard]] DebugMessageCounts total() const;
+        // Most frequent first.
+        [[nodiscard]] std::vector<PerformanceWarning> performanceWarnings() const;
+
+    private:
+        enum Category { Error, Warning, Performance, Info, CategoryCount };
+
+        struct Entry {
+            uint64_t                              count      = 0;
+            uint64_t                              unlogged   = 0;   // since the last line logged for it
+            std::chrono::steady_clock::time_point loggedAt{};
+            bool                                  logged     = false;
+        };
+
+        void receive(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT types,
+                     const VkDebugUtilsMessengerCallbackDataEXT& data);
+        // Takes a token from the bucket; false when the log rate is exhausted.
+        bool takeLogToken(std::chrono::steady_clock::time_point now);
+
+        std::atomic<VkDebugUtilsMessageSeverityFlagsEXT> severities_{ DEFAULT_SEVERITIES };
+        std::atomic<VkDebugUtilsMessageTypeFlagsEXT>     types_{ ALL_TYPES };
+        std::function<void()>                            filterListener_;
+
+        std::array<std::atomic<uint64_t>, CategoryCount> frame_{};
+        std::array<std::atomic<uint64_t>, CategoryCount> lastFrame_{};
+        std::array<std::atomic<uint64_t>, CategoryCount> total_{};
+        std::array<core::Counter*, CategoryCount>        metrics_{};
+        core::Counter&                                   suppressedMetric_;
+
+        mutable std::mutex                               mutex_;
+        std::unordered_map<uint64_t, Entry>              entries_;
+        std::vector<PerformanceWarning>                  performance_;
+        std::unordered_map<uint64_t, size_t>             performanceIndex_;
+        double                                           tokens_{ LOG_BURST };
+        std::chrono::steady_clock::time_point            refilledAt_{ std::chrono::steady_clock::now() };
+        uint64_t                                         suppressed_{ 0 };
+    };
+
+    // Reads a comma-separated list of verbose, info, warning, error (severities) and general,
+    // validation, performance (types). Kinds the list doesn't mention keep their current value;
+    // false on an unknown word.
+    bool parseDebugMessageFilter(const std::string& list,
+                                 VkDebugUtilsMessageSeverityFlagsEXT& severities,
+                                 VkDebugUtilsMessageTypeFlagsEXT& types);
+
+} // namespace vkp::graphics
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace vkp::graphics {
+
+    // Destroys GPU objects once the frames that may still use them have completed, instead of
+    // draining the queue. Entries are keyed on the number of frames submitted when they were
+    // retired and run in retirement order.
+    class DeletionQueue {
+    public:
+        DeletionQueue() = default;
+        ~DeletionQueue() { flush(); }
+
+        DeletionQueue(const DeletionQueue&) = delete;
+        DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+        // `submittedFrames` is the count of frames submitted so far; `destroy` runs once that
+        // many frames are known to have completed. Owning captures are released right after.
+        void retire(uint64_t submittedFrames, std::function<void()> destroy) {
+            entries_.push_back({ submittedFrames, std::move(destroy) });
+        }
+
+        // Runs every entry whose frames are covered by `completedFrames`.
+        void collect(uint64_t completedFrames) {
+            while (!entries_.empty() && entries_.front().frames <= completedFrames) {
+                auto destroy = std::move(entries_.front().destroy);
+                entries_.pop_front();
+                if (destroy) destroy();
+            }
+        }
+
+        // Runs everything; the caller must have waited for the device.
+        void flush() { collect(UINT64_MAX); }
+
+        [[nodiscard]] size_t size() const { return entries_.size(); }
+
+    private:
+        struct Entry {
+            uint64_t              frames;
+            std::function<void()> destroy;
+        };
+        std::deque<Entry> entries_;
+    };
+
+} // namespace vkp::graphics
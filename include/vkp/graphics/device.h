@@ -1,25 +1,37 @@
 #pragma once
 
 #include <vkp/gui/window.h>
+
+#include "debug_message_collector.h"
+#include "device_caps.h"
+#include "host_allocator.h"
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace vkp::graphics {
 
- // Holds all swap chain support details for a physical device.
- struct SwapChainSupportDetails {
-   VkSurfaceCapabilitiesKHR capabilities;
-   std::vector<VkSurfaceFormatKHR> formats;
-   std::vector<VkPresentModeKHR> presentModes;
+ // What a device allocation is used for, for the memory report.
+ enum class MemoryCategory { SwapchainDepth, RenderTarget, Staging, Mesh, Texture, ImGui, Other, Count };
+ const char *memoryCategoryName(MemoryCategory category);
+
+ // Usage of one memory heap. With VK_EXT_memory_budget, usage and budget come from the driver and
+ // include memory allocated outside Device (ImGui backend, swap chain images, other processes).
+ // Without it, usage is what Device allocated and budget is the heap size.
+ struct MemoryHeapReport {
+   VkDeviceSize size = 0;
+   VkDeviceSize budget = 0;
+   VkDeviceSize usage = 0;
+   VkDeviceSize tracked = 0;  // allocated through Device
+   bool deviceLocal = false;
  };
 
- // Stores queue family indices and their validity.
- struct QueueFamilyIndices {
-   uint32_t graphicsFamily{};
-   uint32_t presentFamily{};
-   bool graphicsFamilyHasValue = false;
-   bool presentFamilyHasValue = false;
-   // Returns true if both graphics and present families are found.
-   [[nodiscard]] bool isComplete() const { return graphicsFamilyHasValue && presentFamilyHasValue; }
+ struct MemoryReport {
+   bool budgetExtension = false;
+   std::vector<MemoryHeapReport> heaps;
+   std::array<VkDeviceSize, static_cast<size_t>(MemoryCategory::Count)> categories{};
  };
 
  // Encapsulates Vulkan device and related resource management.
@@ -46,11 +58,22 @@ namespace vkp::graphics {
    [[nodiscard]] VkSurfaceKHR surface() const { return surface_; }
    [[nodiscard]] VkQueue graphicsQueue() const { return graphicsQueue_; }
    [[nodiscard]] VkQueue presentQueue() const { return presentQueue_; }
+   // Host allocation callbacks for every vkCreate*/vkDestroy* call; nullptr unless VKP_HOST_ALLOCATOR is set.
+   [[nodiscard]] const VkAllocationCallbacks *allocator() const {
+     return hostAllocator_ ? hostAllocator_->callbacks() : nullptr;
+   }
+   [[nodiscard]] const HostAllocator *hostAllocator() const { return hostAllocator_.get(); }
+
+   // Capabilities of the selected physical device, snapshotted when it was picked.
+   [[nodiscard]] const DeviceCaps &caps() const { return caps_; }
+
+   // Validation layer output; stays empty unless enableValidationLayers.
+   [[nodiscard]] DebugMessageCollector &debugMessages() { return debugMessages_; }
 
    // Swap chain and memory helpers.
-   [[nodiscard]] SwapChainSupportDetails getSwapChainSupport() const { return querySwapChainSupport(physicalDevice); }
+   [[nodiscard]] VkSurfaceCapabilitiesKHR getSurfaceCapabilities() const;
    [[nodiscard]] uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
-   [[nodiscard]] QueueFamilyIndices findPhysicalQueueFamilies() const { return findQueueFamilies(physicalDevice); }
+   [[nodiscard]] const QueueFamilyIndices &findPhysicalQueueFamilies() const { return caps_.queues; }
    [[nodiscard]] VkFormat findSupportedFormat(
     const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const;
 
@@ -60,7 +83,8 @@ namespace vkp::graphics {
        VkBufferUsageFlags usage,
        VkMemoryPropertyFlags properties,
        VkBuffer &buffer,
-       VkDeviceMemory &bufferMemory) const;
+       VkDeviceMemory &bufferMemory,
+       MemoryCategory category = MemoryCategory::Other) const;
    [[nodiscard]] VkCommandBuffer beginSingleTimeCommands() const;
    void endSingleTimeCommands(VkCommandBuffer commandBuffer) const;
    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) const;
@@ -71,12 +95,30 @@ namespace vkp::graphics {
        const VkImageCreateInfo &imageInfo,
        VkMemoryPropertyFlags properties,
        VkImage &image,
-       VkDeviceMemory &imageMemory) const;
+       VkDeviceMemory &imageMemory,
+       MemoryCategory category = MemoryCategory::Other) const;
+   // Raw allocation for resources bound by the caller, e.g. several aliased images sharing one block.
+   [[nodiscard]] VkDeviceMemory allocateMemory(
+       const VkMemoryRequirements &requirements,
+       VkMemoryPropertyFlags properties,
+       MemoryCategory category = MemoryCategory::Other) const;
+   // Frees memory from createBuffer/createImageWithInfo/allocateMemory and keeps the memory metrics current.
+   void freeMemory(VkDeviceMemory memory) const;
+   // Per-heap usage against budget and per-category totals. Cheap enough to poll a few times a second.
+   [[nodiscard]] MemoryReport queryMemoryReport() const;
+   [[nodiscard]] bool hasMemoryBudget() const { return memoryBudgetSupported_; }
+
+   // VK_KHR_dynamic_rendering, either core 1.3 or the extension; enabled whenever available.
+   [[nodiscard]] bool supportsDynamicRendering() const { return dynamicRenderingSupported_; }
+   void cmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfo &renderingInfo) const {
+     cmdBeginRendering_(commandBuffer, &renderingInfo);
+   }
+   void cmdEndRendering(VkCommandBuffer commandBuffer) const { cmdEndRendering_(commandBuffer); }
 
    // Additional accessors.
    [[nodiscard]] VkInstance getInstance() const;
    [[nodiscard]] VkPhysicalDevice getPhysicalDevice() const;
-   [[nodiscard]] uint32_t getGraphicsQueueFamilyIndex() const;
+   [[nodiscard]] uint32_t getGraphicsQueueFamilyIndex() const { return caps_.queues.graphicsFamily; }
    [[nodiscard]] VkQueue getGraphicsQueue() const;
 
    VkPhysicalDeviceProperties properties; // Physical device properties (limits, features, etc.)
@@ -85,26 +127,30 @@ namespace vkp::graphics {
    // Vulkan setup and teardown routines.
    void createInstance();
    void setupDebugMessenger();
+   // Replaces the messenger with one created for the collector's current filter.
+   void recreateDebugMessenger();
    void createSurface();
    void pickPhysicalDevice();
    void createLogicalDevice();
    void createCommandPool();
 
    // Device suitability and extension checks.
-   bool isDeviceSuitable(VkPhysicalDevice device) const;
+   bool isDeviceSuitable(const DeviceCaps &caps) const;
    std::vector<const char *> getRequiredExtensions();
    [[nodiscard]] bool checkValidationLayerSupport() const;
-   QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) const;
 
    // Debug and swap chain helpers.
-   static void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
+   void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
    void hasGflwRequiredInstanceExtensions();
-   bool checkDeviceExtensionSupport(VkPhysicalDevice device) const;
-   SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device) const;
+   bool checkDeviceExtensionSupport(const DeviceCaps &caps) const;
+   void trackAllocation(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, MemoryCategory category) const;
 
    // Vulkan handles and state.
+   DebugMessageCollector debugMessages_;
+   std::unique_ptr<HostAllocator> hostAllocator_ = HostAllocator::fromEnvironment();
    VkInstance instance;
-   VkDebugUtilsMessengerEXT debugMessenger;
+   VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
+   std::mutex debugMessengerMutex_;
    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
    Window &window;
    VkCommandPool commandPool;
@@ -114,6 +160,26 @@ namespace vkp::graphics {
    VkQueue graphicsQueue_;
    VkQueue presentQueue_;
 
+   // Live device memory allocations, for the metrics endpoint and the memory report.
+   struct Allocation {
+     VkDeviceSize size;
+     uint32_t heap;
+     MemoryCategory category;
+   };
+   mutable std::mutex allocationMutex_;
+   mutable std::unordered_map<VkDeviceMemory, Allocation> allocations_;
+   mutable VkDeviceSize allocatedBytes_ = 0;
+   mutable std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapBytes_{};
+   mutable std::array<VkDeviceSize, static_cast<size_t>(MemoryCategory::Count)> categoryBytes_{};
+
+   DeviceCaps caps_;
+   bool memoryBudgetSupported_ = false;
+   PFN_vkGetPhysicalDeviceMemoryProperties2 getMemoryProperties2_ = nullptr;
+   bool dynamicRenderingSupported_ = false;
+   bool dynamicRenderingCore_ = false;
+   PFN_vkCmdBeginRendering cmdBeginRendering_ = nullptr;
+   PFN_vkCmdEndRendering cmdEndRendering_ = nullptr;
+
    // Required validation layers and device extensions.
    const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
    const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // Stores queue family indices and their validity.
+    struct QueueFamilyIndices {
+        uint32_t graphicsFamily{};
+        uint32_t presentFamily{};
+        bool graphicsFamilyHasValue = false;
+        bool presentFamilyHasValue = false;
+        // Returns true if both graphics and present families are found.
+        [[nodiscard]] bool isComplete() const { return graphicsFamilyHasValue && presentFamilyHasValue; }
+    };
+
+    // Everything about a physical device that doesn't change while it is open, queried once.
+    // Surface capabilities are not included: currentExtent follows the window.
+    struct DeviceCaps {
+        VkPhysicalDeviceProperties           properties{};
+        VkPhysicalDeviceFeatures             features{};
+        VkPhysicalDeviceMemoryProperties     memory{};
+        std::vector<VkQueueFamilyProperties> queueFamilies;
+        QueueFamilyIndices                   queues;
+        std::vector<std::string>             extensions;       // sorted
+        std::vector<VkSurfaceFormatKHR>      surfaceFormats;
+        std::vector<VkPresentModeKHR>        presentModes;
+        bool                                 dynamicRendering = false;   // feature bit, core or KHR
+
+        static DeviceCaps query(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface);
+
+        [[nodiscard]] bool hasExtension(const char* name) const;
+        // Core formats come from the snapshot; extension formats fall back to a live query.
+        [[nodiscard]] VkFormatProperties formatProperties(VkFormat format) const;
+        [[nodiscard]] bool supportsFormat(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) const;
+        [[nodiscard]] std::optional<uint32_t> findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags flags) const;
+        [[nodiscard]] bool hasMemoryType(VkMemoryPropertyFlags flags) const { return findMemoryType(~0u, flags).has_value(); }
+
+    private:
+        // VK_FORMAT_UNDEFINED .. VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+        static constexpr uint32_t CORE_FORMAT_COUNT = 185;
+
+        VkPhysicalDevice                physicalDevice_ = VK_NULL_HANDLE;
+        std::vector<VkFormatProperties> formats_;
+    };
+
+} // namespace vkp::graphics
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "device.h"
+
+#include <vkp/core/image_writer.h>
+#include <vkp/core/job_system.h>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // Copies rendered images into host-cached readback buffers, picks them up once that frame's
+    // fence has signaled and encodes them to disk as jobs on the JobSystem. The encoding job reads
+    // the mapped buffer directly and returns it to the pool when done, so the render thread never
+    // copies pixels and never waits on the GPU or on encoding.
+    class FrameCapture {
+    public:
+        FrameCapture(Device& device, uint32_t framesInFlight, std::string directory, core::ImageFileFormat format);
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        [[nodiscard]] static bool supportsFormat(VkFormat format);
+
+        // Call once the fence of `frameIndex` was waited: queues that slot's last copy for encoding.
+        void collect(uint32_t frameIndex);
+
+        // Records the copy of `image`, which must be in `layout` and is returned to it afterwards.
+        void record(VkCommandBuffer cmd, uint32_t frameIndex, VkImage image, VkImageLayout layout,
+                    VkFormat format, VkExtent2D extent, uint64_t frameNumber);
+
+        // Collects every slot and waits for the encoding jobs. The GPU must be idle.
+        void flush();
+
+    private:
+        struct Readback {
+            VkBuffer       buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            void*          mapped = nullptr;
+            VkDeviceSize   size   = 0;
+        };
+
+        // The copy recorded for one frame in flight.
+        struct Slot {
+            Readback*        readback = nullptr;   // null when nothing was recorded
+            uint64_t         frameNumber = 0;
+            VkExtent2D       extent{};
+            core::PixelOrder order = core::PixelOrder::BGRA;
+        };
+
+        void ensureCapacity(Readback& readback, VkDeviceSize size);
+        void destroyReadback(Readback& readback);
+        void encode(const Slot& slot);
+
+        Device&                  device_;
+        std::string              directory_;
+        core::ImageFileFormat    format_;
+        VkMemoryPropertyFlags    memoryFlags_;
+        bool                     coherent_;
+        std::vector<Slot>        slots_;
+
+        // Buffers waiting for encoding beyond the frames in flight; past that, frames are dropped
+        // rather than stalling a frame.
+        static constexpr size_t  MAX_QUEUED_JOBS = 8;
+        std::vector<std::unique_ptr<Readback>> readbacks_;   // render thread
+        core::JobCounter         encoding_;
+        std::mutex               mutex_;
+        std::vector<Readback*>   freeReadbacks_;
+        uint64_t                 dropped_ = 0;
+    };
+
+} // namespace vkp::graphics
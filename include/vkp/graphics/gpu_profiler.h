@@ -0,0 +1,137 @@
+#pragma once
+
+#include "device.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // Timestamp-query scopes per frame in flight. Results are read back once the
+    // frame's fence has signaled and are mapped onto the CPU profiler timebase.
+    // Draws can also be wrapped in pipeline statistics queries, read back the same way.
+    class GpuProfiler {
+    public:
+        static constexpr uint32_t MAX_SCOPES_PER_FRAME     = 32;
+        static constexpr uint32_t MAX_STATISTICS_PER_FRAME = 8;
+        // Results come back in bit order: vertex invocations, clipping primitives, fragment invocations.
+        static constexpr VkQueryPipelineStatisticFlags STATISTICS =
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+        struct ScopeResult {
+            const char* name;
+            uint64_t    start_ns;    // CPU timebase (core::Profiler::now)
+            uint64_t    end_ns;
+        };
+
+        struct StatisticsResult {
+            const char* name;
+            uint64_t    vertexInvocations;
+            uint64_t    clippingPrimitives;   // primitives that left the clipping stage
+            uint64_t    fragmentInvocations;
+        };
+
+        // RAII helper writing a begin/end timestamp pair around the enclosed commands.
+        class Scope {
+        public:
+            Scope(GpuProfiler& profiler, VkCommandBuffer cmd, const char* name)
+                : profiler_(profiler), cmd_(cmd), index_(profiler.beginScope(cmd, name)) {}
+            ~Scope() { profiler_.endScope(cmd_, index_); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            GpuProfiler&    profiler_;
+            VkCommandBuffer cmd_;
+            uint32_t        index_;
+        };
+
+        // RAII helper counting shader invocations of the enclosed draws. Statistics scopes
+        // don't nest: an inner one records nothing.
+        class StatisticsScope {
+        public:
+            StatisticsScope(GpuProfiler& profiler, VkCommandBuffer cmd, const char* name)
+                : profiler_(profiler), cmd_(cmd), index_(profiler.beginStatistics(cmd, name)) {}
+            ~StatisticsScope() { profiler_.endStatistics(cmd_, index_); }
+
+            StatisticsScope(const StatisticsScope&) = delete;
+            StatisticsScope& operator=(const StatisticsScope&) = delete;
+
+        private:
+            GpuProfiler&    profiler_;
+            VkCommandBuffer cmd_;
+            uint32_t        index_;
+        };
+
+        GpuProfiler(Device& device, uint32_t framesInFlight);
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        // Call after the frame slot's fence was waited: collects that slot's previous
+        // results and resets its queries inside `cmd`. `frameNumber` tags the new results.
+        void beginFrame(VkCommandBuffer cmd, uint32_t frameIndex, uint64_t frameNumber);
+
+        uint32_t beginScope(VkCommandBuffer cmd, const char* name);
+        void endScope(VkCommandBuffer cmd, uint32_t scope);
+        // Must begin and end in the same subpass.
+        uint32_t beginStatistics(VkCommandBuffer cmd, const char* name);
+        void endStatistics(VkCommandBuffer cmd, uint32_t query);
+
+        // Timestamps; statistics may work without them and vice versa.
+        [[nodiscard]] bool enabled() const { return queryPool_ != VK_NULL_HANDLE; }
+        [[nodiscard]] bool statisticsEnabled() const { return statisticsPool_ != VK_NULL_HANDLE; }
+        // Scopes of the most recently completed frame and its first-to-last timestamp span.
+        [[nodiscard]] const std::vector<ScopeResult>& lastResults() const { return lastResults_; }
+        [[nodiscard]] double lastFrameMs() const { return lastFrameMs_; }
+        [[nodiscard]] uint64_t lastFrameNumber() const { return lastFrameNumber_; }
+        // Statistics scopes of the most recently completed frame that had any.
+        [[nodiscard]] const std::vector<StatisticsResult>& lastStatistics() const { return lastStatistics_; }
+        [[nodiscard]] uint64_t lastStatisticsFrame() const { return lastStatisticsFrame_; }
+
+    private:
+        struct FrameSlot {
+            std::vector<const char*> names;
+            std::vector<const char*> statistics;
+            uint64_t                 frameNumber = 0;
+            bool                     pending = false;
+        };
+
+        void collect(uint32_t frameIndex);
+        void collectStatistics(FrameSlot& slot, uint32_t frameIndex);
+        void calibrate();
+        [[nodiscard]] uint32_t firstQuery(uint32_t frameIndex) const { return frameIndex * MAX_SCOPES_PER_FRAME * 2; }
+
+        Device&                  device_;
+        VkQueryPool              queryPool_ = VK_NULL_HANDLE;
+        VkQueryPool              statisticsPool_ = VK_NULL_HANDLE;
+        bool                     statisticsActive_ = false;
+        std::vector<FrameSlot>   slots_;
+        uint32_t                 currentSlot_  = 0;
+        double                   nsPerTick_    = 1.0;
+        uint64_t                 validMask_    = ~0ull;
+        int64_t                  offsetNs_     = 0;   // cpu_ns = gpu_ns + offsetNs_
+        std::vector<uint64_t>    readback_;
+        std::vector<ScopeResult> lastResults_;
+        std::vector<StatisticsResult> lastStatistics_;
+        uint64_t                 lastStatisticsFrame_ = 0;
+        double                   lastFrameMs_  = 0.0;
+        uint64_t                 lastFrameNumber_ = 0;
+    };
+
+} // namespace vkp::graphics
+
+#define VKP_GPU_SCOPE_CONCAT_INNER(a, b) a##b
+#define VKP_GPU_SCOPE_CONCAT(a, b) VKP_GPU_SCOPE_CONCAT_INNER(a, b)
+#define VKP_GPU_SCOPE(profiler, cmd, name) \
+    ::vkp::graphics::GpuProfiler::Scope VKP_GPU_SCOPE_CONCAT(vkp_gpu_scope_, __LINE__){ profiler, cmd, name }
+// Timestamps and pipeline statistics around draws.
+#define VKP_GPU_DRAW_SCOPE(profiler, cmd, name) \
+    VKP_GPU_SCOPE(profiler, cmd, name); \
+    ::vkp::graphics::GpuProfiler::StatisticsScope VKP_GPU_SCOPE_CONCAT(vkp_gpu_statistics_, __LINE__){ profiler, cmd, name }
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // Host allocation callbacks handed to the driver. COMMAND and OBJECT scope allocations that fit
+    // a size class come from pooled free lists; everything else goes to aligned operator new. Every
+    // allocation is counted per scope so churn during startup and resize becomes visible.
+    class HostAllocator {
+    public:
+        static constexpr size_t SCOPE_COUNT = 5;   // VK_SYSTEM_ALLOCATION_SCOPE_COMMAND .. INSTANCE
+
+        struct ScopeStats {
+            uint64_t allocations = 0;   // a moving reallocation counts as one allocation and one free
+            uint64_t frees       = 0;
+            uint64_t liveBytes   = 0;
+            uint64_t peakBytes   = 0;
+            uint64_t pooled      = 0;   // allocations served from a size class
+        };
+
+        struct Stats {
+            std::array<ScopeStats, SCOPE_COUNT> scopes{};
+            uint64_t reservedBytes = 0;   // chunk memory held by the size classes
+            uint64_t internalBytes = 0;   // driver-internal allocations reported through notifications
+        };
+
+        HostAllocator();
+        ~HostAllocator();
+
+        HostAllocator(const HostAllocator&) = delete;
+        HostAllocator& operator=(const HostAllocator&) = delete;
+
+        // Returns an allocator when VKP_HOST_ALLOCATOR is set to a non-zero value, else nullptr.
+        static std::unique_ptr<HostAllocator> fromEnvironment();
+
+        [[nodiscard]] const VkAllocationCallbacks* callbacks() const { return &callbacks_; }
+        [[nodiscard]] Stats stats() const;
+
+        // Logs allocations per scope since `before`, e.g. around a swap chain recreation.
+        static void logDelta(const char* label, const Stats& before, const Stats& after);
+        static const char* scopeName(size_t scope);
+
+    private:
+        // Each allocation is preceded by this header; `offset` leads back to the start of the block.
+        struct Header {
+            uint64_t size;
+            uint32_t offset;
+            uint8_t  sizeClass;
+            uint8_t  scope;
+            uint8_t  alignmentShift;   // log2 of the block alignment
+        };
+        static constexpr size_t  HEADER_SIZE     = 16;
+        static_assert(sizeof(Header) <= HEADER_SIZE);
+        static constexpr uint8_t NO_CLASS        = 0xff;
+        static constexpr size_t  MIN_CLASS_SHIFT = 6;    // 64 bytes
+        static constexpr size_t  CLASS_COUNT     = 7;    // .. 4 KiB
+        static constexpr size_t  CHUNK_SIZE      = 64 * 1024;
+
+        struct SizeClass {
+            std::mutex         mutex;
+            void*              freeList = nullptr;
+            std::vector<void*> chunks;
+        };
+
+        struct AtomicScopeStats {
+            std::atomic<uint64_t> allocations{ 0 };
+            std::atomic<uint64_t> frees{ 0 };
+            std::atomic<uint64_t> liveBytes{ 0 };
+            std::atomic<uint64_t> peakBytes{ 0 };
+            std::atomic<uint64_t> pooled{ 0 };
+        };
+
+        void* allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+        void* reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+        void  release(void* memory);
+        void* popBlock(size_t sizeClass);
+        void  pushBlock(size_t sizeClass, void* block);
+        void  countAllocation(uint8_t scope, uint64_t size, bool pooled);
+        void  addLiveBytes(uint8_t scope, uint64_t size);
+        static bool isPoolableScope(VkSystemAllocationScope scope);
+
+        static Header* headerOf(void* memory) {
+            return reinterpret_cast<Header*>(static_cast<std::byte*>(memory) - HEADER_SIZE);
+        }
+
+        static void* VKAPI_PTR onAllocation(void* user, size_t size, size_t alignment, VkSystemAllocationScope scope);
+        static void* VKAPI_PTR onReallocation(void* user, void* original, size_t size, size_t alignment,
+                                              VkSystemAllocationScope scope);
+        static void  VKAPI_PTR onFree(void* user, void* memory);
+        static void  VKAPI_PTR onInternalAllocation(void* user, size_t size, VkInternalAllocationType type,
+                                                    VkSystemAllocationScope scope);
+        static void  VKAPI_PTR onInternalFree(void* user, size_t size, VkInternalAllocationType type,
+                                              VkSystemAllocationScope scope);
+
+        VkAllocationCallbacks                         callbacks_{};
+        std::array<SizeClass, CLASS_COUNT>            classes_;
+        std::array<AtomicScopeStats, SCOPE_COUNT>     scopes_;
+        std::atomic<uint64_t>                         reservedBytes_{ 0 };
+        std::atomic<uint64_t>                         internalBytes_{ 0 };
+    };
+
+} // namespace vkp::graphics
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // Where one mip level lies in a KTX2 file.
+    struct Ktx2Level {
+        uint64_t offset = 0;
+        uint64_t size   = 0;
+        uint32_t width  = 0;
+        uint32_t height = 0;
+    };
+
+    // What the loader needs from a KTX2 file: the format, the base size and the mip levels
+    // stored in it, finest first.
+    struct Ktx2Image {
+        VkFormat               format = VK_FORMAT_UNDEFINED;
+        // Texel block of the format: 1x1 for uncompressed ones.
+        uint32_t               blockWidth  = 1;
+        uint32_t               blockHeight = 1;
+        uint32_t               blockBytes  = 0;
+        uint32_t               width  = 0;
+        uint32_t               height = 0;
+        std::vector<Ktx2Level> levels;
+        // levelCount 0 in the header: the file holds the base level and asks for the rest to be generated.
+        bool                   generateMips = false;
+    };
+
+    // Parses the header and level index of a KTX2 file held in memory. Only single-layer,
+    // single-face 2D textures without supercompression, in a colour format with a known block
+    // size, are accepted; throws std::runtime_error for anything else, for levels that lie
+    // outside `size` and for levels smaller than their extent needs.
+    Ktx2Image parseKtx2(const std::byte* data, size_t size);
+
+    // Mip levels of a full chain for a `width` x `height` base level.
+    uint32_t fullMipCount(uint32_t width, uint32_t height);
+
+} // namespace vkp::graphics
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "device.h"
+
+#include <vulkan/vulkan.h>
+
+namespace vkp::graphics {
+
+    // Colour and depth images with their own render pass and framebuffer, for rendering
+    // without presenting. The attachment formats match the swap chain's, so its pipelines
+    // are compatible; the colour image is left in FINAL_LAYOUT for readback passes.
+    // With `dynamicRendering` only the colour image is created; the caller renders into it with
+    // vkCmdBeginRendering, brings its own depth buffer and handles the layout transitions.
+    class OffscreenTarget {
+    public:
+        static constexpr VkImageLayout FINAL_LAYOUT = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        OffscreenTarget(Device& device, VkExtent2D extent, VkFormat colorFormat, VkFormat depthFormat,
+                        bool dynamicRendering = false);
+        ~OffscreenTarget();
+
+        OffscreenTarget(const OffscreenTarget&) = delete;
+        OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+        [[nodiscard]] VkRenderPass  renderPass()  const { return renderPass_; }
+        [[nodiscard]] VkFramebuffer framebuffer() const { return framebuffer_; }
+        [[nodiscard]] VkImage       colorImage()  const { return colorImage_; }
+        [[nodiscard]] VkImageView   colorView()   const { return colorView_; }
+        [[nodiscard]] VkFormat      colorFormat() const { return colorFormat_; }
+        [[nodiscard]] VkExtent2D    extent()      const { return extent_; }
+
+    private:
+        void createImage(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect,
+                         VkImage& image, VkDeviceMemory& memory, VkImageView& view) const;
+        void createRenderPass(VkFormat depthFormat);
+        void createFramebuffer();
+
+        Device&        device_;
+        VkExtent2D     extent_;
+        VkFormat       colorFormat_;
+
+        VkImage        colorImage_  = VK_NULL_HANDLE;
+        VkDeviceMemory colorMemory_ = VK_NULL_HANDLE;
+        VkImageView    colorView_   = VK_NULL_HANDLE;
+        VkImage        depthImage_  = VK_NULL_HANDLE;
+        VkDeviceMemory depthMemory_ = VK_NULL_HANDLE;
+        VkImageView    depthView_   = VK_NULL_HANDLE;
+        VkRenderPass   renderPass_  = VK_NULL_HANDLE;
+        VkFramebuffer  framebuffer_ = VK_NULL_HANDLE;
+    };
+
+} // namespace vkp::graphics
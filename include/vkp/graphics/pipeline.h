@@ -1,6 +1,7 @@
 #pragma once
 
 #include "device.h"
+#include "shader_compiler.h"
 
 #include <string>
 #include <vector>
@@ -26,14 +27,29 @@ namespace vkp::graphics {
         VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
         VkRenderPass     renderPass     = VK_NULL_HANDLE;
         uint32_t         subpass        = 0;
+
+        // Used instead of renderPass/subpass when renderPass is null (dynamic rendering).
+        VkFormat colorAttachmentFormat = VK_FORMAT_UNDEFINED;
+        VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+    };
+
+    // Vertex/fragment modules loaded ahead of pipeline creation, e.g. on a worker thread.
+    struct ShaderModules {
+        VkShaderModule vert = VK_NULL_HANDLE;
+        VkShaderModule frag = VK_NULL_HANDLE;
     };
 
     class Pipeline {
     public:
         Pipeline(
            Device& device,
-           const std::string& vertFilepath,
-           const std::string& fragFilepath,
+           const ShaderPermutation& vert,
+           const ShaderPermutation& frag,
+           const PipelineConfigInfo& configInfo);
+        // Takes ownership of the given modules.
+        Pipeline(
+           Device& device,
+           const ShaderModules& modules,
            const PipelineConfigInfo& configInfo);
         ~Pipeline();
 
@@ -44,15 +60,26 @@ namespace vkp::graphics {
 
         static void defaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 
+        // Compiles both stages through the ShaderCompiler cache, in parallel on a miss, and
+        // creates their modules; safe to call from any thread.
+        static ShaderModules loadShaderModules(
+           const Device& device,
+           const ShaderPermutation& vert,
+           const ShaderPermutation& frag);
+        // Single-module variant, e.g. for compute passes; the caller owns the module.
+        static VkShaderModule loadShaderModule(const Device& device, const ShaderPermutation& shader);
+        // Modules for SPIR-V that was compiled already.
+        static ShaderModules createShaderModules(
+           const Device& device,
+           const std::vector<uint32_t>& vert,
+           const std::vector<uint32_t>& frag);
+
     private:
-        static std::vector<char> readFile(const std::string& filepath);
 
-        void createGraphicsPipeline(
-           const std::string& vertFilepath,
-           const std::string& fragFilepath,
-           const PipelineConfigInfo& configInfo);
+        void createGraphicsPipeline(const PipelineConfigInfo& configInfo);
 
-        void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) const;
+        static void createShaderModule(
+           const Device& device, const std::vector<uint32_t>& code, VkShaderModule* shaderModule);
 
         Device&        device;
         VkPipeline     graphicsPipeline = VK_NULL_HANDLE;
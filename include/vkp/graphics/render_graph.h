@@ -0,0 +1,209 @@
+#pragma once
+
+#include "device.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    using ResourceId = uint32_t;
+
+    // How a pass uses a resource; decides the layout, stages and access of the barriers around it.
+    enum class ResourceUsage {
+        ColorAttachment,
+        DepthAttachment,
+        SampledFragment,
+        SampledCompute,
+        StorageCompute,
+        TransferSrc,
+        TransferDst,
+        VertexInput,
+    };
+
+    // An image created and owned by the graph. Usage flags are derived from the passes using it.
+    struct TransientImageDesc {
+        VkFormat   format = VK_FORMAT_UNDEFINED;
+        VkExtent2D extent{};
+    };
+
+    // An image owned elsewhere, e.g. a swap chain image. `initialStages` and `initialAccess` describe
+    // its previous user (or a semaphore wait); after the last pass it is moved to `finalLayout` for
+    // the given consumer stages and access.
+    struct ImportedImage {
+        VkImage              image         = VK_NULL_HANDLE;
+        VkImageView          view          = VK_NULL_HANDLE;
+        VkFormat             format        = VK_FORMAT_UNDEFINED;
+        VkExtent2D           extent{};
+        VkImageLayout        initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags initialStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        VkAccessFlags        initialAccess = 0;   // writes still to be made available, if any
+        VkImageLayout        finalLayout   = VK_IMAGE_LAYOUT_UNDEFINED;   // UNDEFINED keeps the last layout
+        VkPipelineStageFlags finalStages   = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        VkAccessFlags        finalAccess   = 0;
+    };
+
+    class RenderGraph;
+
+    // Collects what a pass reads and writes while it is being added.
+    class PassBuilder {
+    public:
+        void read(ResourceId resource, ResourceUsage usage);
+        void write(ResourceId resource, ResourceUsage usage);
+        // Attachments make the graph wrap the pass in vkCmdBeginRendering. With a clear value the
+        // previous contents are discarded, otherwise they are loaded and count as a read.
+        void colorAttachment(ResourceId resource, std::optional<VkClearColorValue> clear = std::nullopt);
+        void depthAttachment(ResourceId resource, std::optional<float> clear = std::nullopt);
+        // The pass has effects outside the graph (readback, queries) and is never culled.
+        void sideEffects();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+        RenderGraph& graph_;
+        uint32_t     pass_;
+    };
+
+    // A frame graph. Passes declare their reads and writes of named resources; compile() culls
+    // passes whose results are never used, places transient images with disjoint lifetimes in
+    // shared memory, and plans one batched barrier per pass. execute() replays that plan.
+    // Passes run in declaration order, which must already be a valid producer/consumer order.
+    class RenderGraph {
+    public:
+        using ExecuteFn = std::function<void(VkCommandBuffer cmd, const RenderGraph& graph)>;
+
+        // One batched vkCmdPipelineBarrier; image handles are looked up at execute time.
+        struct ImageBarrier {
+            ResourceId         resource;
+            VkImageAspectFlags aspect;
+            VkImageLayout      oldLayout;
+            VkImageLayout      newLayout;
+            VkAccessFlags      srcAccess;
+            VkAccessFlags      dstAccess;
+        };
+        struct Barrier {
+            VkPipelineStageFlags      srcStages = 0;
+            VkPipelineStageFlags      dstStages = 0;
+            VkAccessFlags             memorySrcAccess = 0;   // buffers use one global memory barrier
+            VkAccessFlags             memoryDstAccess = 0;
+            std::vector<ImageBarrier> images;
+            [[nodiscard]] bool empty() const { return srcStages == 0; }
+        };
+
+        explicit RenderGraph(Device& device);
+        // Without a device compile() only plans: no images or memory are created, transients are
+        // sized from their format and extent, and the graph can't be executed. Used by the tests.
+        RenderGraph();
+        ~RenderGraph();
+
+        RenderGraph(const RenderGraph&) = delete;
+        RenderGraph& operator=(const RenderGraph&) = delete;
+
+        ResourceId createImage(const std::string& name, const TransientImageDesc& desc);
+        ResourceId importImage(const std::string& name, const ImportedImage& image);
+        ResourceId importBuffer(const std::string& name, VkBuffer buffer);
+        // Swaps the handles of an imported image, e.g. the acquired swap chain image, without recompiling.
+        void bindImage(ResourceId resource, VkImage image, VkImageView view);
+
+        void addPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, ExecuteFn execute);
+
+        // Creates the transient images and plans barriers. Must be called again after adding passes.
+        void compile();
+        void execute(VkCommandBuffer cmd) const;
+
+        [[nodiscard]] VkImage     image(ResourceId resource) const { return resources_[resource].image; }
+        [[nodiscard]] VkImageView view(ResourceId resource) const { return resources_[resource].view; }
+        [[nodiscard]] VkExtent2D  extent(ResourceId resource) const { return resources_[resource].extent; }
+        [[nodiscard]] bool        culled(const std::string& pass) const;
+        // The barrier recorded before a pass, and the one after the last pass.
+        [[nodiscard]] const Barrier& barrierBefore(const std::string& pass) const;
+        [[nodiscard]] const Barrier& finalBarrier() const { return after_; }
+        // The memory block a transient was placed in; transients with the same block alias.
+        [[nodiscard]] int         memoryBlock(ResourceId resource) const { return resources_[resource].block; }
+
+        // Results of the last compile(), for logging.
+        struct Stats {
+            uint32_t     passes          = 0;
+            uint32_t     culledPasses    = 0;
+            uint32_t     barriers        = 0;   // vkCmdPipelineBarrier calls per frame
+            uint32_t     transientImages = 0;
+            uint32_t     memoryBlocks    = 0;
+            VkDeviceSize transientBytes  = 0;   // before aliasing
+            VkDeviceSize allocatedBytes  = 0;   // after aliasing
+        };
+        [[nodiscard]] const Stats& stats() const { return stats_; }
+
+    private:
+        friend class PassBuilder;
+
+        struct Resource {
+            std::string       name;
+            bool              isImage  = true;
+            bool              imported = false;
+            VkImage           image    = VK_NULL_HANDLE;
+            VkImageView       view     = VK_NULL_HANDLE;
+            VkBuffer          buffer   = VK_NULL_HANDLE;
+            VkFormat          format   = VK_FORMAT_UNDEFINED;
+            VkExtent2D        extent{};
+            ImportedImage     import{};
+            // Filled by compile().
+            VkImageUsageFlags usage    = 0;
+            int               firstUse = -1;
+            int               lastUse  = -1;
+            int               block    = -1;
+        };
+
+        struct Access {
+            ResourceId    resource;
+            ResourceUsage usage;
+            bool          read;
+            bool          write;
+        };
+
+        struct Attachment {
+            ResourceId          resource;
+            VkAttachmentLoadOp  loadOp;
+            VkClearValue        clear;
+            VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_STORE;   // set by compile()
+        };
+
+        struct Pass {
+            std::string                name;
+            std::vector<Access>        accesses;
+            std::vector<Attachment>    colorAttachments;
+            std::optional<Attachment>  depthAttachment;
+            ExecuteFn                  execute;
+            bool                       sideEffects = false;
+            bool                       culled      = false;
+            Barrier                    before;
+        };
+
+        struct MemoryBlock {
+            VkMemoryRequirements requirements{};
+            int                  lastUse = -1;
+            VkDeviceMemory       memory  = VK_NULL_HANDLE;
+        };
+
+        void addAccess(uint32_t pass, ResourceId resource, ResourceUsage usage, bool read, bool write);
+        void cull();
+        void allocateTransients();
+        void planBarriers();
+        void releaseTransients();
+        void recordBarrier(VkCommandBuffer cmd, const Barrier& barrier) const;
+
+        Device*                   device_;
+        std::vector<Resource>     resources_;
+        std::vector<Pass>         passes_;
+        std::vector<uint32_t>     order_;
+        std::vector<MemoryBlock>  blocks_;
+        Barrier                   after_;   // moves imported images to their final layouts
+        Stats                     stats_;
+    };
+
+} // namespace vkp::graphics
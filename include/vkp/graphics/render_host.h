@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vkp/gui/window.h>
+
+#include "device.h"
+#include "swap_chain.h"
+
+#include <functional>
+#include <memory>
+
+namespace vkp::graphics {
+
+    // Owns what outlives a reload of the renderer module: the window, the Vulkan instance and
+    // device, and the swap chain with its frame fences and semaphores. The renderer borrows all
+    // of them; it creates the swap chain on first use and may replace it on resize.
+    class RenderHost {
+    public:
+        static constexpr int WIDTH  = 1280;
+        static constexpr int HEIGHT = 720;
+
+        RenderHost() = default;
+        ~RenderHost();
+
+        RenderHost(const RenderHost&) = delete;
+        RenderHost& operator=(const RenderHost&) = delete;
+
+        [[nodiscard]] Window& window() { return window_; }
+        [[nodiscard]] Device& device() { return device_; }
+        [[nodiscard]] std::unique_ptr<SwapChain>& swapChain() { return swapChain_; }
+
+        // Main thread: `check` is polled by the window loop; once it returns true the renderer
+        // stops so its module can be swapped.
+        void watchForReload(std::function<bool()> check) { reloadCheck_ = std::move(check); }
+        // Main thread: stays true until clearReload.
+        bool reloadRequested();
+        void clearReload() { reloadRequested_ = false; }
+
+    private:
+        Window                     window_{ WIDTH, HEIGHT, "demo", 500, 500 };
+        Device                     device_{ window_ };
+        std::unique_ptr<SwapChain> swapChain_;
+        std::function<bool()>      reloadCheck_;
+        bool                       reloadRequested_{ false };
+    };
+
+} // namespace vkp::graphics
@@ -1,56 +1,129 @@
 #pragma once
 
+#include <vkp/core/frame_stats.h>
+#include <vkp/core/metrics_server.h>
 #include <vkp/gui/window.h>
 #include <vkp/gui/imgui_layer.h>
 
+#include "deletion_queue.h"
 #include "device.h"
+#include "frame_capture.h"
+#include "gpu_profiler.h"
 #include "pipeline.h"
+#include "render_graph.h"
+#include "render_host.h"
+#include "renderer_conf.h"
+#include "sdf_volume.h"
+#include "sequence_renderer.h"
+#include "submit_thread.h"
 #include "swap_chain.h"
+#include "temporal_reconstruction.h"
+#include "texture_streamer.h"
+#include "video_stream.h"
 
 #include <memory>
 #include <vector>
 
 namespace vkp::graphics {
 
-    struct renderer_conf {
-        int start_pos_x;
-        int start_pos_y;
-        int start_width;
-        int start_height;
-        const char* name;
-    };
+    // The frame logic. Everything here is rebuilt when the renderer module is reloaded; the
+    // window, device and swap chain are borrowed from the RenderHost and survive it.
     class Renderer {
     public:
-        static constexpr int WIDTH  = 1280;
-        static constexpr int HEIGHT = 720;
+        // The main thread wakes at least this often to pump main-thread jobs.
+        static constexpr double EVENT_WAIT_SECONDS = 0.01;
 
-        Renderer();
+        explicit Renderer(RenderHost& host);
         ~Renderer();
 
         bool init(const renderer_conf& config);
         bool run();
 
+        // Device memory per heap and category, refreshed a few times a second while running.
+        [[nodiscard]] const MemoryReport& memoryReport() const { return memoryReport_; }
+
     private:
         int   width_{ 0 };
         int   height_{ 0 };
+        SequenceSettings sequence_{};
+        bool  dynamicRendering_{ false };
+        TemporalMode temporalMode_{ TemporalMode::Off };
+        bool  useSubmitThread_{ true };
 
         void createPipelineLayout();
         void recreateSwapChain();
-        void createPipeline();
+        [[nodiscard]] std::unique_ptr<Pipeline> createPipeline(const ShaderModules& modules);
+        [[nodiscard]] const Pipeline& scenePipeline() const;
         void createCommandBuffers();
-        void freeCommandBuffers();
-        void recordCommandBuffer(int imageIndex) const;
+        // `previousTemporal` is the temporal reconstruction being replaced, if any.
+        void buildFrameGraph(const TemporalReconstruction* previousTemporal = nullptr);
+        [[nodiscard]] std::unique_ptr<RenderGraph> buildSceneGraph(VkExtent2D extent);
+        void recordCommandBuffer(int imageIndex, uint64_t frameNumber);
+        void recordScene(VkCommandBuffer cmd, VkExtent2D extent, float time) const;
+        // Renders `resolution`-sized image coordinates into a `viewport`-sized target with the
+        // given scene pipeline; `sparse` selects the temporal pattern (0: every pixel).
+        void recordScene(VkCommandBuffer cmd, VkExtent2D viewport, VkExtent2D resolution, float time,
+                         uint32_t sparse, const Pipeline& scenePipeline) const;
+        void recordSdfBake(VkCommandBuffer cmd, float time);
+        void recordReadback(VkCommandBuffer cmd, uint32_t frameIndex, VkImage image, VkImageView view,
+                            VkImageLayout layout, VkFormat format, VkExtent2D extent, uint64_t frameNumber) const;
+        // Main thread: pumps GLFW and forwards window events while renderLoop runs on its own thread.
+        void runWindowed();
+        void renderLoop();
+        // Render thread: drains the window's event queue; false once the window should close.
+        bool pumpWindowEvents();
         void drawFrame();
-        void shutdown() const;
+        void endFrame(uint64_t frameStartNs, uint64_t frameNumber);
+        void updateMemoryReport(uint64_t nowNs);
+        void runOffscreen();
+        void renderSequence();
+        void runSdfBenchmark();
+        void shutdown();
 
-        Window window{ WIDTH, HEIGHT, "demo", 500, 500 };
-        vkp::graphics::Device device{ window };
-        std::unique_ptr<vkp::graphics::SwapChain> swapChain;
+        RenderHost&                               host_;
+        Window&                                   window;
+        vkp::graphics::Device&                    device;
+        std::unique_ptr<vkp::graphics::SwapChain>& swapChain;
         std::unique_ptr<vkp::graphics::Pipeline>  pipeline;
+        // Marches sdfVolume_ instead of the analytic SDF; used while useBakedSdf_ is set.
+        std::unique_ptr<Pipeline>                 bakedPipeline_;
+        std::unique_ptr<SdfVolume>                sdfVolume_;
+        std::unique_ptr<SdfBenchmark>             sdfBenchmark_;
+        bool                                      useBakedSdf_{ false };
+        DeletionQueue                             deletionQueue_;
+        // Records the frame when dynamic rendering is used; the render pass path stays hand-coded.
+        // One per frame in flight, indexed by the frame slot.
+        std::vector<std::unique_ptr<RenderGraph>> frameGraphs_;
+        ResourceId                                colorTarget_{};
+        ResourceId                                depthTarget_{};
+        float                                     sceneTime_{ 0.f };
+        // Replaces frameGraphs_ in the window loop when a temporal mode is active.
+        std::unique_ptr<TemporalReconstruction>   temporal_;
         VkPipelineLayout                          pipelineLayout{};
 
         std::vector<VkCommandBuffer>              commandBuffers;
         std::unique_ptr<vkp::ImGuiLayer>          imguiLayer;
+        std::unique_ptr<GpuProfiler>              gpuProfiler;
+        std::unique_ptr<FrameCapture>             frameCapture;
+        std::unique_ptr<VideoStream>              videoStream;
+        std::unique_ptr<SequenceRenderer>         sequenceRenderer;
+        std::unique_ptr<core::MetricsServer>      metricsServer;
+        // Created by the render loop; drained before the swap chain or the device is touched.
+        std::unique_ptr<SubmitThread>             submitThread_;
+        // The overlay lists how far each texture has streamed in; the Textures window samples one.
+        std::unique_ptr<TextureStreamer>          textureStreamer_;
+        uint64_t                                  frameNumber_{ 0 };
+        bool                                      closeRequested_{ false };
+        core::FrameStatsRing                      frameStats_;
+        uint64_t                                  lastFrameStartNs_{ 0 };
+        // Window loop totals for the log on exit; the first frame has no sample.
+        uint32_t                                  frameLimit_{ 0 };
+        uint64_t                                  sampledFrames_{ 0 };
+        double                                    cpuMsTotal_{ 0.0 };
+        double                                    frameMsTotal_{ 0.0 };
+        MemoryReport                              memoryReport_;
+        uint64_t                                  lastMemoryPollNs_{ 0 };
+        std::vector<bool>                         heapOverBudget_;
     };
 
 } // namespace vkp::graphics
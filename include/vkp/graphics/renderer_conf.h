@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vkp/core/image_writer.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    enum class VideoFormat {
+        Y4M,  // YUV4MPEG2 container, I420 planes
+        NV12, // headerless NV12 frames
+    };
+
+    // Accepts "y4m" or "nv12"; leaves `format` untouched and returns false otherwise.
+    bool parseVideoFormat(const std::string& name, VideoFormat& format);
+
+    // Which pixels the scene shades per frame in temporal mode.
+    enum class TemporalMode {
+        Off,            // every pixel, every frame
+        Checkerboard,   // one pixel of each 2x1 pair
+        Quarter,        // one pixel of each 2x2 block
+    };
+
+    // Parses "off", "checker" or "quarter"; returns false for anything else.
+    bool parseTemporalMode(const std::string& name, TemporalMode& mode);
+
+    // Everything the command line decides. The host parses it and hands it to each renderer it
+    // creates, so a reloaded renderer module starts with the same settings.
+    struct renderer_conf {
+        int start_pos_x;
+        int start_pos_y;
+        int start_width;
+        int start_height;
+        const char* name;
+        // Optional: write every presented frame into this directory.
+        const char*           capture_dir    = nullptr;
+        core::ImageFileFormat capture_format = core::ImageFileFormat::PNG;
+        // Optional: stream frames as YUV 4:2:0 to this file, or to stdout for "-".
+        const char*           video_path     = nullptr;
+        VideoFormat           video_format   = VideoFormat::Y4M;
+        uint32_t              video_fps      = 60;
+        // Render this many frames offscreen instead of running the window. Shader time starts
+        // at sequence_start and advances by sequence_step, or 1/video_fps when that is 0.
+        uint32_t              offscreen_frames = 0;
+        double                sequence_start   = 0.0;
+        double                sequence_step    = 0.0;
+        // Frames slower than this count as over budget in the overlay and are reported as hitches.
+        float                 frame_budget_ms  = 1000.f / 60.f;
+        // Optional: serve Prometheus metrics on "unix:/path.sock" or a localhost TCP port.
+        const char*           metrics_endpoint = nullptr;
+        // Render with vkCmdBeginRendering instead of render pass and framebuffer objects when the
+        // device supports VK_KHR_dynamic_rendering.
+        bool                  dynamic_rendering = true;
+        // Shade a checkerboard or quarter of the pixels per frame and reconstruct the rest from
+        // history. Needs dynamic rendering; offscreen sequences always render at full rate.
+        TemporalMode          temporal_mode = TemporalMode::Off;
+        // Resolution of the baked SDF volume; 0 marches the analytic SDF. The volume is re-baked
+        // once the scene has moved by more than sdf_threshold voxels. Not combined with temporal_mode.
+        uint32_t              sdf_volume    = 0;
+        float                 sdf_threshold = 1.f;
+        // Offscreen only: render the sequence with the analytic and the baked SDF and write
+        // per-frame GPU times to this CSV file. Needs sdf_volume.
+        const char*           sdf_benchmark = nullptr;
+        // Window loop: submit and present on a separate thread while the next frame is recorded.
+        bool                  submit_thread = true;
+        // Window loop: stop after this many frames and log the mean CPU time per frame; 0 runs
+        // until the window is closed.
+        uint32_t              window_frames = 0;
+        // Window loop: KTX2 files streamed in the background, within texture_budget_mb of device memory.
+        std::vector<const char*> textures;
+        uint32_t              texture_budget_mb = 256;
+    };
+
+} // namespace vkp::graphics
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "render_host.h"
+#include "renderer_conf.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+namespace vkp::graphics {
+
+    class Renderer;
+
+    // Entry points of the renderer module. The host finds them through a single C symbol, so
+    // the module can live in a shared library that is swapped while the program runs.
+    struct RendererModuleApi {
+        Renderer* (*create)(RenderHost& host);
+        bool      (*init)(Renderer& renderer, const renderer_conf& config);
+        // Returns when the window closes or the host asks for a reload.
+        bool      (*run)(Renderer& renderer);
+        void      (*destroy)(Renderer* renderer);
+    };
+
+    // Holds the renderer module: either linked in, or a shared library loaded with dlopen and
+    // reloaded when it changes on disk. Loading copies the library first, so the build can
+    // overwrite the original while the copy is mapped.
+    class RendererModule {
+    public:
+        static constexpr const char* ENTRY_POINT = "vkpRendererModule";
+        // A rebuilt library counts as changed once it has stayed untouched this long.
+        static constexpr std::chrono::milliseconds RELOAD_SETTLE{ 300 };
+        // The library file is checked at most this often.
+        static constexpr std::chrono::milliseconds POLL_INTERVAL{ 100 };
+
+        // The module linked into the executable; never changes.
+        explicit RendererModule(const RendererModuleApi& api);
+#ifdef __linux__
+        // Loads the library at `path`; throws if it can't be loaded.
+        explicit RendererModule(std::filesystem::path path);
+        // `fileName` in the directory of the running executable.
+        static std::filesystem::path besideExecutable(const char* fileName);
+#endif
+        ~RendererModule();
+
+        RendererModule(const RendererModule&) = delete;
+        RendererModule& operator=(const RendererModule&) = delete;
+
+        [[nodiscard]] const RendererModuleApi& api() const { return *api_; }
+
+        // Main thread: true once the library on disk changed and settled.
+        bool changed();
+        // Main thread: swaps in the library on disk, or keeps the loaded one if that fails.
+        // Nothing the loaded module created may exist any more.
+        bool reload();
+
+    private:
+#ifdef __linux__
+        struct FileState {
+            std::filesystem::file_time_type time{};
+            uintmax_t                       size = 0;
+            bool operator==(const FileState&) const = default;
+        };
+        [[nodiscard]] FileState fileState() const;
+        // Maps a copy of the library and switches to it; the previous one stays mapped.
+        // False keeps using the previous one.
+        bool load();
+
+        std::filesystem::path                 path_;
+        void*                                 library_{ nullptr };
+        uint32_t                              generation_{ 0 };
+        FileState                             loaded_{};
+        FileState                             seen_{};
+        std::chrono::steady_clock::time_point seenAt_{};
+        std::chrono::steady_clock::time_point polledAt_{};
+#endif
+        const RendererModuleApi*              api_{ nullptr };
+    };
+
+} // namespace vkp::graphics
+
+// Exported by the renderer module.
+extern "C" const vkp::graphics::RendererModuleApi* vkpRendererModule();
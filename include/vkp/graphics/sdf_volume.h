@@ -0,0 +1,118 @@
+#pragma once
+
+#include "device.h"
+#include "gpu_profiler.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // The scene SDF baked into a 3D distance texture by a compute pass, so the SCENE_BAKED_SDF
+    // permutation of sb_shader.frag marches with one trilinear lookup per step instead of the
+    // warp and four boxes. The volume covers the region where the warp is active; outside it the
+    // shader evaluates the plain boxes. It is re-baked only once the time-dependent parameters
+    // have moved the field by more than `thresholdVoxels` voxels. The image stays in GENERAL for
+    // both the bake and sampling.
+    class SdfVolume {
+    public:
+        static constexpr VkFormat FORMAT      = VK_FORMAT_R16_SFLOAT;
+        static constexpr float    HALF_EXTENT = 10.f;   // SDF_VOLUME_HALF_EXTENT in sdf.glsl
+
+        // FORMAT must support storage writes and linear filtering.
+        [[nodiscard]] static bool supported(const Device& device);
+
+        SdfVolume(Device& device, uint32_t resolution, float thresholdVoxels);
+        ~SdfVolume();
+
+        SdfVolume(const SdfVolume&) = delete;
+        SdfVolume& operator=(const SdfVolume&) = delete;
+
+        // Set 0 of the baked scene pipeline: the volume as a combined image sampler at binding 0.
+        [[nodiscard]] VkDescriptorSetLayout sampleSetLayout() const { return sampleSetLayout_; }
+        [[nodiscard]] VkDescriptorSet       sampleSet()       const { return sampleSet_; }
+
+        [[nodiscard]] bool needsBake(float time) const;
+        // Records the bake for `time` with the barriers around it. Outside of any rendering scope.
+        void bake(VkCommandBuffer cmd, float time);
+        // The next needsBake() returns true, e.g. when a sequence restarts.
+        void invalidate() { baked_ = false; }
+
+        [[nodiscard]] uint32_t resolution() const { return resolution_; }
+        [[nodiscard]] uint64_t bakes()      const { return bakes_; }
+
+    private:
+        // What sdf.glsl derives from time: the warp axis angle and the arm length.
+        struct Params {
+            float axisAngle = 0.f;
+            float armLength = 0.f;
+        };
+        [[nodiscard]] static Params params(float time);
+
+        void createImage();
+        void createPipeline();
+        void createDescriptors();
+
+        Device&               device_;
+        uint32_t              resolution_;
+        float                 threshold_;   // world units
+        VkImage               image_            = VK_NULL_HANDLE;
+        VkDeviceMemory        memory_           = VK_NULL_HANDLE;
+        VkImageView           view_             = VK_NULL_HANDLE;
+        VkSampler             sampler_          = VK_NULL_HANDLE;
+        VkDescriptorSetLayout bakeSetLayout_    = VK_NULL_HANDLE;
+        VkDescriptorSetLayout sampleSetLayout_  = VK_NULL_HANDLE;
+        VkDescriptorPool      descriptorPool_   = VK_NULL_HANDLE;
+        VkDescriptorSet       bakeSet_          = VK_NULL_HANDLE;
+        VkDescriptorSet       sampleSet_        = VK_NULL_HANDLE;
+        VkPipelineLayout      pipelineLayout_   = VK_NULL_HANDLE;
+        VkPipeline            pipeline_         = VK_NULL_HANDLE;
+        bool                  baked_            = false;
+        Params                bakedParams_{};
+        uint64_t              bakes_            = 0;
+    };
+
+    // Per-frame GPU timings and scene shader invocations of the analytic and baked SDF over the
+    // same offscreen sequence, written as CSV. Frames are attributed to a run by their frame number.
+    class SdfBenchmark {
+    public:
+        explicit SdfBenchmark(std::string path) : path_(std::move(path)) {}
+
+        // Frames numbered from `firstFrame` on belong to `variant`; their shader time is
+        // `startTime + index * timeStep`. `pixels` is the target size, for fragment invocations per pixel.
+        void beginRun(const char* variant, uint64_t firstFrame, double startTime, double timeStep, uint64_t pixels);
+        // Takes the profiler's most recently completed frame unless it was already seen.
+        void collect(const GpuProfiler& profiler);
+        // Writes the CSV and logs the mean GPU times of each variant.
+        bool finish() const;
+
+    private:
+        struct Run {
+            const char* variant;
+            uint64_t    firstFrame;
+            double      startTime;
+            double      timeStep;
+            uint64_t    pixels;
+        };
+        struct Row {
+            size_t   run;
+            uint64_t index;
+            double   frameMs;
+            double   sceneMs;
+            double   bakeMs;
+            // Zero without pipeline statistics.
+            uint64_t vertexInvocations;
+            uint64_t clippingPrimitives;
+            uint64_t fragmentInvocations;
+        };
+
+        std::string      path_;
+        std::vector<Run> runs_;
+        std::vector<Row> rows_;
+        uint64_t         lastFrame_ = UINT64_MAX;
+    };
+
+} // namespace vkp::graphics
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "device.h"
+#include "offscreen_target.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace vkp::graphics {
+
+    struct SequenceSettings {
+        double   startTime  = 0.0;
+        uint32_t frameCount = 0;
+        double   timeStep   = 1.0 / 60.0;
+    };
+
+    struct SequenceFrame {
+        uint32_t               slot;   // in-flight slot, the frameIndex for readback rings
+        uint64_t               index;  // position in the sequence
+        float                  time;   // shader time: startTime + index * timeStep
+        const OffscreenTarget& target;
+    };
+
+    struct SequenceStats {
+        uint64_t frames     = 0;
+        double   seconds    = 0.0;
+        double   fps        = 0.0;
+        double   fenceWaitMs = 0.0; // CPU time blocked on the GPU; high means GPU-bound
+    };
+
+    // Renders a fixed sequence of frames offscreen as fast as the GPU allows. Time comes from
+    // the frame index rather than the clock and nothing is presented, so neither wall time nor
+    // vsync limit throughput. FRAMES_IN_FLIGHT targets rotate: while the GPU renders one, the
+    // CPU collects the readback of the oldest and records the next.
+    class SequenceRenderer {
+    public:
+        static constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+
+        // Records one frame into `cmd`, which is begun and ended by the sequence renderer.
+        // The slot's previous frame has completed by then, so its readbacks can be collected.
+        using RecordFn = std::function<void(VkCommandBuffer cmd, const SequenceFrame& frame)>;
+
+        SequenceRenderer(Device& device, VkExtent2D extent, VkFormat colorFormat, VkFormat depthFormat,
+                         bool dynamicRendering = false);
+        ~SequenceRenderer();
+
+        SequenceRenderer(const SequenceRenderer&) = delete;
+        SequenceRenderer& operator=(const SequenceRenderer&) = delete;
+
+        [[nodiscard]] VkExtent2D extent() const { return targets_.front()->extent(); }
+
+        // Renders the whole sequence and waits for the GPU. Frames still pending readback are
+        // left to the caller's flush, as their slots were not reused.
+        SequenceStats run(const SequenceSettings& settings, const RecordFn& record);
+
+    private:
+        Device&                                       device_;
+        std::vector<std::unique_ptr<OffscreenTarget>> targets_;
+        std::vector<VkCommandBuffer>                  commandBuffers_;
+        std::vector<VkFence>                          fences_;
+    };
+
+} // namespace vkp::graphics
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vkp::graphics {
+
+    struct ShaderDefine {
+        std::string name;
+        std::string value;   // empty defines the name without a value
+    };
+
+    // A GLSL source file compiled with a set of defines. The stage follows the extension:
+    // .vert, .frag or .comp.
+    struct ShaderPermutation {
+        ShaderPermutation(const char* source, std::vector<ShaderDefine> defines = {})
+            : source(source), defines(std::move(defines)) {}
+        ShaderPermutation(std::filesystem::path source, std::vector<ShaderDefine> defines = {})
+            : source(std::move(source)), defines(std::move(defines)) {}
+
+        std::filesystem::path     source;
+        std::vector<ShaderDefine> defines;
+    };
+
+    // Compiles GLSL to SPIR-V in process with shaderc. Each permutation is keyed by a hash of
+    // its source, everything it includes, its defines and the compiler's settings and version.
+    // The key is looked up in memory, then in an on-disk cache, and compiled only on a miss. An
+    // edited source or include changes the key, so the next pipeline built from it picks the
+    // edit up. Thread-safe.
+    class ShaderCompiler {
+    public:
+        static constexpr const char* CACHE_DIR = "engine/cache/shaders";
+
+        static ShaderCompiler& get();
+
+        ShaderCompiler(const ShaderCompiler&) = delete;
+        ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+        // Throws std::runtime_error with the compiler's messages if the permutation doesn't compile.
+        [[nodiscard]] std::vector<uint32_t> compile(const ShaderPermutation& permutation);
+        // Compiles the misses in parallel on the job system and waits for them; results are in order.
+        [[nodiscard]] std::vector<std::vector<uint32_t>> compile(std::span<const ShaderPermutation> permutations);
+
+    private:
+        ShaderCompiler();
+
+        std::filesystem::path cacheDir_;
+        std::mutex            mutex_;
+        // By key; entries of superseded sources stay, as they are small.
+        std::unordered_map<std::string, std::vector<uint32_t>> memory_;
+    };
+
+} // namespace vkp::graphics
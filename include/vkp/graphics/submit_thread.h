@@ -0,0 +1,58 @@
+#pragma once
+
+#include "swap_chain.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace vkp::graphics {
+
+    // Submits and presents recorded frames on its own thread, in the order they were pushed, so
+    // the render thread can record the next frame while vkQueueSubmit and vkQueuePresentKHR run.
+    // While it is running it is the only user of the graphics and present queues; callers drain
+    // it before anything else touches them, before recreating the swap chain and before idling
+    // the device.
+    class SubmitThread {
+    public:
+        static constexpr size_t QUEUE_SIZE = SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+        SubmitThread();
+        // Drains the queue; errors from the last frames are dropped.
+        ~SubmitThread();
+
+        SubmitThread(const SubmitThread&) = delete;
+        SubmitThread& operator=(const SubmitThread&) = delete;
+
+        // Blocks while the queue is full.
+        void push(const FrameSubmission& frame);
+        // Blocks until at most `frames` pushed frames have not been presented yet.
+        void waitPending(uint64_t frames);
+        void drain() { waitPending(0); }
+
+        // The result that needs the most attention among the frames presented since the last
+        // call: an error, then VK_ERROR_OUT_OF_DATE_KHR, then VK_SUBOPTIMAL_KHR. Rethrows a
+        // failed submission.
+        VkResult takeResult();
+
+    private:
+        void run();
+
+        std::mutex                                 mutex_;
+        std::condition_variable                    queued_;
+        std::condition_variable                    presented_;
+        std::array<FrameSubmission, QUEUE_SIZE>    frames_{};
+        uint64_t                                   pushed_{ 0 };
+        uint64_t                                   done_{ 0 };
+        bool                                       stop_{ false };
+        VkResult                                   result_{ VK_SUCCESS };
+        std::exception_ptr                         error_;
+        std::thread                                thread_;
+    };
+
+} // namespace vkp::graphics
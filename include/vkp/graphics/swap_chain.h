@@ -7,16 +7,45 @@
 
 // std lib headers
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace vkp::graphics {
 
+class SwapChain;
+
+// Everything needed to submit and present one recorded frame, captured on the render thread so
+// the submission can happen later on another thread.
+struct FrameSubmission {
+  SwapChain *swapChain = nullptr;
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+  uint32_t imageIndex = 0;
+  VkSemaphore imageAvailable = VK_NULL_HANDLE;
+  VkSemaphore renderFinished = VK_NULL_HANDLE;
+  VkFence inFlightFence = VK_NULL_HANDLE;
+};
+
 class SwapChain {
  public:
   static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
-
-  SwapChain(Device &deviceRef, VkExtent2D windowExtent);
+  // acquireNextImage gives up the lock it shares with present at least this often.
+  static constexpr uint64_t ACQUIRE_SLICE_NS = 1'000'000;
+
+  // `extraUsage` is requested on top of COLOR_ATTACHMENT where the surface supports it,
+  // e.g. TRANSFER_SRC for frame capture or SAMPLED for the video pass.
+  // With `dynamicRendering` no render pass, framebuffers or depth images are created; the caller
+  // renders into the image views with vkCmdBeginRendering, brings its own depth buffer of
+  // getDepthFormat() and owns the layout transitions.
+  SwapChain(
+      Device &deviceRef,
+      VkExtent2D windowExtent,
+      VkImageUsageFlags extraUsage = 0,
+      bool dynamicRendering = false);
+  // Reuses the previous swap chain's requested usage and rendering mode and takes over its frame
+  // fences and semaphores.
+  // `previous` is retired through oldSwapchain but stays valid until the caller destroys it, which
+  // must wait until the frames submitted with it have completed.
   SwapChain(
       Device &deviceRef, VkExtent2D windowExtent, std::shared_ptr<SwapChain> previous);
 
@@ -26,22 +55,43 @@ class SwapChain {
   SwapChain &operator=(const SwapChain &) = delete;
 
   VkFramebuffer getFrameBuffer(int index) const { return swapChainFramebuffers[index]; }
+  // VK_NULL_HANDLE when the swap chain was created for dynamic rendering.
   VkRenderPass getRenderPass() const { return renderPass; }
+  bool usesDynamicRendering() const { return dynamicRendering; }
   VkImageView getImageView(int index) const { return swapChainImageViews[index]; }
+  VkImage getImage(int index) const { return swapChainImages[index]; }
+  VkFormat getDepthFormat() const { return depthFormat; }
+  // True when the images were created with all of `usage`.
+  bool hasImageUsage(VkImageUsageFlags usage) const { return (imageUsage & usage) == usage; }
   size_t imageCount() const { return swapChainImages.size(); }
+  // How many acquired images may still be waiting for their present when the next one is
+  // acquired without risking an endless wait.
+  uint32_t acquireAhead() const {
+    return static_cast<uint32_t>(swapChainImages.size()) - minImageCount;
+  }
   VkFormat getSwapChainImageFormat() const { return swapChainImageFormat; }
   VkExtent2D getSwapChainExtent() const { return swapChainExtent; }
   uint32_t width() const { return swapChainExtent.width; }
   uint32_t height() const { return swapChainExtent.height; }
 
+  size_t currentFrameIndex() const { return currentFrame; }
+
   float extentAspectRatio() const {
     return static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height);
   }
   VkFormat findDepthFormat() const;
 
+  // May run while another thread presents a previous frame.
   VkResult acquireNextImage(uint32_t *imageIndex) const;
   VkResult submitCommandBuffers(const VkCommandBuffer *buffers, const uint32_t *imageIndex);
 
+  // submitCommandBuffers in two halves. prepareSubmit waits for the image, resets the frame fence
+  // and advances to the next frame slot; it runs on the thread that acquires. submitAndPresent
+  // may run on another thread, but submissions must keep their order and each one must have been
+  // submitted before its frame slot comes around again in acquireNextImage.
+  FrameSubmission prepareSubmit(VkCommandBuffer buffer, uint32_t imageIndex);
+  VkResult submitAndPresent(const FrameSubmission &frame);
+
  private:
   void init();
   void createSwapChain();
@@ -59,10 +109,14 @@ class SwapChain {
   VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities) const;
 
   VkFormat swapChainImageFormat;
+  VkFormat depthFormat = VK_FORMAT_UNDEFINED;
   VkExtent2D swapChainExtent;
+  bool dynamicRendering = false;
+  VkImageUsageFlags requestedUsage = 0;
+  VkImageUsageFlags imageUsage = 0;
 
   std::vector<VkFramebuffer> swapChainFramebuffers;
-  VkRenderPass renderPass;
+  VkRenderPass renderPass = VK_NULL_HANDLE;
 
   std::vector<VkImage> depthImages;
   std::vector<VkDeviceMemory> depthImageMemorys;
@@ -75,6 +129,9 @@ class SwapChain {
 
   VkSwapchainKHR swapChain;
   std::shared_ptr<SwapChain> oldSwapChain;
+  uint32_t minImageCount = 1;
+  // vkAcquireNextImageKHR and vkQueuePresentKHR both need exclusive access to the swap chain.
+  mutable std::mutex hostAccess;
 
   std::vector<VkSemaphore> imageAvailableSemaphores;
   std::vector<VkSemaphore> renderFinishedSemaphores;
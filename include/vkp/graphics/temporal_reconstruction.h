@@ -0,0 +1,121 @@
+#pragma once
+
+#include "device.h"
+#include "pipeline.h"
+#include "render_graph.h"
+#include "renderer_conf.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    // Renders the scene at a fraction of the pixel rate and reconstructs full-resolution frames
+    // from a history buffer. Each frame shades a sparse pattern whose phase rotates, and a resolve
+    // pass fills the missing pixels from history clamped to the fresh neighbours. The first frame,
+    // and any frame after a time jump, shades everything instead. Owns two frame graphs (sparse
+    // and refresh) per frame slot, each ending in a composite pass that writes the swap chain image
+    // and hosts the overlay. Per-slot graphs give every frame in flight its own transient images.
+    class TemporalReconstruction {
+    public:
+        static constexpr VkFormat HISTORY_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+        // Larger steps in scene time than this are treated as a cut and refresh the history.
+        static constexpr float MAX_TIME_STEP = 0.25f;
+
+        // Records the scene into a `viewport`-sized target as if it were `resolution` sized,
+        // with `pipeline` and the given pattern word in the scene push constants.
+        using SceneFn   = std::function<void(VkCommandBuffer cmd, VkExtent2D viewport, VkExtent2D resolution,
+                                             uint32_t sparse, const Pipeline& pipeline)>;
+        // Draws on top of the composited frame, e.g. the ImGui overlay.
+        using OverlayFn = std::function<void(VkCommandBuffer cmd, VkExtent2D extent)>;
+
+        // `sceneLayout` is the scene pipeline layout; the output and depth formats are the swap
+        // chain's, so overlay pipelines built for it work in the composite pass. When rebuilding,
+        // `previous` is the instance being replaced: if a shader no longer compiles, its shaders
+        // are kept.
+        TemporalReconstruction(Device& device, TemporalMode mode, VkExtent2D extent, uint32_t frameSlots,
+                               VkFormat outputFormat, VkFormat depthFormat, VkPipelineLayout sceneLayout,
+                               SceneFn scene, OverlayFn overlay, const TemporalReconstruction* previous = nullptr);
+        ~TemporalReconstruction();
+
+        TemporalReconstruction(const TemporalReconstruction&) = delete;
+        TemporalReconstruction& operator=(const TemporalReconstruction&) = delete;
+
+        // Renders one frame into `output`, left in PRESENT_SRC_KHR, with the graphs of `frameSlot`.
+        void execute(VkCommandBuffer cmd, uint32_t frameSlot, VkImage output, VkImageView outputView, float time);
+        // Shades the next frame at full rate, e.g. after a camera cut.
+        void invalidate() { historyValid_ = false; }
+
+        [[nodiscard]] VkExtent2D sparseExtent() const { return sparseExtent_; }
+        [[nodiscard]] uint64_t   refreshes()    const { return refreshes_; }
+        [[nodiscard]] const RenderGraph& sparseGraph() const { return *sparse_.front().graph; }
+
+    private:
+        struct History {
+            VkImage        image  = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkImageView    view   = VK_NULL_HANDLE;
+        };
+        struct Graph {
+            std::unique_ptr<RenderGraph> graph;
+            ResourceId                   output{};
+            ResourceId                   next{};
+            ResourceId                   prev{};
+            ResourceId                   current{};
+        };
+
+        void createHistory(History& history) const;
+        void createDescriptors();
+        void createPipelines(VkFormat outputFormat, VkFormat depthFormat, VkPipelineLayout sceneLayout,
+                             const TemporalReconstruction* previous);
+        void buildSparseGraph(Graph& g, uint32_t slot, VkFormat outputFormat, VkFormat depthFormat);
+        void buildRefreshGraph(Graph& g, VkFormat outputFormat, VkFormat depthFormat);
+        void addCompositePass(Graph& graph, ResourceId depth) const;
+        void writeDescriptors();
+        void setViewport(VkCommandBuffer cmd, VkExtent2D extent) const;
+        [[nodiscard]] uint32_t patternWord() const;
+
+        Device&                    device_;
+        TemporalMode               mode_;
+        VkExtent2D                 extent_;
+        VkExtent2D                 sparseExtent_;
+        SceneFn                    scene_;
+        OverlayFn                  overlay_;
+
+        std::array<History, 2>     history_{};
+        VkSampler                  sampler_              = VK_NULL_HANDLE;
+        VkDescriptorSetLayout      resolveSetLayout_     = VK_NULL_HANDLE;
+        VkDescriptorSetLayout      compositeSetLayout_   = VK_NULL_HANDLE;
+        VkPipelineLayout           resolveLayout_        = VK_NULL_HANDLE;
+        VkPipelineLayout           compositeLayout_      = VK_NULL_HANDLE;
+        VkDescriptorPool           descriptorPool_       = VK_NULL_HANDLE;
+        // Indexed by the history image written this frame; resolve sets also by frame slot, as
+        // each slot's sparse graph has its own current image.
+        std::vector<std::array<VkDescriptorSet, 2>> resolveSets_;
+        std::array<VkDescriptorSet, 2> compositeSets_{};
+        std::unique_ptr<Pipeline>  shadePipeline_;
+        std::unique_ptr<Pipeline>  resolvePipeline_;
+        std::unique_ptr<Pipeline>  compositePipeline_;
+        // The SPIR-V of the pipelines above, for the next rebuild to fall back on.
+        std::vector<std::vector<uint32_t>> spirv_;
+
+        // One of each per frame slot.
+        std::vector<Graph>         sparse_;
+        std::vector<Graph>         refresh_;
+
+        // Per-frame state read by the pass callbacks.
+        uint32_t                   parity_       = 0;
+        uint32_t                   phase_        = 0;
+        uint32_t                   sparseWord_   = 0;
+        bool                       historyValid_ = false;
+        float                      lastTime_     = 0.f;
+        uint64_t                   refreshes_    = 0;
+    };
+
+} // namespace vkp::graphics
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <vkp/core/job_system.h>
+#include <vkp/core/mapped_file.h>
+
+#include "deletion_queue.h"
+#include "device.h"
+#include "ktx2.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkp::graphics {
+
+    using TextureId = uint32_t;
+
+    struct TextureStats {
+        size_t       textures      = 0;
+        size_t       usable        = 0;
+        VkDeviceSize residentBytes = 0;
+        VkDeviceSize budgetBytes   = 0;
+        uint64_t     uploadedBytes = 0;
+        uint64_t     evictions     = 0;
+    };
+
+    // Streams KTX2 textures into device memory. Files are mapped and parsed on a job, and mip
+    // levels are copied from the mapping into staging buffers on jobs too. The render thread only
+    // records the uploads into its frame's command buffer, so the submit thread stays the sole
+    // user of the graphics queue. Levels arrive coarse to fine: first the mip tail, then one
+    // finer level at a time. Each step replaces the image with one that holds one more level.
+    // The resident levels are copied over on the GPU. Files without mips get them generated
+    // with blits. Over the residency budget, the finest level of the least recently used
+    // texture is evicted the same way.
+    class TextureStreamer {
+    public:
+        // Levels no larger than this on either side are uploaded together, first.
+        static constexpr uint32_t     TAIL_SIZE              = 128;
+        static constexpr VkDeviceSize DEFAULT_BUDGET         = VkDeviceSize{ 256 } << 20;
+        // Staged bytes not yet recorded, and bytes recorded per frame.
+        static constexpr VkDeviceSize MAX_STAGING_BYTES      = VkDeviceSize{ 64 } << 20;
+        static constexpr VkDeviceSize UPLOAD_BYTES_PER_FRAME = VkDeviceSize{ 16 } << 20;
+
+        explicit TextureStreamer(Device& device, VkDeviceSize budget = DEFAULT_BUDGET);
+        // Waits for outstanding jobs. The device must be idle.
+        ~TextureStreamer();
+
+        TextureStreamer(const TextureStreamer&) = delete;
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+        // Render thread. Starts loading `path` in the background; the id is valid right away.
+        TextureId load(std::filesystem::path path);
+        // Render thread, after update(): the frame being recorded samples the texture. Only bound
+        // textures should be touched; the least recently touched ones are evicted first.
+        void touch(TextureId id);
+        // Render thread: runs `destroy` once the frame being recorded has completed, for objects
+        // such as descriptor sets that refer to a view() which is about to change.
+        void retire(std::function<void()> destroy);
+
+        // True once the mip tail is resident.
+        [[nodiscard]] bool usable(TextureId id) const { return textures_[id].view != VK_NULL_HANDLE; }
+        // Covers the resident levels. Changes whenever a level streams in or is evicted, so fetch
+        // it every frame; the previous view stays valid until the frames using it completed.
+        [[nodiscard]] VkImageView view(TextureId id) const { return textures_[id].view; }
+        // Trilinear and anisotropic; the view's level range clamps it to what is resident.
+        [[nodiscard]] VkSampler sampler() const { return sampler_; }
+        // Resident base level size, and the full size.
+        [[nodiscard]] VkExtent2D residentExtent(TextureId id) const;
+        [[nodiscard]] VkExtent2D extent(TextureId id) const;
+        [[nodiscard]] const std::string& name(TextureId id) const { return textures_[id].name; }
+        [[nodiscard]] size_t count() const { return textures_.size(); }
+
+        // Render thread, once per frame and outside any rendering scope. `frameNumber` is the
+        // frame being recorded into `cmd`; `completedFrames` frames have finished on the GPU.
+        void update(VkCommandBuffer cmd, uint64_t frameNumber, uint64_t completedFrames);
+
+        [[nodiscard]] TextureStats stats() const;
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        enum class State { Loading, Ready, Failed };
+
+        struct Texture {
+            std::filesystem::path                   path;
+            std::string                             name;
+            State                                   state = State::Loading;
+            std::shared_ptr<const core::MappedFile> file;
+            Ktx2Image                               header;
+            uint32_t                                mipCount  = 0;   // including generated levels
+            uint32_t                                tailMip   = 0;   // first level of the tail
+            VkDeviceSize                            alignment = 16;  // of level offsets in staging
+            VkImage                                 image     = VK_NULL_HANDLE;
+            VkDeviceMemory                          memory    = VK_NULL_HANDLE;
+            VkImageView                             view      = VK_NULL_HANDLE;
+            VkDeviceSize                            bytes     = 0;
+            uint32_t                                residentMip = NONE;   // finest resident level
+            uint32_t                                stagingMip  = NONE;   // level being staged
+            uint64_t                                lastUsed    = 0;
+        };
+
+        // A finished load job.
+        struct Loaded {
+            TextureId                               id;
+            std::shared_ptr<const core::MappedFile> file;
+            Ktx2Image                               header;
+            bool                                    failed;
+        };
+
+        // Levels copied from the file into a staging buffer, waiting to be recorded.
+        struct Staged {
+            struct Region {
+                uint32_t     level;
+                VkDeviceSize offset;
+            };
+            TextureId           id;
+            uint32_t            firstMip;
+            VkBuffer            buffer;
+            VkDeviceMemory      memory;
+            VkDeviceSize        size;
+            std::vector<Region> regions;
+            bool                failed;
+        };
+
+        void finishLoad(Loaded& loaded);
+        // The level the next streaming step makes resident, or NONE.
+        [[nodiscard]] uint32_t nextMip(const Texture& texture) const;
+        // Estimated size of levels [first, mipCount).
+        [[nodiscard]] VkDeviceSize estimateBytes(const Texture& texture, uint32_t firstMip) const;
+        void stage(TextureId id, uint32_t firstMip);
+        // Evicts finest levels of textures last used before `usedBefore` until `bytes` more fit
+        // the budget; false if they don't.
+        bool evictFor(VkCommandBuffer cmd, VkDeviceSize bytes, uint64_t usedBefore, uint64_t frameNumber);
+        // Replaces the texture's image with one holding levels [firstMip, mipCount): resident levels
+        // are copied, `staged` levels uploaded and missing ones generated.
+        void rebuild(VkCommandBuffer cmd, Texture& texture, uint32_t firstMip, const Staged* staged,
+                     uint64_t frameNumber);
+
+        Device&                  device_;
+        VkDeviceSize             budget_;
+        VkSampler                sampler_ = VK_NULL_HANDLE;
+        std::deque<Texture>      textures_;
+        DeletionQueue            retired_;
+        VkDeviceSize             residentBytes_ = 0;
+        VkDeviceSize             stagingBytes_  = 0;
+        uint64_t                 uploadedBytes_ = 0;
+        uint64_t                 evictions_     = 0;
+        uint64_t                 frameNumber_   = 0;   // passed to the last update()
+        // Staged uploads beyond this frame's UPLOAD_BYTES_PER_FRAME.
+        std::deque<Staged>       ready_;
+
+        // Filled by jobs, drained by update().
+        std::mutex               mutex_;
+        std::vector<Loaded>      loaded_;
+        std::vector<Staged>      staged_;
+        core::JobCounter         jobs_;
+    };
+
+} // namespace vkp::graphics
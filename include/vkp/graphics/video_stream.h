@@ -0,0 +1,100 @@
+#pragma once
+
+#include "device.h"
+#include "renderer_conf.h"
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vkp::graphics {
+
+    struct VideoStreamSettings {
+        std::string path;  // "-" writes to stdout
+        VideoFormat format = VideoFormat::Y4M;
+        uint32_t    fps    = 60;
+    };
+
+    // Streams rendered frames as 8-bit BT.709 YUV 4:2:0. A compute pass converts the final
+    // image on the GPU into a host-visible buffer (one per frame in flight), so only 1.5
+    // bytes per pixel are read back and the CPU just strips padding and writes.
+    // The output size is fixed at construction; differently sized sources are rescaled.
+    class VideoStream {
+    public:
+        VideoStream(Device& device, uint32_t framesInFlight, VideoStreamSettings settings, VkExtent2D size);
+        ~VideoStream();
+
+        VideoStream(const VideoStream&) = delete;
+        VideoStream& operator=(const VideoStream&) = delete;
+
+        // Sampled source formats the conversion understands.
+        [[nodiscard]] static bool supportsFormat(VkFormat format);
+
+        // Call once the fence of `frameIndex` was waited: hands that slot's frame to the writer.
+        // Blocks if the writer is MAX_QUEUED_FRAMES behind, since a video can't drop frames.
+        void collect(uint32_t frameIndex);
+
+        // Records the conversion of `image` (viewed by `view`), which must be in `layout` and is
+        // returned to it afterwards. Needs SAMPLED usage on the image.
+        void record(VkCommandBuffer cmd, uint32_t frameIndex, VkImage image, VkImageView view,
+                    VkImageLayout layout, VkFormat format, VkExtent2D extent, uint64_t frameNumber);
+
+        // Collects every slot in frame order and waits for the writer. The GPU must be idle.
+        void flush();
+
+    private:
+        struct Slot {
+            VkBuffer        buffer  = VK_NULL_HANDLE;
+            VkDeviceMemory  memory  = VK_NULL_HANDLE;
+            void*           mapped  = nullptr;
+            VkDescriptorSet set     = VK_NULL_HANDLE;
+            bool            pending = false;
+            uint64_t        frameNumber = 0;
+        };
+
+        void createPipeline();
+        void createSlots(uint32_t count);
+        void writeHeader();
+        void writeFrame(const std::vector<uint8_t>& frame);
+        void writerLoop();
+
+        Device&               device_;
+        VideoStreamSettings   settings_;
+        VkExtent2D            size_;
+        uint32_t              stride_;       // padded luma row in bytes, multiple of 8
+        uint32_t              paddedHeight_; // even
+        VkDeviceSize          frameBytes_;
+        bool                  coherent_ = false;
+        std::vector<Slot>     slots_;
+
+        VkSampler             sampler_        = VK_NULL_HANDLE;
+        VkDescriptorSetLayout setLayout_      = VK_NULL_HANDLE;
+        VkDescriptorPool      descriptorPool_ = VK_NULL_HANDLE;
+        VkPipelineLayout      pipelineLayout_ = VK_NULL_HANDLE;
+        VkPipeline            pipeline_       = VK_NULL_HANDLE;
+
+        std::FILE*            file_     = nullptr;
+        bool                  ownsFile_ = false;
+        bool                  failed_   = false;
+        uint64_t              framesWritten_ = 0;
+
+        static constexpr size_t MAX_QUEUED_FRAMES = 8;
+        std::thread             writer_;
+        std::mutex              mutex_;
+        std::condition_variable frameAvailable_;
+        std::condition_variable spaceAvailable_;
+        std::condition_variable idle_;
+        std::deque<std::vector<uint8_t>>  frames_;
+        std::vector<std::vector<uint8_t>> freeBuffers_;
+        bool                    busy_     = false;
+        bool                    stopping_ = false;
+    };
+
+} // namespace vkp::graphics
@@ -2,43 +2,94 @@
 
 #include "window.h"
 
+#include <vkp/core/frame_stats.h>
 #include <vkp/graphics/device.h>
-#include <vkp/graphics/swap_chain.h>
+#include <vkp/graphics/gpu_profiler.h>
+#include <vkp/graphics/texture_streamer.h>
 
 #include <imgui.h>
-#include <imgui_impl_glfw.h>
 #include <imgui_impl_vulkan.h>
 
 #include <vulkan/vulkan.h>
 
+#include <vector>
+
 namespace vkp {
 
     class ImGuiLayer {
     public:
+        // `renderPass` only has to be compatible with the ones rendered into later; the layer keeps
+        // no reference to the swap chain, which is replaced on resize. With a null `renderPass` the
+        // backend is set up for dynamic rendering into attachments of the given formats.
         ImGuiLayer(Window& window,
                    vkp::graphics::Device& device,
-                   vkp::graphics::SwapChain& swapChain,
+                   uint32_t imageCount,
                    VkRenderPass renderPass,
-                   uint32_t subpass = 0);
+                   uint32_t subpass = 0,
+                   VkFormat colorFormat = VK_FORMAT_UNDEFINED,
+                   VkFormat depthFormat = VK_FORMAT_UNDEFINED);
         ~ImGuiLayer();
 
+        // Creates the ImGui context and bakes the font atlas. Touches no Vulkan or GLFW
+        // state, so it can run on a worker thread before the swap chain exists.
+        static void PrepareContext();
+
+        // Adds the frame-time graph and percentiles to the Stats overlay.
+        void SetFrameStats(const core::FrameStatsRing* ring, float budgetMs);
+        // Adds device memory usage against budget to the Stats overlay.
+        void SetMemoryReport(const vkp::graphics::MemoryReport* report);
+        // Adds validation message counts to the Stats overlay, and a Validation window with the
+        // message filter and the most frequent performance warnings.
+        void SetDebugMessages(vkp::graphics::DebugMessageCollector* messages);
+        // Adds shader invocation counts per draw scope to the Stats overlay, with fragment
+        // invocations per target pixel as an overdraw measure.
+        void SetPipelineStatistics(const std::vector<vkp::graphics::GpuProfiler::StatisticsResult>* statistics);
+        // Adds streamed texture residency against its budget to the Stats overlay, and a Textures
+        // window that previews one texture. Only the previewed texture is touched.
+        void SetTextureStreamer(vkp::graphics::TextureStreamer* streamer);
+
         void OnAttach();
         void OnDetach() const;
-        void OnRender(VkCommandBuffer cmd);
+        // Input forwarded by the main thread. ImGui's GLFW backend is not used: it would call GLFW
+        // from the render thread.
+        void OnInput(const WindowEvent& event);
+        void OnRender(VkCommandBuffer cmd, VkExtent2D extent);
 
     private:
-        const float           StatsPos_x = 150.f;
+        static constexpr int    GraphSamples   = 240;
+        static constexpr size_t MaxTextureRows = 8;
+        static constexpr double StatsWindowSec = 5.0;
+        const float           StatsPos_x = 260.f;
         const float           StatsPos_y = 20.f;
         Window&               window_;
         vkp::graphics::Device&     device_;
-        vkp::graphics::SwapChain&  swapChain_;
+        uint32_t              imageCount_;
         VkRenderPass          renderPass_;
         uint32_t              subpass_;
+        VkFormat              colorFormat_;
+        VkFormat              depthFormat_;
         VkDescriptorPool      descriptorPool_;
+        double   last_frame_time_          = 0.0;
         double   stats_last_update_time_   = 0.0;
         float    stats_fps_                = 0.0f;
         float    stats_frame_time_ms_      = 0.0f;
         float    stats_update_interval_    = 0.25f;
+        const core::FrameStatsRing* frame_stats_ = nullptr;
+        float                       budget_ms_   = 1000.f / 60.f;
+        core::FrameStatsSummary     summary_{};
+        std::vector<float>          graph_;
+        const vkp::graphics::MemoryReport* memory_report_ = nullptr;
+        vkp::graphics::DebugMessageCollector* debug_messages_ = nullptr;
+        std::vector<vkp::graphics::PerformanceWarning> performance_warnings_;
+        const std::vector<vkp::graphics::GpuProfiler::StatisticsResult>* pipeline_statistics_ = nullptr;
+        vkp::graphics::TextureStreamer* texture_streamer_ = nullptr;
+        vkp::graphics::TextureId preview_texture_ = 0;
+        // Descriptor set of preview_view_, recreated when the texture's view changes.
+        VkImageView     preview_view_ = VK_NULL_HANDLE;
+        VkDescriptorSet preview_set_  = VK_NULL_HANDLE;
+
+        void RenderValidationWindow();
+        void RenderTexturesWindow();
     };
 
 } // namespace vkp
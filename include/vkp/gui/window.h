@@ -2,11 +2,43 @@
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+
+#include <vkp/core/spsc_queue.h>
+
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 namespace vkp {
+
+    // What the main thread forwards from GLFW to the render thread.
+    struct WindowEvent {
+        enum class Type : uint8_t {
+            Resize,        // width, height: new framebuffer size
+            Close,
+            CursorPos,     // x, y in framebuffer pixels
+            MouseButton,   // button, down
+            Scroll,        // x, y offsets
+            Focus,         // down: focused
+        };
+
+        Type   type   = Type::Resize;
+        int    width  = 0;
+        int    height = 0;
+        double x      = 0.0;
+        double y      = 0.0;
+        int    button = 0;
+        bool   down   = false;
+    };
+
+    // GLFW calls are only made on the main thread, which owns the window. GLFW callbacks run there
+    // while it pumps events and are forwarded through a lock-free single-producer, single-consumer
+    // queue to the render thread. The framebuffer size and the resize flag are atomics as well, so
+    // a resize is never lost even if the queue was full.
     class Window {
     public:
+        static constexpr size_t EVENT_QUEUE_SIZE = 256;
+
         Window(int width, int height, const std::string& title, int pos_x, int pos_y);
         ~Window();
 
@@ -14,22 +46,37 @@ namespace vkp {
         Window& operator=(const Window&) = delete;
 
         [[nodiscard]] GLFWwindow* handle() const { return window; }
+        // Main thread only.
         [[nodiscard]] bool shouldClose() const;
-        [[nodiscard]] VkExtent2D getExtent() const { return {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}; }
+        // Any thread: the latest framebuffer size.
+        [[nodiscard]] VkExtent2D getExtent() const;
 
+        // Main thread only.
         void pollEvents() const;
-        void createSurface(VkInstance instance, VkSurfaceKHR* surface) const;
-        bool wasWindowResized() const { return framebufferResized; }
-        void resetWindowResizedFlag() { framebufferResized = false; }
+        void createSurface(VkInstance instance, VkSurfaceKHR* surface, const VkAllocationCallbacks* allocator = nullptr) const;
+        // Main thread only: queues an event for the render thread; false if the queue is full.
+        bool postEvent(const WindowEvent& event);
+
+        // Render thread only.
+        bool pollEvent(WindowEvent& event) { return events.tryPop(event); }
+        // Any thread: whether the framebuffer was resized since the last call.
+        bool consumeResize() { return framebufferResized.exchange(false, std::memory_order_acq_rel); }
+        [[nodiscard]] uint64_t droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
 
     private:
         static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
+        static void cursorPosCallback(GLFWwindow* window, double x, double y);
+        static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+        static void scrollCallback(GLFWwindow* window, double x, double y);
+        static void focusCallback(GLFWwindow* window, int focused);
         void init() const;
 
-        int width;
-        int height;
+        // Framebuffer width in the high and height in the low 32 bits, so both change together.
+        std::atomic<uint64_t> extent;
         std::string title;
         GLFWwindow* window;
-        bool framebufferResized = false;
+        std::atomic<bool> framebufferResized{ false };
+        core::SpscQueue<WindowEvent, EVENT_QUEUE_SIZE> events;
+        std::atomic<uint64_t> dropped{ 0 };
     };
-}
\ No newline at end of file
+}
@@ -66,7 +66,7 @@ public:
                << " [" << module << " " << file_name << ":" << line << "] "; {
             std::string full_message = fmt::format("{}{}", header.str(), message);
             std::lock_guard<std::mutex> lock(io_mutex_);
-            std::cout << full_message << '\n';
+            (console_to_stderr_ ? std::cerr : std::cout) << full_message << '\n';
         }
 
 #ifndef _DEBUG
@@ -80,7 +80,14 @@ public:
 #endif
     }
 
+    // Sends console output to stderr, e.g. while stdout carries a video stream.
+    static void set_console_to_stderr(bool enabled) {
+        std::lock_guard<std::mutex> lock(io_mutex_);
+        console_to_stderr_ = enabled;
+    }
+
 private:
+    inline static bool console_to_stderr_ = false;
     inline static std::mutex io_mutex_;
     inline static std::mutex json_mutex_;
 };
@@ -2,11 +2,12 @@
 set GLSLC=glslc
 set SHADER_DIR=shaders
 
-echo Compiling all .vert and .frag shaders in %SHADER_DIR%...
+rem The renderer compiles the sources itself; this only checks them, so nothing is written.
+echo Checking that all .vert, .frag and .comp shaders in %SHADER_DIR% compile...
 
 for %%F in (%SHADER_DIR%\*.vert) do (
     echo Compiling %%~nxF...
-    %GLSLC% "%%F" -o "%%F.spv"
+    %GLSLC% "%%F" -o NUL
     if %errorlevel% neq 0 (
         echo Failed to compile vertex shader %%~nxF
         exit /b %errorlevel%
@@ -15,11 +16,20 @@ for %%F in (%SHADER_DIR%\*.vert) do (
 
 for %%F in (%SHADER_DIR%\*.frag) do (
     echo Compiling %%~nxF...
-    %GLSLC% "%%F" -o "%%F.spv"
+    %GLSLC% "%%F" -o NUL
     if %errorlevel% neq 0 (
         echo Failed to compile fragment shader %%~nxF
         exit /b %errorlevel%
     )
 )
 
-echo Shader compilation successful.
+for %%F in (%SHADER_DIR%\*.comp) do (
+    echo Compiling %%~nxF...
+    %GLSLC% "%%F" -o NUL
+    if %errorlevel% neq 0 (
+        echo Failed to compile compute shader %%~nxF
+        exit /b %errorlevel%
+    )
+)
+
+echo All shaders compile.
@@ -0,0 +1,7 @@
+#version 450
+
+// Full-screen triangle for post passes; no vertex buffer or push constants.
+void main() {
+    vec2 pos = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
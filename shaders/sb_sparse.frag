@@ -0,0 +1,28 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Temporal mode: shades one pixel of each 2x1 (checkerboard) or 2x2 (quarter) block into a
+// sparse target. pc.sparse holds the pattern in the low nibble and the phase above it; the
+// phase moves the shaded pixel every frame so the history sees every pixel over 2 or 4 frames.
+#include "scene.glsl"
+
+#define PATTERN_CHECKERBOARD 1u
+#define PATTERN_QUARTER      2u
+
+layout(location = 0) out vec4 outColor;
+
+vec2 fullResCoord(ivec2 p) {
+    uint pattern = pc.sparse & 0xFu;
+    int  phase   = int(pc.sparse >> 4);
+    if (pattern == PATTERN_CHECKERBOARD) {
+        return vec2(2 * p.x + ((p.y + phase) & 1), p.y) + 0.5;
+    }
+    if (pattern == PATTERN_QUARTER) {
+        return vec2(2 * p + ivec2(phase & 1, phase >> 1)) + 0.5;
+    }
+    return vec2(p) + 0.5;
+}
+
+void main() {
+    mainImage(outColor, fullResCoord(ivec2(gl_FragCoord.xy)));
+}
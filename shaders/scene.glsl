@@ -0,0 +1,122 @@
+// Raymarched scene shared by sb_shader.frag and sb_sparse.frag. With SCENE_BAKED_SDF defined
+// (the renderer compiles that permutation of sb_shader.frag), distances and normals come from
+// the volume baked by sdf_bake.comp.
+
+layout(push_constant) uniform PushConstants {
+    vec2 resolution;
+    float time;
+    uint sparse;   // temporal pattern and phase, see sb_sparse.frag; 0 shades every pixel
+} pc;
+
+#define MAXITERS 300.0
+#define LENFACTOR 0.25
+#define NDELTA 0.001
+
+#define NDELTAX vec3(NDELTA,0,0)
+#define NDELTAY vec3(0,NDELTA,0)
+#define NDELTAZ vec3(0,0,NDELTA)
+
+#include "sdf.glsl"
+
+// lighting dirs/colors
+const vec3 rDir = normalize(vec3(-3.0,  4.0, -2.0)), rCol = vec3(1.0, 0.6, 0.4);
+const vec3 gDir = normalize(vec3( 4.0, -3.0,  0.0)), gCol = vec3(0.7, 1.0, 0.8);
+const vec3 bDir = normalize(vec3( 2.0,  3.0, -4.0)), bCol = vec3(0.3, 0.7, 1.0);
+
+mat2 rot2(float t) {
+    float s = sin(t), c = cos(t);
+    return mat2(c, s, -s, c);
+}
+
+#ifdef SCENE_BAKED_SDF
+layout(set = 0, binding = 0) uniform sampler3D sdfVolume;
+
+vec3 volumeCoord(vec3 p) {
+    return p / (2.0 * SDF_VOLUME_HALF_EXTENT) + 0.5;
+}
+
+bool insideVolume(vec3 uvw) {
+    return all(greaterThanEqual(uvw, vec3(0.0))) && all(lessThanEqual(uvw, vec3(1.0)));
+}
+
+// Trilinear lookup inside the volume. Outside it the warp is inactive and the plain boxes are cheap.
+float sceneDistance(vec3 p) {
+    vec3 uvw = volumeCoord(p);
+    return insideVolume(uvw) ? texture(sdfVolume, uvw).r : sceneBoxes(p);
+}
+
+// Central differences one texel apart; the texture's gradient is the field's.
+vec3 sceneNormal(vec3 p) {
+    vec3 uvw = volumeCoord(p);
+    if (!insideVolume(uvw)) {
+        return normalize(vec3(
+        sceneBoxes(p + NDELTAX) - sceneBoxes(p - NDELTAX),
+        sceneBoxes(p + NDELTAY) - sceneBoxes(p - NDELTAY),
+        sceneBoxes(p + NDELTAZ) - sceneBoxes(p - NDELTAZ)
+        ));
+    }
+    vec3 h = 1.0 / vec3(textureSize(sdfVolume, 0));
+    return normalize(vec3(
+    texture(sdfVolume, uvw + vec3(h.x, 0, 0)).r - texture(sdfVolume, uvw - vec3(h.x, 0, 0)).r,
+    texture(sdfVolume, uvw + vec3(0, h.y, 0)).r - texture(sdfVolume, uvw - vec3(0, h.y, 0)).r,
+    texture(sdfVolume, uvw + vec3(0, 0, h.z)).r - texture(sdfVolume, uvw - vec3(0, 0, h.z)).r
+    ));
+}
+#else
+float sceneDistance(vec3 p) {
+    return sceneSDF(p);
+}
+
+vec3 sceneNormal(vec3 p) {
+    return normalize(vec3(
+    sceneSDF(p + NDELTAX) - sceneSDF(p - NDELTAX),
+    sceneSDF(p + NDELTAY) - sceneSDF(p - NDELTAY),
+    sceneSDF(p + NDELTAZ) - sceneSDF(p - NDELTAZ)
+    ));
+}
+#endif
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    // --- ray setup ---
+    vec2 uv = (fragCoord - 0.5 * pc.resolution) / pc.resolution.y;
+    vec3 ray = normalize(vec3(uv, 1.0));
+    ray.yz *= rot2(-0.12);
+    ray.xz *= rot2(-0.78539816);
+    vec3 cam = vec3(10.0, 2.0, -10.0);
+
+    // --- raymarch ---
+    vec3 pos = cam;
+    float t = 0.0;
+    for (; t < MAXITERS; ++t) {
+        float dist = sceneDistance(pos);
+        if (dist < NDELTA) break;
+        pos += ray * dist * LENFACTOR;
+    }
+
+    // --- shading ---
+    if (t >= MAXITERS) {
+        fragColor = vec4(0.0); // miss = black
+        return;
+    }
+
+    vec3 n = sceneNormal(pos);
+    float fade = 1.0 - pow(t / MAXITERS, 2.0);
+
+    // per‐face base colour (COLOURS)
+    vec3 baseCol;
+    vec3 p2 = rotSpace(pos);
+    if (abs(p2.x) > 1.001)      baseCol = vec3(0.6, 0.0, 0.8);  // purple
+    else if (abs(p2.y) > 1.001) baseCol = vec3(0.8, 0.2, 0.4);  // crimson
+    else                         baseCol = vec3(0.4, 0.0, 0.6);  // dark violet
+
+    // lighting contribution
+    float lr = abs(dot(rDir, n));
+    float lg = pow(dot(gDir, n), 5.0);
+    float lb = abs(dot(bDir, n));
+    vec3 light = rCol * lr + gCol * lg + bCol * lb;
+
+    // slow pulsation
+    float pulse = 0.6 + 0.4 * sin(pc.time * 0.5);
+
+    fragColor = vec4(baseCol * light * fade * pulse, 1.0);
+}
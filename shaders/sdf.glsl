@@ -0,0 +1,44 @@
+// Scene distance function, shared by the fragment shaders and the SDF bake (sdf_bake.comp).
+// Reads pc.time, so the includer declares a push constant block `pc` with a float `time`.
+
+// The warp in rotSpace vanishes outside this radius, which also bounds the baked volume.
+#define SDF_VOLUME_HALF_EXTENT 10.0
+
+float box(vec3 p, vec3 c, vec3 d) {
+    vec3 diff = abs(p - c) - d;
+    return max(diff.x, max(diff.y, diff.z));
+}
+
+mat3 rotationMatrix(vec3 axis, float angle) {
+    float s = sin(angle), c = cos(angle), oc = 1.0 - c;
+    return mat3(
+    oc*axis.x*axis.x + c,        oc*axis.x*axis.y - axis.z*s, oc*axis.z*axis.x + axis.y*s,
+    oc*axis.x*axis.y + axis.z*s, oc*axis.y*axis.y + c,        oc*axis.y*axis.z - axis.x*s,
+    oc*axis.z*axis.x - axis.y*s, oc*axis.y*axis.z + axis.x*s, oc*axis.z*axis.z + c
+    );
+}
+
+const float pi = 3.1415926536;
+
+vec3 axisDir() {
+    return vec3(cos(pc.time * 0.3), 0.0, sin(pc.time * 0.3));
+}
+vec3 rotSpace(vec3 p) {
+    float ang = pi * pow(smoothstep(100.0,2.0,dot(p,p)),5.0);
+    return (ang>0.0) ? p * rotationMatrix(axisDir(), ang) : p;
+}
+
+// The boxes without the warp; equal to sceneSDF outside SDF_VOLUME_HALF_EXTENT.
+float sceneBoxes(vec3 p) {
+    float l = pc.time * 0.2 - 0.2;
+    l = max(0.0, min(pow(l,6.0),1000.0));
+    float d1 = box(p, vec3(0), vec3(0.7,0.1,l));
+    float d2 = box(p, vec3(0), vec3(0.1,l,0.7));
+    float d3 = box(p, vec3(0), vec3(l,0.7,0.1));
+    float d4 = box(p, vec3(0), vec3(1.0));
+    return min(min(d1,d2), min(d3,d4));
+}
+
+float sceneSDF(vec3 p) {
+    return sceneBoxes(rotSpace(p));
+}
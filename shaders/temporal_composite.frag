@@ -0,0 +1,10 @@
+#version 450
+
+// Copies the resolved frame into the swap chain image, converting from the history format.
+layout(set = 0, binding = 0) uniform sampler2D resolved;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texelFetch(resolved, ivec2(gl_FragCoord.xy), 0);
+}
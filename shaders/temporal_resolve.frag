@@ -0,0 +1,57 @@
+#version 450
+
+// Rebuilds the full-resolution frame from this frame's sparse samples (see sb_sparse.frag)
+// and the previous resolved frame. Shaded pixels are taken as is. The others reuse their
+// history, clamped to the range of the fresh samples around them so stale colours can't
+// ghost. The camera is fixed, so history is reprojected to the same pixel.
+layout(set = 0, binding = 0) uniform sampler2D current;
+layout(set = 0, binding = 1) uniform sampler2D history;
+
+layout(push_constant) uniform PushConstants {
+    uint sparse;   // same word the scene was shaded with
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+#define PATTERN_CHECKERBOARD 1u
+#define PATTERN_QUARTER      2u
+
+vec4 fetchSparse(ivec2 s) {
+    return texelFetch(current, clamp(s, ivec2(0), textureSize(current, 0) - 1), 0);
+}
+
+void main() {
+    ivec2 p       = ivec2(gl_FragCoord.xy);
+    uint  pattern = pc.sparse & 0xFu;
+    int   phase   = int(pc.sparse >> 4);
+
+    vec4 n[4];
+    if (pattern == PATTERN_CHECKERBOARD) {
+        // Shaded pixels have x matching the row parity; all four direct neighbours of a
+        // missing pixel were shaded.
+        if (((p.x + p.y + phase) & 1) == 0) {
+            outColor = fetchSparse(ivec2(p.x >> 1, p.y));
+            return;
+        }
+        n[0] = fetchSparse(ivec2((p.x - 1) >> 1, p.y));
+        n[1] = fetchSparse(ivec2((p.x + 1) >> 1, p.y));
+        n[2] = fetchSparse(ivec2(p.x >> 1, p.y - 1));
+        n[3] = fetchSparse(ivec2(p.x >> 1, p.y + 1));
+    } else {
+        // One shaded pixel per 2x2 block at `offset`; use the four surrounding ones.
+        ivec2 offset = ivec2(phase & 1, phase >> 1);
+        if (all(equal(p & 1, offset))) {
+            outColor = fetchSparse(p >> 1);
+            return;
+        }
+        ivec2 base = (p - offset) >> 1;
+        n[0] = fetchSparse(base);
+        n[1] = fetchSparse(base + ivec2(1, 0));
+        n[2] = fetchSparse(base + ivec2(0, 1));
+        n[3] = fetchSparse(base + ivec2(1, 1));
+    }
+
+    vec4 lo = min(min(n[0], n[1]), min(n[2], n[3]));
+    vec4 hi = max(max(n[0], n[1]), max(n[2], n[3]));
+    outColor = clamp(texelFetch(history, p, 0), lo, hi);
+}
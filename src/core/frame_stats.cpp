@@ -0,0 +1,107 @@
+#include <vkp/core/frame_stats.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vkp::core {
+
+    namespace {
+        // Expects `values` sorted ascending and non-empty.
+        float percentile(const std::vector<float>& values, const double q) {
+            const auto rank = static_cast<size_t>(std::ceil(q * static_cast<double>(values.size())));
+            return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+        }
+    }
+
+    FrameStatsRing::FrameStatsRing()
+        : slots_(std::make_unique<Slot[]>(CAPACITY))
+    {
+    }
+
+    void FrameStatsRing::push(const FrameSample& sample) {
+        const uint64_t i = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[i % CAPACITY];
+
+        slot.seq.store(2 * i + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.end_ns.store(sample.end_ns, std::memory_order_relaxed);
+        slot.frame_ms.store(sample.frame_ms, std::memory_order_relaxed);
+        slot.cpu_ms.store(sample.cpu_ms, std::memory_order_relaxed);
+        slot.gpu_ms.store(sample.gpu_ms, std::memory_order_relaxed);
+        slot.seq.store(2 * i + 2, std::memory_order_release);
+
+        head_.store(i + 1, std::memory_order_release);
+    }
+
+    bool FrameStatsRing::read(const uint64_t index, FrameSample& out) const {
+        const Slot& slot = slots_[index % CAPACITY];
+        const uint64_t expected = 2 * index + 2;
+        if (slot.seq.load(std::memory_order_acquire) != expected) return false;
+
+        out.end_ns   = slot.end_ns.load(std::memory_order_relaxed);
+        out.frame_ms = slot.frame_ms.load(std::memory_order_relaxed);
+        out.cpu_ms   = slot.cpu_ms.load(std::memory_order_relaxed);
+        out.gpu_ms   = slot.gpu_ms.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.seq.load(std::memory_order_relaxed) == expected;
+    }
+
+    std::vector<FrameSample> FrameStatsRing::latest(const size_t maxCount) const {
+        const uint64_t head  = total();
+        const uint64_t count = std::min<uint64_t>({ maxCount, head, CAPACITY });
+
+        std::vector<FrameSample> samples;
+        samples.reserve(count);
+        for (uint64_t i = head - count; i < head; ++i) {
+            if (FrameSample sample{}; read(i, sample)) samples.push_back(sample);
+        }
+        return samples;
+    }
+
+    std::vector<FrameSample> FrameStatsRing::since(const uint64_t since_ns) const {
+        const uint64_t head = total();
+        const uint64_t oldest = head > CAPACITY ? head - CAPACITY : 0;
+
+        // Walk back from the newest sample until one ended before `since_ns`.
+        std::vector<FrameSample> samples;
+        for (uint64_t i = head; i > oldest; --i) {
+            FrameSample sample{};
+            if (!read(i - 1, sample)) break;
+            if (sample.end_ns < since_ns) break;
+            samples.push_back(sample);
+        }
+        std::reverse(samples.begin(), samples.end());
+        return samples;
+    }
+
+    FrameStatsSummary summarize(const std::vector<FrameSample>& samples, const float budget_ms) {
+        FrameStatsSummary summary{};
+        if (samples.empty()) return summary;
+
+        std::vector<float> frame;
+        std::vector<float> gpu;
+        frame.reserve(samples.size());
+        gpu.reserve(samples.size());
+        for (const auto& sample : samples) {
+            frame.push_back(sample.frame_ms);
+            if (sample.gpu_ms > 0.f) gpu.push_back(sample.gpu_ms);
+            if (sample.frame_ms > budget_ms) ++summary.over_budget;
+        }
+
+        std::sort(frame.begin(), frame.end());
+        summary.count  = frame.size();
+        summary.p50_ms = percentile(frame, 0.50);
+        summary.p99_ms = percentile(frame, 0.99);
+        summary.max_ms = frame.back();
+
+        if (!gpu.empty()) {
+            std::sort(gpu.begin(), gpu.end());
+            summary.gpu_p50_ms = percentile(gpu, 0.50);
+            summary.gpu_p99_ms = percentile(gpu, 0.99);
+            summary.gpu_max_ms = gpu.back();
+        }
+        return summary;
+    }
+
+} // namespace vkp::core
@@ -0,0 +1,121 @@
+#include <vkp/core/hitch_detector.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace vkp::core {
+
+    namespace {
+        // Scopes shorter than this are left out to keep reports readable.
+        constexpr uint64_t MIN_REPORTED_NS   = 100'000;
+        constexpr size_t   MAX_REPORTED_CPU  = 32;
+
+        std::string describeEvents(const uint32_t events) {
+            std::string out;
+            auto add = [&](const uint32_t bit, const char* name) {
+                if ((events & bit) == 0) return;
+                if (!out.empty()) out += ", ";
+                out += name;
+            };
+            add(HitchDetector::SwapchainRecreate, "swapchain recreate");
+            add(HitchDetector::PipelineCreate,    "pipeline create");
+            add(HitchDetector::QueueWaitIdle,     "vkQueueWaitIdle");
+            add(HitchDetector::DeviceWaitIdle,    "vkDeviceWaitIdle");
+            return out.empty() ? "none" : out;
+        }
+
+        double ms(const uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+    }
+
+    HitchDetector& HitchDetector::get() {
+        static HitchDetector instance;
+        return instance;
+    }
+
+    void HitchDetector::configure(const float budgetMs, std::string reportPath) {
+        budgetMs_   = budgetMs;
+        reportPath_ = std::move(reportPath);
+    }
+
+    void HitchDetector::beginFrame(const uint64_t startNs) {
+        frameStartNs_ = startNs;
+        events_.store(0, std::memory_order_relaxed);
+    }
+
+    void HitchDetector::endFrame(const uint64_t frameNumber, const uint64_t endNs, const bool submitted) {
+        const uint32_t events = events_.exchange(0, std::memory_order_relaxed);
+        const auto frameMs = static_cast<float>(ms(endNs - frameStartNs_));
+        if (frameMs <= budgetMs_) return;
+
+        ++hitchCount_;
+        Hitch hitch{ frameNumber, frameStartNs_, frameMs, events, {}, {} };
+        // Empty unless the scopes are compiled in (REND_PROFILE).
+        for (const auto& event : Profiler::get().threadEventsSince(frameStartNs_)) {
+            if (event.end_ns - event.start_ns >= MIN_REPORTED_NS && hitch.cpu.size() < MAX_REPORTED_CPU) {
+                hitch.cpu.push_back(event);
+            }
+        }
+
+        LOG_WARN("hitch in frame {}: {:.1f} ms (budget {:.1f} ms), events: {}",
+                 frameNumber, frameMs, budgetMs_, describeEvents(events));
+        if (submitted) {
+            pending_.push_back(std::move(hitch));
+        } else {
+            write(hitch);
+        }
+    }
+
+    void HitchDetector::gpuResults(const uint64_t frameNumber, const std::vector<ProfileEvent>& scopes) {
+        // Results arrive in frame order, so anything older than `frameNumber` missed its data.
+        while (!pending_.empty() && pending_.front().frameNumber <= frameNumber) {
+            Hitch& hitch = pending_.front();
+            if (hitch.frameNumber == frameNumber) hitch.gpu = scopes;
+            write(hitch);
+            pending_.pop_front();
+        }
+    }
+
+    void HitchDetector::flush() {
+        for (const auto& hitch : pending_) write(hitch);
+        pending_.clear();
+    }
+
+    void HitchDetector::write(const Hitch& hitch) const {
+        // A bare file name has no parent to create; a failure to create one shows up as !out.
+        const std::filesystem::path parent = std::filesystem::path(reportPath_).parent_path();
+        if (!parent.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(parent, ec);
+        }
+        std::ofstream out(reportPath_, std::ios::app);
+        if (!out) return;
+
+        out << fmt::format("frame {} {:.2f} ms (budget {:.2f} ms) events: {}\n",
+                           hitch.frameNumber, hitch.ms, budgetMs_, describeEvents(hitch.events));
+        if (hitch.cpu.empty()) {
+            out << "  cpu: no scopes (build with REND_PROFILE=ON)\n";
+        }
+        // Events are stored as scopes close; sort by start to read top-down.
+        std::vector<ProfileEvent> cpu = hitch.cpu;
+        std::sort(cpu.begin(), cpu.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+            return a.start_ns < b.start_ns;
+        });
+        for (const auto& event : cpu) {
+            out << fmt::format("  cpu {:>8.2f} +{:>7.2f} ms {}{}\n",
+                               ms(event.start_ns - hitch.startNs), ms(event.end_ns - event.start_ns),
+                               std::string(event.depth * 2, ' '), event.name);
+        }
+        if (hitch.gpu.empty()) {
+            out << "  gpu: no timestamps for this frame\n";
+        }
+        for (const auto& scope : hitch.gpu) {
+            out << fmt::format("  gpu {:>8.2f} +{:>7.2f} ms {}\n",
+                               ms(scope.start_ns > hitch.startNs ? scope.start_ns - hitch.startNs : 0),
+                               ms(scope.end_ns - scope.start_ns), scope.name);
+        }
+    }
+
+} // namespace vkp::core
@@ -0,0 +1,182 @@
+#include <vkp/core/image_writer.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace vkp::core {
+
+    namespace {
+
+        // Slicing-by-4 CRC-32 (IEEE), as required by PNG chunks.
+        struct Crc32Tables {
+            std::array<std::array<uint32_t, 256>, 4> t{};
+            Crc32Tables() {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[0][i] = c;
+                }
+                for (uint32_t i = 0; i < 256; ++i) {
+                    for (size_t s = 1; s < 4; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+                }
+            }
+        };
+
+        uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size) {
+            static const Crc32Tables tables;
+            const auto& t = tables.t;
+            crc = ~crc;
+            while (size >= 4) {
+                crc ^= static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+                       static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+                crc = t[3][crc & 0xFF] ^ t[2][(crc >> 8) & 0xFF] ^ t[1][(crc >> 16) & 0xFF] ^ t[0][crc >> 24];
+                data += 4;
+                size -= 4;
+            }
+            while (size--) crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        void putBE32(std::vector<uint8_t>& out, const uint32_t v) {
+            out.push_back(static_cast<uint8_t>(v >> 24));
+            out.push_back(static_cast<uint8_t>(v >> 16));
+            out.push_back(static_cast<uint8_t>(v >> 8));
+            out.push_back(static_cast<uint8_t>(v));
+        }
+
+        void writeChunk(std::ofstream& out, const char type[4], const std::vector<uint8_t>& data) {
+            std::vector<uint8_t> header;
+            putBE32(header, static_cast<uint32_t>(data.size()));
+            header.insert(header.end(), type, type + 4);
+            out.write(reinterpret_cast<const char*>(header.data()), 8);
+            out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+            uint32_t crc = crc32Update(0, reinterpret_cast<const uint8_t*>(type), 4);
+            crc = crc32Update(crc, data.data(), data.size());
+            std::vector<uint8_t> trailer;
+            putBE32(trailer, crc);
+            out.write(reinterpret_cast<const char*>(trailer.data()), 4);
+        }
+
+        // One scanline as PNG wants it: filter byte 0 followed by RGBA.
+        void scanline(const ImageView8& image, const uint32_t y, uint8_t* dst) {
+            const uint8_t* src = image.pixels + static_cast<size_t>(y) * image.width * 4;
+            *dst++ = 0;
+            if (image.order == PixelOrder::RGBA) {
+                std::memcpy(dst, src, static_cast<size_t>(image.width) * 4);
+                return;
+            }
+            for (uint32_t x = 0; x < image.width; ++x, src += 4, dst += 4) {
+                dst[0] = src[2];
+                dst[1] = src[1];
+                dst[2] = src[0];
+                dst[3] = src[3];
+            }
+        }
+
+        bool writePng(std::ofstream& out, const ImageView8& image) {
+            static constexpr uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+            out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+            std::vector<uint8_t> ihdr;
+            putBE32(ihdr, image.width);
+            putBE32(ihdr, image.height);
+            ihdr.insert(ihdr.end(), { 8, 6, 0, 0, 0 }); // 8 bit, RGBA, deflate, adaptive filter, no interlace
+            writeChunk(out, "IHDR", ihdr);
+
+            // zlib stream made of stored (uncompressed) deflate blocks.
+            const size_t rowBytes = static_cast<size_t>(image.width) * 4 + 1;
+            const size_t rawSize  = rowBytes * image.height;
+            constexpr size_t maxBlock = 65535;
+
+            std::vector<uint8_t> raw(rawSize);
+            for (uint32_t y = 0; y < image.height; ++y) scanline(image, y, raw.data() + y * rowBytes);
+
+            std::vector<uint8_t> idat;
+            idat.reserve(rawSize + rawSize / maxBlock * 5 + 16);
+            idat.push_back(0x78);
+            idat.push_back(0x01);
+            uint32_t a = 1, b = 0;
+            for (size_t offset = 0; offset < rawSize || offset == 0; offset += maxBlock) {
+                const size_t len  = std::min(maxBlock, rawSize - offset);
+                const bool   last = offset + len >= rawSize;
+                idat.push_back(last ? 1 : 0);
+                idat.push_back(static_cast<uint8_t>(len));
+                idat.push_back(static_cast<uint8_t>(len >> 8));
+                idat.push_back(static_cast<uint8_t>(~len));
+                idat.push_back(static_cast<uint8_t>(~len >> 8));
+                idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + len);
+
+                // Adler-32; 64-bit sums cannot overflow within one block, so reduce once per block.
+                uint64_t a64 = a, b64 = b;
+                for (size_t i = offset; i < offset + len; ++i) {
+                    a64 += raw[i];
+                    b64 += a64;
+                }
+                a = static_cast<uint32_t>(a64 % 65521);
+                b = static_cast<uint32_t>(b64 % 65521);
+                if (last) break;
+            }
+            putBE32(idat, (b << 16) | a);
+            writeChunk(out, "IDAT", idat);
+            writeChunk(out, "IEND", {});
+            return static_cast<bool>(out);
+        }
+
+        bool writePpm(std::ofstream& out, const ImageView8& image) {
+            out << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+            std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+            const int r = image.order == PixelOrder::RGBA ? 0 : 2;
+            const int b = 2 - r;
+            for (uint32_t y = 0; y < image.height; ++y) {
+                const uint8_t* src = image.pixels + static_cast<size_t>(y) * image.width * 4;
+                for (uint32_t x = 0; x < image.width; ++x, src += 4) {
+                    row[x * 3 + 0] = src[r];
+                    row[x * 3 + 1] = src[1];
+                    row[x * 3 + 2] = src[b];
+                }
+                out.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+            }
+            return static_cast<bool>(out);
+        }
+
+    } // namespace
+
+    const char* fileExtension(const ImageFileFormat format) {
+        switch (format) {
+            case ImageFileFormat::PNG: return "png";
+            case ImageFileFormat::PPM: return "ppm";
+            case ImageFileFormat::RAW: return "raw";
+        }
+        return "bin";
+    }
+
+    bool parseImageFileFormat(const std::string& name, ImageFileFormat& format) {
+        if (name == "png") format = ImageFileFormat::PNG;
+        else if (name == "ppm") format = ImageFileFormat::PPM;
+        else if (name == "raw") format = ImageFileFormat::RAW;
+        else return false;
+        return true;
+    }
+
+    bool writeImage(const std::string& path, const ImageView8& image, const ImageFileFormat format) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("failed to open {} for writing", path);
+            return false;
+        }
+        switch (format) {
+            case ImageFileFormat::PNG: return writePng(out, image);
+            case ImageFileFormat::PPM: return writePpm(out, image);
+            case ImageFileFormat::RAW:
+                out.write(reinterpret_cast<const char*>(image.pixels),
+                          static_cast<std::streamsize>(image.width) * image.height * 4);
+                return static_cast<bool>(out);
+        }
+        return false;
+    }
+
+} // namespace vkp::core
@@ -0,0 +1,272 @@
+#include <vkp/core/job_system.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace vkp::core {
+
+    namespace {
+        constexpr uint32_t NOT_A_WORKER = UINT32_MAX;
+
+        thread_local uint32_t t_worker = NOT_A_WORKER;
+
+        JobSystem::Options& pendingOptions() {
+            static JobSystem::Options options;
+            return options;
+        }
+
+        bool pinCurrentThread(const uint32_t core) {
+#ifdef _WIN32
+            return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{ 1 } << (core % (sizeof(DWORD_PTR) * 8))) != 0;
+#elif defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core, &set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+            (void)core;
+            return false;
+#endif
+        }
+    }
+
+    void JobSystem::configure(const Options& options) {
+        pendingOptions() = options;
+    }
+
+    JobSystem& JobSystem::get() {
+        static JobSystem instance(pendingOptions());
+        return instance;
+    }
+
+    JobSystem::JobSystem(const Options& options)
+        : mainThread_(std::this_thread::get_id())
+    {
+        const uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        const uint32_t count = options.workers > 0 ? options.workers : std::max(1u, hardware - 1);
+        workers_.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) workers_.push_back(std::make_unique<Worker>());
+        for (uint32_t i = 0; i < count; ++i) {
+            workers_[i]->thread = std::thread(&JobSystem::workerLoop, this, i, options.pinThreads);
+        }
+        LOG_INFO("job system: {} worker(s){}", count, options.pinThreads ? ", pinned to cores" : "");
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard lock(wakeMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (const auto& worker : workers_) worker->thread.join();
+    }
+
+    void JobSystem::schedule(Job job, JobCounter* counter) {
+        if (counter) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+        push({ std::move(job), counter });
+    }
+
+    void JobSystem::scheduleAfter(JobCounter& dependency, Job job, JobCounter* counter) {
+        if (counter) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+        {
+            // finish() drains the continuations under the same lock that observes zero.
+            std::lock_guard lock(dependency.mutex_);
+            if (!dependency.done()) {
+                dependency.continuations_.push_back({ std::move(job), counter });
+                return;
+            }
+        }
+        push({ std::move(job), counter });
+    }
+
+    void JobSystem::scheduleOnMain(Job job, JobCounter* counter) {
+        if (counter) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock(mainMutex_);
+            mainJobs_.push_back({ std::move(job), counter });
+            mainQueued_.fetch_add(1, std::memory_order_release);
+        }
+        // Only the main thread can take it, so a single wake-up could go to the wrong thread.
+        wakeAll();
+    }
+
+    void JobSystem::wait(JobCounter& counter) {
+        const bool main = isMainThread();
+        while (!counter.done()) {
+            Entry entry;
+            if (take(entry)) {
+                run(entry);
+                continue;
+            }
+            if (main && runMainJob()) continue;
+
+            std::unique_lock lock(wakeMutex_);
+            wake_.wait(lock, [&] {
+                return counter.done() || queued_.load(std::memory_order_acquire) > 0
+                    || (main && mainQueued_.load(std::memory_order_acquire) > 0);
+            });
+        }
+
+        // The last job may still hold the counter's lock; the caller may destroy it after this.
+        std::exception_ptr error;
+        {
+            std::lock_guard lock(counter.mutex_);
+            std::swap(error, counter.error_);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    void JobSystem::parallelFor(const uint32_t count, uint32_t grain,
+                                const std::function<void(uint32_t, uint32_t)>& fn) {
+        grain = std::max(grain, 1u);
+        JobCounter counter;
+        for (uint32_t begin = 0; begin < count; begin += grain) {
+            const uint32_t end = std::min(count, begin + grain);
+            schedule([&fn, begin, end] { fn(begin, end); }, &counter);
+        }
+        wait(counter);
+    }
+
+    void JobSystem::pumpMain() {
+        // Jobs queued while these run wait for the next pump, so a job that reschedules itself
+        // doesn't stall the frame.
+        for (uint32_t n = mainQueued_.load(std::memory_order_acquire); n > 0 && runMainJob(); --n) {}
+    }
+
+    JobSystem::Stats JobSystem::stats() const {
+        return { executed_.load(std::memory_order_relaxed), stolen_.load(std::memory_order_relaxed) };
+    }
+
+    void JobSystem::push(Entry entry) {
+        // Workers keep their own jobs local; other threads spread theirs over the pool.
+        const uint32_t target = t_worker != NOT_A_WORKER
+            ? t_worker
+            : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workerCount();
+        {
+            Worker& worker = *workers_[target];
+            std::lock_guard lock(worker.mutex);
+            worker.jobs.push_back(std::move(entry));
+            queued_.fetch_add(1, std::memory_order_release);
+        }
+        std::lock_guard lock(wakeMutex_);
+        wake_.notify_one();
+    }
+
+    bool JobSystem::take(Entry& entry) {
+        const uint32_t self = t_worker;
+        if (self != NOT_A_WORKER) {
+            Worker& own = *workers_[self];
+            std::lock_guard lock(own.mutex);
+            if (!own.jobs.empty()) {
+                entry = std::move(own.jobs.back());
+                own.jobs.pop_back();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        // Steal the oldest job, which is the least likely to share data with the victim's current one.
+        const uint32_t count = workerCount();
+        const uint32_t start = self != NOT_A_WORKER ? self + 1 : nextWorker_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t index = (start + i) % count;
+            if (index == self) continue;
+            Worker& victim = *workers_[index];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                entry = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                stolen_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool JobSystem::runMainJob() {
+        Entry entry;
+        {
+            std::lock_guard lock(mainMutex_);
+            if (mainJobs_.empty()) return false;
+            entry = std::move(mainJobs_.front());
+            mainJobs_.pop_front();
+            mainQueued_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        run(entry);
+        return true;
+    }
+
+    void JobSystem::run(Entry& entry) {
+        try {
+            entry.job();
+        } catch (...) {
+            if (entry.counter) {
+                std::lock_guard lock(entry.counter->mutex_);
+                if (!entry.counter->error_) entry.counter->error_ = std::current_exception();
+            } else {
+                try {
+                    throw;
+                } catch (const std::exception& e) {
+                    LOG_ERROR("job failed: {}", e.what());
+                } catch (...) {
+                    LOG_ERROR("job failed with an unknown exception");
+                }
+            }
+        }
+        entry.job = nullptr;   // release captures before dependents run
+        executed_.fetch_add(1, std::memory_order_relaxed);
+        finish(entry.counter);
+    }
+
+    void JobSystem::finish(JobCounter* counter) {
+        if (!counter) return;
+
+        std::vector<Entry> ready;
+        {
+            std::lock_guard lock(counter->mutex_);
+            if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            ready.swap(counter->continuations_);
+        }
+        for (Entry& entry : ready) push(std::move(entry));
+        wakeAll();
+    }
+
+    void JobSystem::wakeAll() {
+        std::lock_guard lock(wakeMutex_);
+        wake_.notify_all();
+    }
+
+    void JobSystem::workerLoop(const uint32_t index, const bool pin) {
+        t_worker = index;
+        VKP_PROFILE_THREAD(fmt::format("job worker {}", index));
+        if (pin) {
+            const uint32_t core = (index + 1) % std::max(1u, std::thread::hardware_concurrency());
+            if (!pinCurrentThread(core)) LOG_WARN("job worker {}: could not pin to core {}", index, core);
+        }
+
+        for (;;) {
+            Entry entry;
+            if (take(entry)) {
+                run(entry);
+                continue;
+            }
+            std::unique_lock lock(wakeMutex_);
+            wake_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+            if (stopping_ && queued_.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+} // namespace vkp::core
@@ -0,0 +1,81 @@
+#include <vkp/core/mapped_file.h>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace vkp::core {
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("failed to open " + path.string());
+        }
+        file_ = file;
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw std::runtime_error("failed to read the size of " + path.string());
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ == 0) return;
+
+        mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping_ != nullptr ? MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view == nullptr) {
+            if (mapping_ != nullptr) CloseHandle(mapping_);
+            CloseHandle(file);
+            throw std::runtime_error("failed to map " + path.string());
+        }
+        data_ = static_cast<const std::byte*>(view);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_ != nullptr) UnmapViewOfFile(data_);
+        if (mapping_ != nullptr) CloseHandle(mapping_);
+        if (file_ != nullptr) CloseHandle(file_);
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open " + path.string());
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("failed to read the size of " + path.string());
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ == 0) {
+            close(fd);
+            return;
+        }
+
+        void* const mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file referenced.
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("failed to map " + path.string());
+        }
+        data_ = static_cast<const std::byte*>(mapping);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_ != nullptr) munmap(const_cast<std::byte*>(data_), size_);
+    }
+#endif
+
+} // namespace vkp::core
@@ -0,0 +1,120 @@
+#include <vkp/core/metrics.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace vkp::core {
+
+    Histogram::Histogram(std::vector<double> bounds)
+        : bounds_(std::move(bounds))
+        , buckets_(std::make_unique<std::atomic<uint64_t>[]>(bounds_.size() + 1))
+    {
+        std::sort(bounds_.begin(), bounds_.end());
+    }
+
+    void Histogram::observe(const double v) {
+        const auto bucket = static_cast<size_t>(
+            std::lower_bound(bounds_.begin(), bounds_.end(), v) - bounds_.begin());
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(v, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<uint64_t> Histogram::counts() const {
+        std::vector<uint64_t> counts(bounds_.size() + 1);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return counts;
+    }
+
+    MetricsRegistry& MetricsRegistry::get() {
+        static MetricsRegistry instance;
+        return instance;
+    }
+
+    MetricsRegistry::Entry* MetricsRegistry::find(const std::string& name) {
+        for (auto& entry : entries_) {
+            if (entry.name == name) return &entry;
+        }
+        return nullptr;
+    }
+
+    Counter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Entry* entry = find(name)) {
+            if (entry->kind != Kind::Counter) throw std::logic_error("metric " + name + " is not a counter");
+            return *static_cast<Counter*>(entry->metric);
+        }
+        Counter& metric = counters_.emplace_back();
+        entries_.push_back({ name, help, Kind::Counter, &metric });
+        return metric;
+    }
+
+    Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Entry* entry = find(name)) {
+            if (entry->kind != Kind::Gauge) throw std::logic_error("metric " + name + " is not a gauge");
+            return *static_cast<Gauge*>(entry->metric);
+        }
+        Gauge& metric = gauges_.emplace_back();
+        entries_.push_back({ name, help, Kind::Gauge, &metric });
+        return metric;
+    }
+
+    Histogram& MetricsRegistry::histogram(
+        const std::string& name,
+        const std::string& help,
+        const std::initializer_list<double> bounds)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Entry* entry = find(name)) {
+            if (entry->kind != Kind::Histogram) throw std::logic_error("metric " + name + " is not a histogram");
+            return *static_cast<Histogram*>(entry->metric);
+        }
+        Histogram& metric = histograms_.emplace_back(std::vector<double>(bounds));
+        entries_.push_back({ name, help, Kind::Histogram, &metric });
+        return metric;
+    }
+
+    std::string MetricsRegistry::exposition() const {
+        std::ostringstream out;
+        // 15 significant digits: exact for byte counts, still short for bounds like 16.67.
+        out.precision(15);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries_) {
+            out << "# HELP " << entry.name << ' ' << entry.help << '\n';
+            switch (entry.kind) {
+                case Kind::Counter:
+                    out << "# TYPE " << entry.name << " counter\n"
+                        << entry.name << ' ' << static_cast<const Counter*>(entry.metric)->value() << '\n';
+                    break;
+                case Kind::Gauge:
+                    out << "# TYPE " << entry.name << " gauge\n"
+                        << entry.name << ' ' << static_cast<const Gauge*>(entry.metric)->value() << '\n';
+                    break;
+                case Kind::Histogram: {
+                    const auto* histogram = static_cast<const Histogram*>(entry.metric);
+                    const auto  counts    = histogram->counts();
+                    out << "# TYPE " << entry.name << " histogram\n";
+                    // Buckets are read one by one while the writer keeps going, so derive
+                    // _count from them to keep the exposition self-consistent.
+                    uint64_t cumulative = 0;
+                    for (size_t i = 0; i < histogram->bounds().size(); ++i) {
+                        cumulative += counts[i];
+                        out << entry.name << "_bucket{le=\"" << histogram->bounds()[i] << "\"} " << cumulative << '\n';
+                    }
+                    cumulative += counts.back();
+                    out << entry.name << "_bucket{le=\"+Inf\"} " << cumulative << '\n'
+                        << entry.name << "_sum " << histogram->sum() << '\n'
+                        << entry.name << "_count " << cumulative << '\n';
+                    break;
+                }
+            }
+        }
+        return out.str();
+    }
+
+} // namespace vkp::core
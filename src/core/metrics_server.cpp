@@ -0,0 +1,179 @@
+#include <vkp/core/metrics_server.h>
+#include <vkp/core/metrics.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace vkp::core {
+
+    namespace {
+#ifdef _WIN32
+        using socket_t = SOCKET;
+        void closeSocket(const intptr_t fd) { closesocket(static_cast<SOCKET>(fd)); }
+        int  pollSocket(pollfd* fds, const int timeoutMs) { return WSAPoll(fds, 1, timeoutMs); }
+        constexpr int SEND_FLAGS = 0;
+#else
+        using socket_t = int;
+        void closeSocket(const intptr_t fd) { close(static_cast<int>(fd)); }
+        int  pollSocket(pollfd* fds, const int timeoutMs) { return poll(fds, 1, timeoutMs); }
+        constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#endif
+        // How often the accept loop checks for shutdown.
+        constexpr int POLL_INTERVAL_MS = 200;
+
+        void setReceiveTimeout(const socket_t fd, const int ms) {
+#ifdef _WIN32
+            const DWORD timeout = ms;
+#else
+            const timeval timeout{ ms / 1000, (ms % 1000) * 1000 };
+#endif
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        }
+    }
+
+    MetricsServer::MetricsServer(const std::string& endpoint) {
+#ifdef _WIN32
+        WSADATA wsa;
+        WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+        bool ok = false;
+        if (endpoint.rfind("unix:", 0) == 0) {
+            ok = openUnix(endpoint.substr(5));
+        } else {
+            const auto colon = endpoint.rfind(':');
+            const std::string port = colon == std::string::npos ? endpoint : endpoint.substr(colon + 1);
+            const unsigned long value = std::strtoul(port.c_str(), nullptr, 10);
+            if (value == 0 || value > 65535) {
+                LOG_ERROR("invalid metrics endpoint '{}', expected unix:<path> or [localhost:]<port>", endpoint);
+            } else {
+                ok = openTcp(static_cast<uint16_t>(value));
+            }
+        }
+        if (!ok) return;
+
+        thread_ = std::thread(&MetricsServer::serve, this);
+        LOG_INFO("serving metrics on {}", endpoint);
+    }
+
+    MetricsServer::~MetricsServer() {
+        stopping_ = true;
+        if (thread_.joinable()) thread_.join();
+        if (listenFd_ != INVALID) closeSocket(listenFd_);
+#ifndef _WIN32
+        if (!unixPath_.empty()) unlink(unixPath_.c_str());
+#endif
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    bool MetricsServer::openUnix(const std::string& path) {
+#ifdef _WIN32
+        (void)path;
+        LOG_ERROR("unix socket metrics endpoints are not supported on Windows, use a port");
+        return false;
+#else
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            LOG_ERROR("metrics socket path '{}' is empty or too long", path);
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        // A previous run that crashed leaves its socket file behind.
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+            LOG_ERROR("failed to listen on metrics socket {}: {}", path, std::strerror(errno));
+            close(fd);
+            return false;
+        }
+        listenFd_ = fd;
+        unixPath_ = path;
+        return true;
+#endif
+    }
+
+    bool MetricsServer::openTcp(const uint16_t port) {
+        const socket_t fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (static_cast<intptr_t>(fd) == INVALID) return false;
+
+        const int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        // Loopback only: the endpoint is for a local scraper, not the network.
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+            LOG_ERROR("failed to listen on metrics port {}", port);
+            closeSocket(static_cast<intptr_t>(fd));
+            return false;
+        }
+        listenFd_ = static_cast<intptr_t>(fd);
+        return true;
+    }
+
+    void MetricsServer::serve() {
+        VKP_PROFILE_THREAD("metrics");
+        pollfd pfd{};
+        pfd.fd     = static_cast<socket_t>(listenFd_);
+        pfd.events = POLLIN;
+
+        while (!stopping_) {
+            if (pollSocket(&pfd, POLL_INTERVAL_MS) <= 0 || (pfd.revents & POLLIN) == 0) continue;
+            const socket_t client = accept(static_cast<socket_t>(listenFd_), nullptr, nullptr);
+            if (static_cast<intptr_t>(client) == INVALID) continue;
+            respond(static_cast<intptr_t>(client));
+            closeSocket(static_cast<intptr_t>(client));
+        }
+    }
+
+    void MetricsServer::respond(const intptr_t client) const {
+        const auto fd = static_cast<socket_t>(client);
+        setReceiveTimeout(fd, 1000);
+
+        // Any request gets the metrics; read the header only so the client sees a clean close.
+        char        buffer[1024];
+        std::string request;
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            const auto n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        const std::string body = MetricsRegistry::get().exposition();
+        const std::string response =
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+
+        size_t sent = 0;
+        while (sent < response.size()) {
+            const auto n = send(fd, response.data() + sent, static_cast<int>(response.size() - sent), SEND_FLAGS);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+} // namespace vkp::core
@@ -0,0 +1,173 @@
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <system_error>
+
+namespace vkp::core {
+
+    namespace {
+        const auto epoch = std::chrono::steady_clock::now();
+
+        // Hands the thread's ring back to the profiler when the thread exits.
+        struct RingOwner {
+            ProfileRing* ring = nullptr;
+
+            ~RingOwner() {
+                if (ring != nullptr) Profiler::get().releaseRing(*ring);
+            }
+        };
+
+        thread_local RingOwner current_ring;
+
+        void writeEscaped(std::ofstream& out, const std::string& text) {
+            for (const char c : text) {
+                if (c == '"' || c == '\\') out << '\\';
+                out << c;
+            }
+        }
+    }
+
+    Profiler& Profiler::get() {
+        static Profiler instance;
+        return instance;
+    }
+
+    Profiler::Profiler()
+        : gpu_ring_(std::make_unique<ProfileRing>())
+    {
+        gpu_ring_->tid         = 0;
+        gpu_ring_->thread_name = "GPU (graphics queue)";
+    }
+
+    uint64_t Profiler::now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    ProfileRing& Profiler::threadRing() {
+        if (current_ring.ring == nullptr) {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            ProfileRing* ring = nullptr;
+            if (!free_rings_.empty()) {
+                // Reuse the ring of an exited thread; its events go with it.
+                ring = free_rings_.back();
+                free_rings_.pop_back();
+                ring->head.store(0, std::memory_order_release);
+                ring->depth = 0;
+            } else {
+                rings_.push_back(std::make_unique<ProfileRing>());
+                ring = rings_.back().get();
+            }
+            ring->tid         = next_tid_.fetch_add(1);
+            ring->thread_name = fmt::format("thread {}", ring->tid);
+            ring->in_use      = true;
+            current_ring.ring = ring;
+        }
+        return *current_ring.ring;
+    }
+
+    void Profiler::releaseRing(ProfileRing& ring) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        ring.in_use = false;
+        free_rings_.push_back(&ring);
+    }
+
+    void Profiler::setThreadName(const std::string& name) {
+        ProfileRing& ring = threadRing();
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        ring.thread_name = name;
+    }
+
+    void Profiler::recordGpu(const char* name, const uint64_t start_ns, const uint64_t end_ns) {
+        std::lock_guard<std::mutex> lock(gpu_mutex_);
+        gpu_ring_->push({ name, start_ns, end_ns, 0 });
+    }
+
+    std::vector<ProfileEvent> Profiler::eventsSince(const ProfileRing& ring, const uint64_t since_ns) {
+        const uint64_t head  = ring.head.load(std::memory_order_acquire);
+        const uint64_t count = std::min<uint64_t>(head, ProfileRing::CAPACITY);
+
+        std::vector<ProfileEvent> out;
+        for (uint64_t i = head - count; i < head; ++i) {
+            const ProfileEvent& event = ring.events[i % ProfileRing::CAPACITY];
+            if (event.start_ns >= since_ns) out.push_back(event);
+        }
+        return out;
+    }
+
+    std::vector<ProfileEvent> Profiler::threadEventsSince(const uint64_t since_ns) {
+        // A thread that never recorded has no ring; don't create one just to read it.
+        if (current_ring.ring == nullptr) return {};
+        return eventsSince(*current_ring.ring, since_ns);
+    }
+
+    std::vector<ProfileEvent> Profiler::gpuEventsSince(const uint64_t since_ns) {
+        std::lock_guard<std::mutex> lock(gpu_mutex_);
+        return eventsSince(*gpu_ring_, since_ns);
+    }
+
+    void Profiler::discardEvents() {
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            for (const auto& ring : rings_) ring->head.store(0, std::memory_order_release);
+        }
+        std::lock_guard<std::mutex> lock(gpu_mutex_);
+        gpu_ring_->head.store(0, std::memory_order_release);
+    }
+
+    bool Profiler::writeChromeTrace(const std::string& path) {
+        const std::filesystem::path file(path);
+        if (file.has_parent_path()) {
+            std::error_code error;
+            std::filesystem::create_directories(file.parent_path(), error);
+        }
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("failed to open trace file {}", path);
+            return false;
+        }
+
+        size_t written = 0;
+        bool   first   = true;
+        auto writeRing = [&](const ProfileRing& ring) {
+            out << (first ? "" : ",\n")
+                << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << ring.tid
+                << R"(,"args":{"name":")";
+            writeEscaped(out, ring.thread_name);
+            out << "\"}}";
+            first = false;
+
+            for (const ProfileEvent& event : eventsSince(ring, 0)) {
+                out << ",\n" << R"({"name":")";
+                writeEscaped(out, event.name);
+                out << R"(","ph":"X","pid":1,"tid":)" << ring.tid
+                    << ",\"ts\":"  << static_cast<double>(event.start_ns) / 1000.0
+                    << ",\"dur\":" << static_cast<double>(event.end_ns - event.start_ns) / 1000.0
+                    << "}";
+                ++written;
+            }
+        };
+
+        out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            for (const auto& ring : rings_) {
+                if (ring->in_use) writeRing(*ring);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(gpu_mutex_);
+            writeRing(*gpu_ring_);
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        LOG_INFO("wrote {} profile events to {}", written, path);
+        return true;
+    }
+
+} // namespace vkp::core
@@ -0,0 +1,253 @@
+#include <vkp/core/software_renderer.h>
+#include <vkp/core/job_system.h>
+#include <vkp/logger.h>
+
+#include "software_shading.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <string>
+
+#include <fmt/format.h>
+
+#if defined(VKP_SOFTWARE_AVX2) && defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace vkp::core {
+
+    namespace software {
+
+#include "software_shading.inl"
+
+        void shadePacketBaseline(const float fragX, const float fragY, const float width, const float height,
+                                 const SceneParams& scene, float (&rgba)[4][simd::LANES]) {
+            shadePacket(fragX, fragY, width, height, scene, rgba);
+        }
+
+    } // namespace software
+
+    namespace {
+
+        using software::SceneParams;
+
+        void normalize(const float x, const float y, const float z, float (&out)[3]) {
+            const float len = std::sqrt(x * x + y * y + z * z);
+            out[0] = x / len;
+            out[1] = y / len;
+            out[2] = z / len;
+        }
+
+        SceneParams sceneParams(const float time) {
+            // pow(l, 6) is undefined for negative l in GLSL; those early frames are taken as l = 0.
+            const float l = std::max(time * 0.2f - 0.2f, 0.f);
+            SceneParams scene{};
+            scene.axisX     = std::cos(time * 0.3f);
+            scene.axisZ     = std::sin(time * 0.3f);
+            scene.armLength = std::max(0.f, std::min(std::pow(l, 6.f), 1000.f));
+            scene.pulse     = 0.6f + 0.4f * std::sin(time * 0.5f);
+            scene.tiltSin   = std::sin(-0.12f);
+            scene.tiltCos   = std::cos(-0.12f);
+            scene.turnSin   = std::sin(-0.78539816f);
+            scene.turnCos   = std::cos(-0.78539816f);
+            normalize(-3.f, 4.f, -2.f, scene.lightDirs[0]);
+            normalize(4.f, -3.f, 0.f, scene.lightDirs[1]);
+            normalize(2.f, 3.f, -4.f, scene.lightDirs[2]);
+            return scene;
+        }
+
+#if defined(VKP_SOFTWARE_AVX2)
+        bool cpuHasAvx2Fma() {
+    #if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) return false;
+            __cpuid(info, 1);
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            // The OS must save the YMM registers as well.
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            if (!fma || !osxsave || (_xgetbv(0) & 6) != 6) return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+    #else
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    #endif
+        }
+#endif
+
+        // The kernel for this CPU: AVX2/FMA when it was built and the CPU has them.
+        struct Kernel {
+            software::ShadePacketFn shade;
+            const char*             name;
+        };
+
+        const Kernel& kernel() {
+            static const Kernel selected = [] {
+#if defined(VKP_SOFTWARE_AVX2)
+                if (cpuHasAvx2Fma()) return Kernel{ software::shadePacketAvx2, "avx2" };
+#endif
+                return Kernel{ software::shadePacketBaseline, simd::backendName() };
+            }();
+            return selected;
+        }
+
+        // Linear [0, 1] to 8-bit sRGB. Fine enough that the error stays below a quarter step.
+        struct SrgbTable {
+            static constexpr int SIZE = 16384;
+            std::array<uint8_t, SIZE + 1> t{};
+            SrgbTable() {
+                for (int i = 0; i <= SIZE; ++i) {
+                    const double c = static_cast<double>(i) / SIZE;
+                    const double s = c <= 0.0031308 ? 12.92 * c : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+                    t[i] = static_cast<uint8_t>(std::lround(s * 255.0));
+                }
+            }
+        };
+
+        uint8_t encodeUnorm(const float c) {
+            return static_cast<uint8_t>(std::lround(std::clamp(c, 0.f, 1.f) * 255.f));
+        }
+
+        uint8_t encodeSrgb(const float c) {
+            static const SrgbTable table;
+            return table.t[std::lround(std::clamp(c, 0.f, 1.f) * SrgbTable::SIZE)];
+        }
+
+        double secondsSince(const std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    } // namespace
+
+    struct SoftwareRenderer::Frame {
+        uint8_t*    pixels;
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    tilesX;
+        SceneParams scene;
+        PixelOrder  order;
+        bool        srgb;
+    };
+
+    SoftwareRenderer::SoftwareRenderer(const uint32_t threads)
+        : threads_(threads > 0 ? threads : JobSystem::get().workerCount() + 1)
+    {
+        LOG_DEBUG("software renderer: {} threads, {} SIMD", threads_, kernel().name);
+    }
+
+    void SoftwareRenderer::render(uint8_t* pixels, const uint32_t width, const uint32_t height, const float time,
+                                  const PixelOrder order, const bool srgb) {
+        if (width == 0 || height == 0) return;
+
+        const uint32_t tilesX = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+        const uint32_t tiles  = tilesX * ((height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+        const Frame frame{ pixels, width, height, tilesX, sceneParams(time), order, srgb };
+
+        // Tiles over the object take far longer than empty ones, so they are claimed one by one
+        // rather than split up front.
+        std::atomic<uint32_t> next{ 0 };
+        const auto drain = [&] {
+            for (uint32_t tile; (tile = next.fetch_add(1, std::memory_order_relaxed)) < tiles;) {
+                renderTile(frame, tile);
+            }
+        };
+        JobSystem& jobs = JobSystem::get();
+        JobCounter counter;
+        for (uint32_t i = 1; i < std::min(threads_, tiles); ++i) jobs.schedule(drain, &counter);
+        drain();
+        jobs.wait(counter);
+    }
+
+    void SoftwareRenderer::renderTile(const Frame& frame, const uint32_t tile) const {
+        const uint32_t x0 = (tile % frame.tilesX) * TILE_WIDTH;
+        const uint32_t y0 = (tile / frame.tilesX) * TILE_HEIGHT;
+        const uint32_t x1 = std::min(x0 + TILE_WIDTH, frame.width);
+        const uint32_t y1 = std::min(y0 + TILE_HEIGHT, frame.height);
+        const bool     bgra = frame.order == PixelOrder::BGRA;
+        const auto     width  = static_cast<float>(frame.width);
+        const auto     height = static_cast<float>(frame.height);
+
+        const software::ShadePacketFn shade = kernel().shade;
+        alignas(32) float rgba[4][simd::LANES];
+        const auto& [r, g, b, a] = rgba;
+        for (uint32_t y = y0; y < y1; ++y) {
+            uint8_t* row = frame.pixels + (static_cast<size_t>(y) * frame.width) * 4;
+            for (uint32_t x = x0; x < x1; x += simd::LANES) {
+                shade(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, width, height, frame.scene, rgba);
+
+                const uint32_t lanes = std::min<uint32_t>(simd::LANES, x1 - x);
+                for (uint32_t i = 0; i < lanes; ++i) {
+                    uint8_t* px = row + static_cast<size_t>(x + i) * 4;
+                    const uint8_t red   = frame.srgb ? encodeSrgb(r[i]) : encodeUnorm(r[i]);
+                    const uint8_t green = frame.srgb ? encodeSrgb(g[i]) : encodeUnorm(g[i]);
+                    const uint8_t blue  = frame.srgb ? encodeSrgb(b[i]) : encodeUnorm(b[i]);
+                    px[0] = bgra ? blue : red;
+                    px[1] = green;
+                    px[2] = bgra ? red : blue;
+                    px[3] = encodeUnorm(a[i]);   // alpha is never sRGB-encoded
+                }
+            }
+        }
+    }
+
+    bool renderSoftwareSequence(const SoftwareSequence& sequence) {
+        if (sequence.width == 0 || sequence.height == 0 || sequence.frames == 0) {
+            LOG_ERROR("software sequence needs a non-empty size and at least one frame");
+            return false;
+        }
+        std::vector<uint8_t> pixels(static_cast<size_t>(sequence.width) * sequence.height * 4);
+        const double megapixels = static_cast<double>(sequence.width) * sequence.height * sequence.frames / 1e6;
+
+        const auto renderAll = [&](SoftwareRenderer& renderer, const bool capture) {
+            const auto start = std::chrono::steady_clock::now();
+            double encodeSeconds = 0.0;
+            for (uint32_t i = 0; i < sequence.frames; ++i) {
+                const auto time = static_cast<float>(sequence.startTime + i * sequence.timeStep);
+                renderer.render(pixels.data(), sequence.width, sequence.height, time);
+                if (!capture) continue;
+
+                const auto encodeStart = std::chrono::steady_clock::now();
+                const std::string path = fmt::format("{}/frame_{:06}_{}x{}.{}", sequence.captureDir, i,
+                                                     sequence.width, sequence.height,
+                                                     fileExtension(sequence.captureFormat));
+                if (!writeImage(path, { pixels.data(), sequence.width, sequence.height, PixelOrder::BGRA },
+                                sequence.captureFormat)) {
+                    LOG_WARN("software renderer: failed to write {}", path);
+                }
+                encodeSeconds += secondsSince(encodeStart);
+            }
+            return secondsSince(start) - encodeSeconds;
+        };
+
+        JobSystem& jobs = JobSystem::get();
+        SoftwareRenderer renderer(sequence.threads);
+        if (sequence.scaling) {
+            double baseline = 0.0;
+            for (uint32_t threads = 1;; threads = std::min(threads * 2, renderer.threads())) {
+                SoftwareRenderer scaled(threads);
+                const double seconds = renderAll(scaled, false);
+                if (threads == 1) baseline = seconds;
+                LOG_INFO("software renderer scaling: {:>3} threads {:8.2f} Mpix/s, {:5.2f}x",
+                         threads, megapixels / seconds, baseline / seconds);
+                if (threads == renderer.threads()) break;
+            }
+        }
+
+        const bool capture = sequence.captureDir != nullptr;
+        if (capture) std::filesystem::create_directories(sequence.captureDir);
+        const JobSystem::Stats before = jobs.stats();
+        const double seconds = renderAll(renderer, capture);
+        const JobSystem::Stats after = jobs.stats();
+        LOG_INFO("software renderer: {} frames of {}x{} in {:.2f} s ({:.1f} fps, {:.2f} Mpix/s), "
+                 "{} threads, {} SIMD, {} of {} jobs stolen",
+                 sequence.frames, sequence.width, sequence.height, seconds, sequence.frames / seconds,
+                 megapixels / seconds, renderer.threads(), kernel().name,
+                 after.stolen - before.stolen, after.executed - before.executed);
+        return true;
+    }
+
+} // namespace vkp::core
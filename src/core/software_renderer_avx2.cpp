@@ -0,0 +1,20 @@
+// The software renderer's kernel for AVX2/FMA. CMake compiles only this file with -mavx2 -mfma
+// (or /arch:AVX2) when REND_AVX2 is on; software_renderer.cpp calls it when the CPU has both.
+// Without those flags it is empty.
+
+#include "software_shading.h"
+
+#if defined(VKP_SIMD_AVX2)
+
+namespace vkp::core::software {
+
+#include "software_shading.inl"
+
+    void shadePacketAvx2(const float fragX, const float fragY, const float width, const float height,
+                         const SceneParams& scene, float (&rgba)[4][simd::LANES]) {
+        shadePacket(fragX, fragY, width, height, scene, rgba);
+    }
+
+} // namespace vkp::core::software
+
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vkp/core/simd.h>
+
+namespace vkp::core::software {
+
+    // The values the shaders derive from time alone, and the constant ray rotation and light
+    // directions, so the shading kernel itself needs nothing from <cmath>.
+    struct SceneParams {
+        float axisX;       // axisDir(); its y is 0
+        float axisZ;
+        float armLength;   // l in sceneBoxes
+        float pulse;
+        float tiltSin, tiltCos;   // ray.yz *= rot2(-0.12)
+        float turnSin, turnCos;   // ray.xz *= rot2(-0.78539816)
+        float lightDirs[3][3];    // the red, green and blue lights, normalized
+    };
+
+    // mainImage for simd::LANES pixels whose centres are (fragX + lane, fragY) in framebuffer
+    // coordinates, i.e. gl_FragCoord with the origin at the top left. Writes linear r, g, b and a.
+    using ShadePacketFn = void (*)(float fragX, float fragY, float width, float height, const SceneParams& scene,
+                                   float (&rgba)[4][simd::LANES]);
+
+    // Built for the baseline target: SSE2, NEON or scalar.
+    void shadePacketBaseline(float fragX, float fragY, float width, float height, const SceneParams& scene,
+                             float (&rgba)[4][simd::LANES]);
+    // Built with REND_AVX2 only (VKP_SOFTWARE_AVX2); callable on CPUs with AVX2 and FMA.
+    void shadePacketAvx2(float fragX, float fragY, float width, float height, const SceneParams& scene,
+                         float (&rgba)[4][simd::LANES]);
+
+} // namespace vkp::core::software
@@ -0,0 +1,143 @@
+// The software renderer's scene kernel, a port of scene.glsl and sdf.glsl. It is included once
+// per SIMD backend, inside namespace vkp::core::software and after software_shading.h:
+// software_renderer.cpp builds it for the baseline target and software_renderer_avx2.cpp for
+// AVX2/FMA. Only simd:: and plain arithmetic may be used here. An inline function from a shared
+// header (<cmath>, <algorithm>, ...) would be emitted with the including file's instructions,
+// and the linker may keep that copy for every other caller.
+
+namespace {
+
+    using simd::Float8;
+    using simd::Mask8;
+
+    // Constants of scene.glsl and sdf.glsl.
+    constexpr int   MAX_ITERS  = 300;
+    constexpr float LEN_FACTOR = 0.25f;
+    constexpr float NDELTA     = 0.001f;
+    constexpr float PI         = 3.1415926536f;
+
+    struct Vec3 {
+        Float8 x, y, z;
+    };
+
+    Float8 dot(const Vec3& a, const Vec3& b) {
+        return simd::fma(a.x, b.x, simd::fma(a.y, b.y, a.z * b.z));
+    }
+
+    Vec3 broadcast(const float (&v)[3]) {
+        return { Float8(v[0]), Float8(v[1]), Float8(v[2]) };
+    }
+
+    // rotSpace: p times the rotation about the axis by an angle that grows towards the origin.
+    Vec3 rotSpace(const Vec3& p, const SceneParams& scene) {
+        const Float8 t  = simd::clamp((dot(p, p) - Float8(100.f)) * Float8(1.f / (2.f - 100.f)), 0.f, 1.f);
+        const Float8 sm = t * t * (Float8(3.f) - Float8(2.f) * t);
+        const Float8 sm2 = sm * sm;
+        const Float8 ang = Float8(PI) * sm2 * sm2 * sm;
+        if (!simd::any(ang > Float8(0.f))) return p;
+
+        // The angle is 0 in the remaining lanes, where the matrix is the identity.
+        Float8 s, c;
+        simd::sincos(ang, s, c);
+        const Float8 oc = Float8(1.f) - c;
+        const Float8 ax(scene.axisX), az(scene.axisZ);
+        const Float8 ocxz = oc * ax * az;
+        return {
+            p.x * simd::fma(oc * ax, ax, c) - p.y * az * s + p.z * ocxz,
+            p.x * az * s + p.y * c - p.z * ax * s,
+            p.x * ocxz + p.y * ax * s + p.z * simd::fma(oc * az, az, c),
+        };
+    }
+
+    Float8 box(const Float8 ax, const Float8 ay, const Float8 az, const float dx, const float dy, const float dz) {
+        return simd::max(ax - Float8(dx), simd::max(ay - Float8(dy), az - Float8(dz)));
+    }
+
+    Float8 sceneSDF(const Vec3& p, const SceneParams& scene) {
+        const Vec3   q  = rotSpace(p, scene);
+        const Float8 ax = simd::abs(q.x), ay = simd::abs(q.y), az = simd::abs(q.z);
+        const float  l  = scene.armLength;
+        const Float8 d1 = box(ax, ay, az, 0.7f, 0.1f, l);
+        const Float8 d2 = box(ax, ay, az, 0.1f, l, 0.7f);
+        const Float8 d3 = box(ax, ay, az, l, 0.7f, 0.1f);
+        const Float8 d4 = box(ax, ay, az, 1.f, 1.f, 1.f);
+        return simd::min(simd::min(d1, d2), simd::min(d3, d4));
+    }
+
+    Vec3 sceneNormal(const Vec3& p, const SceneParams& scene) {
+        const Float8 h(NDELTA);
+        const Vec3 g{
+            sceneSDF({ p.x + h, p.y, p.z }, scene) - sceneSDF({ p.x - h, p.y, p.z }, scene),
+            sceneSDF({ p.x, p.y + h, p.z }, scene) - sceneSDF({ p.x, p.y - h, p.z }, scene),
+            sceneSDF({ p.x, p.y, p.z + h }, scene) - sceneSDF({ p.x, p.y, p.z - h }, scene),
+        };
+        const Float8 inv = Float8(1.f) / simd::sqrt(dot(g, g));
+        return { g.x * inv, g.y * inv, g.z * inv };
+    }
+
+    void shadePacket(const float fragX, const float fragY, const float width, const float height,
+                     const SceneParams& scene, float (&rgba)[4][simd::LANES]) {
+        // --- ray setup ---
+        const Float8 u = (simd::iota(fragX) - Float8(0.5f * width)) * Float8(1.f / height);
+        const float  v = (fragY - 0.5f * height) / height;
+        const Float8 invLen = Float8(1.f) / simd::sqrt(simd::fma(u, u, Float8(v * v + 1.f)));
+        Vec3 ray{ u * invLen, Float8(v) * invLen, invLen };
+        const Float8 s1(scene.tiltSin), c1(scene.tiltCos);
+        ray = { ray.x, ray.y * c1 + ray.z * s1, ray.z * c1 - ray.y * s1 };
+        const Float8 s2(scene.turnSin), c2(scene.turnCos);
+        ray = { ray.x * c2 + ray.z * s2, ray.y, ray.z * c2 - ray.x * s2 };
+
+        // --- raymarch ---
+        Vec3   pos{ Float8(10.f), Float8(2.f), Float8(-10.f) };
+        Float8 t(0.f);
+        Mask8  active = Float8(0.f) < Float8(1.f);
+        Mask8  hit    = Float8(1.f) < Float8(0.f);
+        for (int i = 0; i < MAX_ITERS; ++i) {
+            const Float8 dist = sceneSDF(pos, scene);
+            const Mask8  done = dist < Float8(NDELTA);
+            hit    = hit | (active & done);
+            active = simd::andNot(active, done);
+            if (!simd::any(active)) break;
+            const Float8 step = simd::select(active, dist * Float8(LEN_FACTOR), Float8(0.f));
+            pos.x = simd::fma(ray.x, step, pos.x);
+            pos.y = simd::fma(ray.y, step, pos.y);
+            pos.z = simd::fma(ray.z, step, pos.z);
+            t     = simd::select(active, t + Float8(1.f), t);
+        }
+
+        // --- shading --- misses stay black with alpha 0
+        const Float8 zero(0.f);
+        if (!simd::any(hit)) {
+            for (auto& channel : rgba) zero.store(channel);
+            return;
+        }
+
+        const Vec3   n     = sceneNormal(pos, scene);
+        const Float8 tn    = t * Float8(1.f / MAX_ITERS);
+        const Float8 fade  = Float8(1.f) - tn * tn;
+
+        const Vec3  p2    = rotSpace(pos, scene);
+        const Mask8 sideX = simd::abs(p2.x) > Float8(1.001f);
+        const Mask8 sideY = simd::abs(p2.y) > Float8(1.001f);
+        const auto  base  = [&](const float purple, const float crimson, const float violet) {
+            return simd::select(sideX, Float8(purple), simd::select(sideY, Float8(crimson), Float8(violet)));
+        };
+
+        const Float8 lr  = simd::abs(dot(broadcast(scene.lightDirs[0]), n));
+        // pow(x, 5) of a negative x is undefined in GLSL; it is taken as 0 here.
+        const Float8 g   = simd::max(dot(broadcast(scene.lightDirs[1]), n), zero);
+        const Float8 g2  = g * g;
+        const Float8 lg  = g2 * g2 * g;
+        const Float8 lb  = simd::abs(dot(broadcast(scene.lightDirs[2]), n));
+        const auto light = [&](const float rc, const float gc, const float bc) {
+            return simd::fma(Float8(rc), lr, simd::fma(Float8(gc), lg, Float8(bc) * lb));
+        };
+
+        const Float8 scale = fade * Float8(scene.pulse);
+        simd::select(hit, base(0.6f, 0.8f, 0.4f) * light(1.0f, 0.7f, 0.3f) * scale, zero).store(rgba[0]);
+        simd::select(hit, base(0.0f, 0.2f, 0.0f) * light(0.6f, 1.0f, 0.7f) * scale, zero).store(rgba[1]);
+        simd::select(hit, base(0.8f, 0.4f, 0.6f) * light(0.4f, 0.8f, 1.0f) * scale, zero).store(rgba[2]);
+        simd::select(hit, Float8(1.f), zero).store(rgba[3]);
+    }
+
+} // namespace
@@ -0,0 +1,81 @@
+#include <vkp/core/startup_profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+
+namespace vkp::core {
+
+    namespace {
+        // Taken during static initialization so the report covers everything before main().
+        const StartupProfiler::clock::time_point process_start = StartupProfiler::clock::now();
+    }
+
+    StartupProfiler::Scope::Scope(const char* phase)
+        : phase_(phase)
+        , start_(clock::now())
+    {
+    }
+
+    StartupProfiler::Scope::~Scope() {
+        StartupProfiler::get().record(phase_, start_, clock::now());
+    }
+
+    StartupProfiler& StartupProfiler::get() {
+        static StartupProfiler instance;
+        return instance;
+    }
+
+    StartupProfiler::StartupProfiler()
+        : origin_(process_start)
+        , main_thread_(std::this_thread::get_id())
+    {
+    }
+
+    double StartupProfiler::sinceOrigin(const clock::time_point t) const {
+        return std::chrono::duration<double, std::milli>(t - origin_).count();
+    }
+
+    void StartupProfiler::record(const char* phase, const clock::time_point start, const clock::time_point end) {
+        const bool main_thread = std::this_thread::get_id() == main_thread_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        phases_.push_back({
+            phase,
+            sinceOrigin(start),
+            std::chrono::duration<double, std::milli>(end - start).count(),
+            main_thread
+        });
+    }
+
+    void StartupProfiler::report() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::sort(phases_.begin(), phases_.end(), [](const Phase& a, const Phase& b) {
+            return a.start_ms < b.start_ms;
+        });
+
+        double summed = 0.0;
+        double end    = 0.0;
+        LOG_INFO("startup phases:");
+        for (const auto& phase : phases_) {
+            LOG_INFO("  {:<24} {:>8.2f} ms  (at {:>8.2f} ms, {})",
+                     phase.name, phase.duration_ms, phase.start_ms,
+                     phase.main_thread ? "main" : "worker");
+            summed += phase.duration_ms;
+            end = std::max(end, phase.start_ms + phase.duration_ms);
+        }
+        LOG_INFO("startup: {:.2f} ms wall, {:.2f} ms summed over phases, init done at {:.2f} ms",
+                 end, summed, sinceOrigin(clock::now()));
+    }
+
+    void StartupProfiler::markFirstFrame() {
+        if (first_frame_seen_.exchange(true)) return;
+        LOG_INFO("time to first frame: {:.2f} ms", sinceOrigin(clock::now()));
+    }
+
+    void StartupProfiler::restart() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        origin_ = clock::now();
+        phases_.clear();
+        first_frame_seen_ = false;
+    }
+
+} // namespace vkp::core
@@ -0,0 +1,192 @@
+#include <vkp/graphics/debug_message_collector.h>
+#include <vkp/logger.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <string_view>
+
+namespace vkp::graphics {
+
+    namespace {
+        std::string shorten(const std::string_view message, const size_t length) {
+            if (message.size() <= length) return std::string(message);
+            return std::string(message.substr(0, length)) + "...";
+        }
+    }
+
+    DebugMessageCollector::DebugMessageCollector()
+        : suppressedMetric_(core::MetricsRegistry::get().counter(
+              "vkp_vk_messages_unlogged_total", "Vulkan debug messages held back by rate limiting")) {
+        auto& registry = core::MetricsRegistry::get();
+        metrics_[Error]       = &registry.counter("vkp_vk_validation_errors_total", "Vulkan validation errors");
+        metrics_[Warning]     = &registry.counter("vkp_vk_validation_warnings_total", "Vulkan validation warnings");
+        metrics_[Performance] = &registry.counter("vkp_vk_performance_warnings_total",
+                                                  "Vulkan debug messages of the performance type");
+        metrics_[Info]        = &registry.counter("vkp_vk_info_messages_total", "Vulkan info and verbose messages");
+    }
+
+    DebugMessageCollector::~DebugMessageCollector() {
+        if (suppressed_ > 0) {
+            LOG_WARN("{} Vulkan debug message(s) were not logged because of rate limiting", suppressed_);
+        }
+    }
+
+    VKAPI_ATTR VkBool32 VKAPI_CALL DebugMessageCollector::callback(
+        const VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+        const VkDebugUtilsMessageTypeFlagsEXT types,
+        const VkDebugUtilsMessengerCallbackDataEXT* data,
+        void* userData) {
+        if (userData != nullptr && data != nullptr) {
+            static_cast<DebugMessageCollector*>(userData)->receive(severity, types, *data);
+        }
+        return VK_FALSE;
+    }
+
+    void DebugMessageCollector::setFilter(
+        const VkDebugUtilsMessageSeverityFlagsEXT severities, const VkDebugUtilsMessageTypeFlagsEXT types) {
+        const auto previousSeverities = severities_.exchange(severities & ALL_SEVERITIES, std::memory_order_relaxed);
+        const auto previousTypes      = types_.exchange(types & ALL_TYPES, std::memory_order_relaxed);
+        if (filterListener_ && (previousSeverities != severityFilter() || previousTypes != typeFilter())) {
+            filterListener_();
+        }
+    }
+
+    void DebugMessageCollector::receive(
+        const VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+        const VkDebugUtilsMessageTypeFlagsEXT types,
+        const VkDebugUtilsMessengerCallbackDataEXT& data) {
+        // Filtered messages cost two relaxed loads.
+        if ((severity & severityFilter()) == 0 || (types & typeFilter()) == 0) return;
+
+        Category category = Info;
+        if (types & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT)  category = Performance;
+        else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)   category = Error;
+        else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) category = Warning;
+        frame_[category].fetch_add(1, std::memory_order_relaxed);
+        total_[category].fetch_add(1, std::memory_order_relaxed);
+        metrics_[category]->inc();
+
+        const std::string_view message = data.pMessage != nullptr ? data.pMessage : "";
+        const std::string_view idName  = data.pMessageIdName != nullptr ? data.pMessageIdName : "";
+        // Validation messages carry a hash of their VUID; others are told apart by name or text.
+        const uint64_t key = data.messageIdNumber != 0
+            ? static_cast<uint32_t>(data.messageIdNumber)
+            : std::hash<std::string_view>{}(idName.empty() ? message : idName);
+        const auto now = std::chrono::steady_clock::now();
+
+        std::unique_lock lock(mutex_);
+        Entry& entry = entries_[key];
+        ++entry.count;
+        if (category == Performance) {
+            if (const auto it = performanceIndex_.find(key); it != performanceIndex_.end()) {
+                performance_[it->second].count = entry.count;
+            } else if (performance_.size() < MAX_PERFORMANCE_WARNINGS) {
+                performanceIndex_.emplace(key, performance_.size());
+                performance_.push_back({
+                    idName.empty() ? fmt::format("{:#010x}", static_cast<uint32_t>(data.messageIdNumber))
+                                   : std::string(idName),
+                    shorten(message, MAX_MESSAGE_LENGTH),
+                    entry.count });
+            }
+        }
+
+        // The first occurrence is logged, repeats only as a count once REPEAT_INTERVAL has passed.
+        if (entry.logged && now - entry.loggedAt < REPEAT_INTERVAL) {
+            ++entry.unlogged;
+            return;
+        }
+        if (!takeLogToken(now)) {
+            ++entry.unlogged;
+            ++suppressed_;
+            suppressedMetric_.inc();
+            return;
+        }
+        const uint64_t repeats = entry.unlogged;
+        entry.logged   = true;
+        entry.loggedAt = now;
+        entry.unlogged = 0;
+        lock.unlock();
+
+        const std::string line = repeats > 0
+            ? fmt::format("{} ({} more since last logged)", message, repeats)
+            : std::string(message);
+        switch (category) {
+            case Error:       LOG_ERROR("vulkan: {}", line); break;
+            case Warning:     LOG_WARN("vulkan: {}", line); break;
+            case Performance: LOG_WARN("vulkan performance: {}", line); break;
+            default:          LOG_INFO("vulkan: {}", line); break;
+        }
+    }
+
+    bool DebugMessageCollector::takeLogToken(const std::chrono::steady_clock::time_point now) {
+        const double elapsed = std::chrono::duration<double>(now - refilledAt_).count();
+        refilledAt_ = now;
+        tokens_ = std::min(LOG_BURST, tokens_ + elapsed * LOGS_PER_SECOND);
+        if (tokens_ < 1.0) return false;
+        tokens_ -= 1.0;
+        return true;
+    }
+
+    void DebugMessageCollector::endFrame() {
+        for (size_t i = 0; i < CategoryCount; ++i) {
+            lastFrame_[i].store(frame_[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    DebugMessageCounts DebugMessageCollector::lastFrame() const {
+        return {
+            lastFrame_[Error].load(std::memory_order_relaxed),
+            lastFrame_[Warning].load(std::memory_order_relaxed),
+            lastFrame_[Performance].load(std::memory_order_relaxed),
+            lastFrame_[Info].load(std::memory_order_relaxed),
+        };
+    }
+
+    DebugMessageCounts DebugMessageCollector::total() const {
+        return {
+            total_[Error].load(std::memory_order_relaxed),
+            total_[Warning].load(std::memory_order_relaxed),
+            total_[Performance].load(std::memory_order_relaxed),
+            total_[Info].load(std::memory_order_relaxed),
+        };
+    }
+
+    std::vector<PerformanceWarning> DebugMessageCollector::performanceWarnings() const {
+        std::vector<PerformanceWarning> warnings;
+        {
+            std::lock_guard lock(mutex_);
+            warnings = performance_;
+        }
+        std::stable_sort(warnings.begin(), warnings.end(), [](const auto& a, const auto& b) {
+            return a.count > b.count;
+        });
+        return warnings;
+    }
+
+    bool parseDebugMessageFilter(
+        const std::string& list,
+        VkDebugUtilsMessageSeverityFlagsEXT& severities,
+        VkDebugUtilsMessageTypeFlagsEXT& types) {
+        VkDebugUtilsMessageSeverityFlagsEXT parsedSeverities = 0;
+        VkDebugUtilsMessageTypeFlagsEXT     parsedTypes      = 0;
+        std::stringstream stream(list);
+        std::string word;
+        while (std::getline(stream, word, ',')) {
+            if      (word == "verbose")     parsedSeverities |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
+            else if (word == "info")        parsedSeverities |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+            else if (word == "warning")     parsedSeverities |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
+            else if (word == "error")       parsedSeverities |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+            else if (word == "general")     parsedTypes |= VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT;
+            else if (word == "validation")  parsedTypes |= VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT;
+            else if (word == "performance") parsedTypes |= VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+            else return false;
+        }
+        if (parsedSeverities != 0) severities = parsedSeverities;
+        if (parsedTypes != 0)      types      = parsedTypes;
+        return true;
+    }
+
+} // namespace vkp::graphics
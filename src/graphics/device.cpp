@@ -1,22 +1,17 @@
 #include <vkp/graphics/device.h>
+#include <vkp/core/hitch_detector.h>
+#include <vkp/core/metrics.h>
+#include <vkp/core/startup_profiler.h>
+#include <vkp/logger.h>
 
+#include <algorithm>
 #include <cstring>
-#include <iostream>
 #include <set>
 #include <unordered_set>
 
 namespace vkp::graphics {
 
 // local callback functions
-static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
-    VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-    VkDebugUtilsMessageTypeFlagsEXT messageType,
-    const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
-    void *pUserData) {
-  std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
-  return VK_FALSE;
-}
-
 VkResult CreateDebugUtilsMessengerEXT(
     const VkInstance instance,
     const VkDebugUtilsMessengerCreateInfoEXT *pCreateInfo,
@@ -46,24 +41,26 @@ void DestroyDebugUtilsMessengerEXT(
 
 // class member functions
 Device::Device(Window &window) : window{window} {
-  createInstance();
-  setupDebugMessenger();
-  createSurface();
-  pickPhysicalDevice();
-  createLogicalDevice();
-  createCommandPool();
+  // Each step consumes the handle produced by the previous one, so these stay serial.
+  { VKP_STARTUP_SCOPE("vk instance"); createInstance(); }
+  { VKP_STARTUP_SCOPE("debug messenger"); setupDebugMessenger(); }
+  { VKP_STARTUP_SCOPE("surface"); createSurface(); }
+  { VKP_STARTUP_SCOPE("physical device"); pickPhysicalDevice(); }
+  { VKP_STARTUP_SCOPE("logical device"); createLogicalDevice(); }
+  { VKP_STARTUP_SCOPE("command pool"); createCommandPool(); }
+  if (enableValidationLayers) debugMessages_.setFilterListener([this] { recreateDebugMessenger(); });
 }
 
 Device::~Device() {
-  vkDestroyCommandPool(device_, commandPool, nullptr);
-  vkDestroyDevice(device_, nullptr);
+  vkDestroyCommandPool(device_, commandPool, allocator());
+  vkDestroyDevice(device_, allocator());
 
-  if (enableValidationLayers) {
-    DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+  if (enableValidationLayers && debugMessenger != VK_NULL_HANDLE) {
+    DestroyDebugUtilsMessengerEXT(instance, debugMessenger, allocator());
   }
 
-  vkDestroySurfaceKHR(instance, surface_, nullptr);
-  vkDestroyInstance(instance, nullptr);
+  vkDestroySurfaceKHR(instance, surface_, allocator());
+  vkDestroyInstance(instance, allocator());
 }
 
 void Device::createInstance() {
@@ -77,7 +74,9 @@ void Device::createInstance() {
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "No Engine";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  appInfo.apiVersion = VK_API_VERSION_1_0;
+  // 1.1 for vkGetPhysicalDeviceMemoryProperties2, used by the memory budget query; 1.3 so a 1.3
+  // device exposes dynamic rendering as core. Older devices still report and get their own version.
+  appInfo.apiVersion = VK_API_VERSION_1_3;
 
   VkInstanceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -99,7 +98,7 @@ void Device::createInstance() {
     createInfo.pNext = nullptr;
   }
 
-  if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS) {
+  if (vkCreateInstance(&createInfo, allocator(), &instance) != VK_SUCCESS) {
     throw std::runtime_error("failed to create instance!");
   }
 
@@ -112,14 +111,17 @@ void Device::pickPhysicalDevice() {
   if (deviceCount == 0) {
     throw std::runtime_error("failed to find GPUs with Vulkan support!");
   }
-  std::cout << "Device count: " << deviceCount << std::endl;
+  LOG_INFO("Device count: {}", deviceCount);
   std::vector<VkPhysicalDevice> devices(deviceCount);
   vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
 
   // Pick the first suitable device. In a real engine, you'd want to score and select the best.
+  // The capability snapshot of the chosen device is kept, so nothing below queries it again.
   for (const auto &device : devices) {
-    if (isDeviceSuitable(device)) {
+    DeviceCaps caps = DeviceCaps::query(device, surface_);
+    if (isDeviceSuitable(caps)) {
       physicalDevice = device;
+      caps_ = std::move(caps);
       break;
     }
   }
@@ -128,12 +130,34 @@ void Device::pickPhysicalDevice() {
     throw std::runtime_error("failed to find a suitable GPU!");
   }
 
-  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-  std::cout << "physical device: " << properties.deviceName << std::endl;
+  properties = caps_.properties;
+  LOG_INFO("physical device: {}", properties.deviceName);
+
+  memoryBudgetSupported_ =
+      caps_.hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) && properties.apiVersion >= VK_API_VERSION_1_1;
+  if (memoryBudgetSupported_) {
+    getMemoryProperties2_ = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2>(
+        vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2"));
+    memoryBudgetSupported_ = getMemoryProperties2_ != nullptr;
+  }
+  if (!memoryBudgetSupported_) {
+    LOG_INFO("{} not available, memory budget falls back to heap sizes", VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+  }
+
+  // Before 1.3 the extension and its dependencies have to be enabled explicitly.
+  dynamicRenderingCore_ = properties.apiVersion >= VK_API_VERSION_1_3;
+  dynamicRenderingSupported_ =
+      caps_.dynamicRendering &&
+      (dynamicRenderingCore_ || (caps_.hasExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) &&
+                                 caps_.hasExtension(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME) &&
+                                 caps_.hasExtension(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)));
+  if (!dynamicRenderingSupported_) {
+    LOG_INFO("{} not available, rendering through render passes", VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+  }
 }
 
 void Device::createLogicalDevice() {
-  QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+  const QueueFamilyIndices &indices = caps_.queues;
 
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
   std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
@@ -150,6 +174,8 @@ void Device::createLogicalDevice() {
 
   VkPhysicalDeviceFeatures deviceFeatures = {};
   deviceFeatures.samplerAnisotropy = VK_TRUE;
+  // Optional: shader invocation counts in GpuProfiler.
+  deviceFeatures.pipelineStatisticsQuery = caps_.features.pipelineStatisticsQuery;
 
   VkDeviceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -157,9 +183,26 @@ void Device::createLogicalDevice() {
   createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
   createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+  std::vector<const char *> enabledExtensions = deviceExtensions;
+  if (memoryBudgetSupported_) {
+    enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+  }
+
+  VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures = {};
+  dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+  dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+  if (dynamicRenderingSupported_) {
+    createInfo.pNext = &dynamicRenderingFeatures;
+    if (!dynamicRenderingCore_) {
+      enabledExtensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+      enabledExtensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+      enabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+  }
+
   createInfo.pEnabledFeatures = &deviceFeatures;
-  createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-  createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+  createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+  createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
   // Device-specific validation layers are deprecated, but still set for compatibility.
   if (enableValidationLayers) {
@@ -169,12 +212,20 @@ void Device::createLogicalDevice() {
     createInfo.enabledLayerCount = 0;
   }
 
-  if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device_) != VK_SUCCESS) {
+  if (vkCreateDevice(physicalDevice, &createInfo, allocator(), &device_) != VK_SUCCESS) {
     throw std::runtime_error("failed to create logical device!");
   }
 
   vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
   vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+
+  if (dynamicRenderingSupported_) {
+    cmdBeginRendering_ = reinterpret_cast<PFN_vkCmdBeginRendering>(vkGetDeviceProcAddr(
+        device_, dynamicRenderingCore_ ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR"));
+    cmdEndRendering_ = reinterpret_cast<PFN_vkCmdEndRendering>(vkGetDeviceProcAddr(
+        device_, dynamicRenderingCore_ ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR"));
+    dynamicRenderingSupported_ = cmdBeginRendering_ != nullptr && cmdEndRendering_ != nullptr;
+  }
 }
 
 void Device::createCommandPool() {
@@ -187,54 +238,60 @@ void Device::createCommandPool() {
   poolInfo.flags =
       VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-  if (vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+  if (vkCreateCommandPool(device_, &poolInfo, allocator(), &commandPool) != VK_SUCCESS) {
     throw std::runtime_error("failed to create command pool!");
   }
 }
 
-void Device::createSurface() { window.createSurface(instance, &surface_); }
-
-bool Device::isDeviceSuitable(VkPhysicalDevice device) const {
-  QueueFamilyIndices indices = findQueueFamilies(device);
-
-  bool extensionsSupported = checkDeviceExtensionSupport(device);
-
-  bool swapChainAdequate = false;
-  if (extensionsSupported) {
-    SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
-    swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
-  }
+void Device::createSurface() { window.createSurface(instance, &surface_, allocator()); }
 
-  VkPhysicalDeviceFeatures supportedFeatures;
-  vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+bool Device::isDeviceSuitable(const DeviceCaps &caps) const {
+  const bool extensionsSupported = checkDeviceExtensionSupport(caps);
+  const bool swapChainAdequate = !caps.surfaceFormats.empty() && !caps.presentModes.empty();
 
   // Require samplerAnisotropy for texture filtering.
-  return indices.isComplete() && extensionsSupported && swapChainAdequate &&
-         supportedFeatures.samplerAnisotropy;
+  return caps.queues.isComplete() && extensionsSupported && swapChainAdequate &&
+         caps.features.samplerAnisotropy;
 }
 
 void Device::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo) {
   createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-  createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-                               VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-                               VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-  createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-                           VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-                           VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-  createInfo.pfnUserCallback = debugCallback;
-  createInfo.pUserData = nullptr;  // Optional
+  // Only what the collector keeps, so the layers don't format messages it would drop. The
+  // messenger is recreated when the filter changes.
+  createInfo.messageSeverity = debugMessages_.severityFilter();
+  createInfo.messageType = debugMessages_.typeFilter();
+  createInfo.pfnUserCallback = DebugMessageCollector::callback;
+  createInfo.pUserData = &debugMessages_;
 }
 
 void Device::setupDebugMessenger() {
   if (!enableValidationLayers) return;
   VkDebugUtilsMessengerCreateInfoEXT createInfo;
   populateDebugMessengerCreateInfo(createInfo);
-  if (CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
+  if (CreateDebugUtilsMessengerEXT(instance, &createInfo, allocator(), &debugMessenger) != VK_SUCCESS) {
     throw std::runtime_error("failed to set up debug messenger!");
   }
 }
 
+void Device::recreateDebugMessenger() {
+  std::lock_guard lock{debugMessengerMutex_};
+  // The new one is created first, so no message is lost in between; one may be counted twice.
+  VkDebugUtilsMessengerEXT messenger = VK_NULL_HANDLE;
+  VkDebugUtilsMessengerCreateInfoEXT createInfo;
+  populateDebugMessengerCreateInfo(createInfo);
+  // A messenger needs at least one severity and one type; with none selected there is nothing to receive.
+  if (createInfo.messageSeverity != 0 && createInfo.messageType != 0 &&
+      CreateDebugUtilsMessengerEXT(instance, &createInfo, allocator(), &messenger) != VK_SUCCESS) {
+    LOG_WARN("failed to recreate the debug messenger for the new filter, keeping the previous one");
+    return;
+  }
+  if (debugMessenger != VK_NULL_HANDLE) {
+    DestroyDebugUtilsMessengerEXT(instance, debugMessenger, allocator());
+  }
+  debugMessenger = messenger;
+}
+
 bool Device::checkValidationLayerSupport() const {
   uint32_t layerCount;
   vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
@@ -279,108 +336,36 @@ void Device::hasGflwRequiredInstanceExtensions() {
   std::vector<VkExtensionProperties> extensions(extensionCount);
   vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
 
-  std::cout << "available extensions:" << std::endl;
   std::unordered_set<std::string> available;
   for (const auto &[extensionName, specVersion] : extensions) {
-    std::cout << "\t" << extensionName << std::endl;
     available.insert(extensionName);
   }
 
-  std::cout << "required extensions:" << std::endl;
+  // Only report what is missing; dumping every extension to the console slowed startup down.
   for (const auto requiredExtensions = getRequiredExtensions(); const auto &required : requiredExtensions) {
-    std::cout << "\t" << required << std::endl;
     if (!available.contains(required)) {
+      LOG_ERROR("missing required instance extension: {}", required);
       throw std::runtime_error("Missing required glfw extension");
     }
   }
 }
 
-bool Device::checkDeviceExtensionSupport(const VkPhysicalDevice device) const {
-  uint32_t extensionCount;
-  vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
-
-  std::vector<VkExtensionProperties> availableExtensions(extensionCount);
-  vkEnumerateDeviceExtensionProperties(
-      device,
-      nullptr,
-      &extensionCount,
-      availableExtensions.data());
-
-  std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
-
-  for (const auto &[extensionName, specVersion] : availableExtensions) {
-    requiredExtensions.erase(extensionName);
-  }
-
-  return requiredExtensions.empty();
+bool Device::checkDeviceExtensionSupport(const DeviceCaps &caps) const {
+  return std::all_of(deviceExtensions.begin(), deviceExtensions.end(), [&caps](const char *extension) {
+    return caps.hasExtension(extension);
+  });
 }
 
-QueueFamilyIndices Device::findQueueFamilies(const VkPhysicalDevice device) const {
-  QueueFamilyIndices indices;
-
-  uint32_t queueFamilyCount = 0;
-  vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
-
-  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-  vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
-
-  int i = 0;
-  for (const auto &queueFamily : queueFamilies) {
-    if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-      indices.graphicsFamily = i;
-      indices.graphicsFamilyHasValue = true;
-    }
-    VkBool32 presentSupport = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
-    if (queueFamily.queueCount > 0 && presentSupport) {
-      indices.presentFamily = i;
-      indices.presentFamilyHasValue = true;
-    }
-    if (indices.isComplete()) {
-      break;
-    }
-    i++;
-  }
-
-  return indices;
-}
-
-SwapChainSupportDetails Device::querySwapChainSupport(VkPhysicalDevice device) const {
-  SwapChainSupportDetails details;
-  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface_, &details.capabilities);
-
-  uint32_t formatCount;
-  vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface_, &formatCount, nullptr);
-
-  if (formatCount != 0) {
-    details.formats.resize(formatCount);
-    vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface_, &formatCount, details.formats.data());
-  }
-
-  uint32_t presentModeCount;
-  vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface_, &presentModeCount, nullptr);
-
-  if (presentModeCount != 0) {
-    details.presentModes.resize(presentModeCount);
-    vkGetPhysicalDeviceSurfacePresentModesKHR(
-        device,
-        surface_,
-        &presentModeCount,
-        details.presentModes.data());
-  }
-  return details;
+VkSurfaceCapabilitiesKHR Device::getSurfaceCapabilities() const {
+  VkSurfaceCapabilitiesKHR capabilities;
+  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface_, &capabilities);
+  return capabilities;
 }
 
 VkFormat Device::findSupportedFormat(
     const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const {
   for (VkFormat format : candidates) {
-    VkFormatProperties props;
-    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
-
-    if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features) {
-      return format;
-    } else if (
-        tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features) {
+    if (caps_.supportsFormat(format, tiling, features)) {
       return format;
     }
   }
@@ -388,13 +373,8 @@ VkFormat Device::findSupportedFormat(
 }
 
 uint32_t Device::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
-  VkPhysicalDeviceMemoryProperties memProperties;
-  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-    if ((typeFilter & (1 << i)) &&
-        (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-      return i;
-    }
+  if (const auto type = caps_.findMemoryType(typeFilter, properties)) {
+    return *type;
   }
 
   throw std::runtime_error("failed to find suitable memory type!");
@@ -405,14 +385,15 @@ void Device::createBuffer(
     const VkBufferUsageFlags usage,
     const VkMemoryPropertyFlags properties,
     VkBuffer &buffer,
-    VkDeviceMemory &bufferMemory) const {
+    VkDeviceMemory &bufferMemory,
+    const MemoryCategory category) const {
   VkBufferCreateInfo bufferInfo{};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.size = size;
   bufferInfo.usage = usage;
   bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-  if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+  if (vkCreateBuffer(device_, &bufferInfo, allocator(), &buffer) != VK_SUCCESS) {
     throw std::runtime_error("failed to create vertex buffer!");
   }
 
@@ -424,9 +405,10 @@ void Device::createBuffer(
   allocInfo.allocationSize = memRequirements.size;
   allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+  if (vkAllocateMemory(device_, &allocInfo, allocator(), &bufferMemory) != VK_SUCCESS) {
     throw std::runtime_error("failed to allocate vertex buffer memory!");
   }
+  trackAllocation(bufferMemory, allocInfo.allocationSize, allocInfo.memoryTypeIndex, category);
 
   vkBindBufferMemory(device_, buffer, bufferMemory, 0);
 }
@@ -458,6 +440,7 @@ void Device::endSingleTimeCommands(VkCommandBuffer commandBuffer) const {
   submitInfo.pCommandBuffers = &commandBuffer;
 
   vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
+  core::HitchDetector::get().note(core::HitchDetector::QueueWaitIdle);
   vkQueueWaitIdle(graphicsQueue_);
 
   vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
@@ -506,26 +489,127 @@ void Device::createImageWithInfo(
     const VkImageCreateInfo &imageInfo,
     const VkMemoryPropertyFlags properties,
     VkImage &image,
-    VkDeviceMemory &imageMemory) const {
-  if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+    VkDeviceMemory &imageMemory,
+    const MemoryCategory category) const {
+  if (vkCreateImage(device_, &imageInfo, allocator(), &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
 
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device_, image, &memRequirements);
+  imageMemory = allocateMemory(memRequirements, properties, category);
 
+  if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
+    throw std::runtime_error("failed to bind image memory!");
+  }
+}
+
+VkDeviceMemory Device::allocateMemory(
+    const VkMemoryRequirements &requirements,
+    const VkMemoryPropertyFlags properties,
+    const MemoryCategory category) const {
   VkMemoryAllocateInfo allocInfo{};
   allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+  allocInfo.allocationSize = requirements.size;
+  allocInfo.memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
 
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate image memory!");
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  if (vkAllocateMemory(device_, &allocInfo, allocator(), &memory) != VK_SUCCESS) {
+    throw std::runtime_error("failed to allocate device memory!");
   }
+  trackAllocation(memory, allocInfo.allocationSize, allocInfo.memoryTypeIndex, category);
+  return memory;
+}
 
-  if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
-    throw std::runtime_error("failed to bind image memory!");
+namespace {
+struct MemoryMetrics {
+  core::Counter &allocations =
+      core::MetricsRegistry::get().counter("vkp_device_allocations_total", "vkAllocateMemory calls through Device");
+  core::Counter &frees =
+      core::MetricsRegistry::get().counter("vkp_device_frees_total", "vkFreeMemory calls through Device");
+  core::Gauge &live =
+      core::MetricsRegistry::get().gauge("vkp_device_memory_allocations", "Live device memory allocations");
+  core::Gauge &bytes =
+      core::MetricsRegistry::get().gauge("vkp_gpu_memory_in_use_bytes", "Device memory allocated through Device");
+};
+
+MemoryMetrics &memoryMetrics() {
+  static MemoryMetrics metrics;
+  return metrics;
+}
+}  // namespace
+
+const char *memoryCategoryName(const MemoryCategory category) {
+  switch (category) {
+    case MemoryCategory::SwapchainDepth: return "swapchain depth";
+    case MemoryCategory::RenderTarget: return "render target";
+    case MemoryCategory::Staging: return "staging";
+    case MemoryCategory::Mesh: return "mesh";
+    case MemoryCategory::Texture: return "texture";
+    case MemoryCategory::ImGui: return "imgui";
+    default: return "other";
+  }
+}
+
+void Device::trackAllocation(
+    const VkDeviceMemory memory, const VkDeviceSize size, const uint32_t memoryType, const MemoryCategory category) const {
+  const uint32_t heap = caps_.memory.memoryTypes[memoryType].heapIndex;
+  std::lock_guard<std::mutex> lock(allocationMutex_);
+  allocations_[memory] = {size, heap, category};
+  allocatedBytes_ += size;
+  heapBytes_[heap] += size;
+  categoryBytes_[static_cast<size_t>(category)] += size;
+
+  auto &metrics = memoryMetrics();
+  metrics.allocations.inc();
+  metrics.live.set(static_cast<double>(allocations_.size()));
+  metrics.bytes.set(static_cast<double>(allocatedBytes_));
+}
+
+void Device::freeMemory(const VkDeviceMemory memory) const {
+  if (memory == VK_NULL_HANDLE) return;
+  vkFreeMemory(device_, memory, allocator());
+
+  std::lock_guard<std::mutex> lock(allocationMutex_);
+  if (const auto it = allocations_.find(memory); it != allocations_.end()) {
+    const auto &[size, heap, category] = it->second;
+    allocatedBytes_ -= size;
+    heapBytes_[heap] -= size;
+    categoryBytes_[static_cast<size_t>(category)] -= size;
+    allocations_.erase(it);
   }
+
+  auto &metrics = memoryMetrics();
+  metrics.frees.inc();
+  metrics.live.set(static_cast<double>(allocations_.size()));
+  metrics.bytes.set(static_cast<double>(allocatedBytes_));
+}
+
+MemoryReport Device::queryMemoryReport() const {
+  MemoryReport report;
+  report.budgetExtension = memoryBudgetSupported_;
+
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+  budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+  if (memoryBudgetSupported_) {
+    VkPhysicalDeviceMemoryProperties2 props2{};
+    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    props2.pNext = &budget;
+    getMemoryProperties2_(physicalDevice, &props2);
+  }
+
+  std::lock_guard<std::mutex> lock(allocationMutex_);
+  report.categories = categoryBytes_;
+  report.heaps.resize(caps_.memory.memoryHeapCount);
+  for (uint32_t i = 0; i < caps_.memory.memoryHeapCount; i++) {
+    auto &heap = report.heaps[i];
+    heap.size = caps_.memory.memoryHeaps[i].size;
+    heap.deviceLocal = (caps_.memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    heap.tracked = heapBytes_[i];
+    heap.budget = memoryBudgetSupported_ ? budget.heapBudget[i] : heap.size;
+    heap.usage = memoryBudgetSupported_ ? budget.heapUsage[i] : heap.tracked;
+  }
+  return report;
 }
 
 VkInstance Device::getInstance() const {
@@ -536,10 +620,6 @@ VkPhysicalDevice Device::getPhysicalDevice() const {
   return physicalDevice;
 }
 
-uint32_t Device::getGraphicsQueueFamilyIndex() const {
-  return findQueueFamilies(physicalDevice).graphicsFamily;
-}
-
 VkQueue Device::getGraphicsQueue() const {
   return graphicsQueue_;
 }
@@ -0,0 +1,99 @@
+#include <vkp/graphics/device_caps.h>
+
+#include <algorithm>
+
+namespace vkp::graphics {
+
+    DeviceCaps DeviceCaps::query(const VkPhysicalDevice physicalDevice, const VkSurfaceKHR surface) {
+        DeviceCaps caps;
+        caps.physicalDevice_ = physicalDevice;
+        vkGetPhysicalDeviceProperties(physicalDevice, &caps.properties);
+        vkGetPhysicalDeviceFeatures(physicalDevice, &caps.features);
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &caps.memory);
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+        caps.queueFamilies.resize(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, caps.queueFamilies.data());
+        for (uint32_t i = 0; i < familyCount && !caps.queues.isComplete(); i++) {
+            const auto& family = caps.queueFamilies[i];
+            if (family.queueCount > 0 && family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+                caps.queues.graphicsFamily = i;
+                caps.queues.graphicsFamilyHasValue = true;
+            }
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+            if (family.queueCount > 0 && presentSupport) {
+                caps.queues.presentFamily = i;
+                caps.queues.presentFamilyHasValue = true;
+            }
+        }
+
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+        caps.extensions.reserve(extensionCount);
+        for (const auto& extension : extensions) caps.extensions.emplace_back(extension.extensionName);
+        std::sort(caps.extensions.begin(), caps.extensions.end());
+
+        uint32_t formatCount = 0;
+        vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, nullptr);
+        caps.surfaceFormats.resize(formatCount);
+        vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, caps.surfaceFormats.data());
+
+        uint32_t presentModeCount = 0;
+        vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount, nullptr);
+        caps.presentModes.resize(presentModeCount);
+        vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount, caps.presentModes.data());
+
+        // Features2 needs a 1.1 device; the feature struct is valid for the 1.3 core and the KHR extension.
+        if (caps.properties.apiVersion >= VK_API_VERSION_1_1) {
+            VkPhysicalDeviceDynamicRenderingFeatures dynamicRendering{};
+            dynamicRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &dynamicRendering;
+            vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+            caps.dynamicRendering = dynamicRendering.dynamicRendering == VK_TRUE;
+        }
+
+        caps.formats_.resize(CORE_FORMAT_COUNT);
+        for (uint32_t format = 0; format < CORE_FORMAT_COUNT; format++) {
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, static_cast<VkFormat>(format), &caps.formats_[format]);
+        }
+        return caps;
+    }
+
+    bool DeviceCaps::hasExtension(const char* name) const {
+        return std::binary_search(extensions.begin(), extensions.end(), std::string(name));
+    }
+
+    VkFormatProperties DeviceCaps::formatProperties(const VkFormat format) const {
+        if (static_cast<uint32_t>(format) < formats_.size()) return formats_[format];
+        VkFormatProperties props{};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice_, format, &props);
+        return props;
+    }
+
+    bool DeviceCaps::supportsFormat(
+        const VkFormat format, const VkImageTiling tiling, const VkFormatFeatureFlags features) const
+    {
+        const VkFormatProperties props = formatProperties(format);
+        if (tiling == VK_IMAGE_TILING_LINEAR) return (props.linearTilingFeatures & features) == features;
+        if (tiling == VK_IMAGE_TILING_OPTIMAL) return (props.optimalTilingFeatures & features) == features;
+        return false;
+    }
+
+    std::optional<uint32_t> DeviceCaps::findMemoryType(
+        const uint32_t typeFilter, const VkMemoryPropertyFlags flags) const
+    {
+        for (uint32_t i = 0; i < memory.memoryTypeCount; i++) {
+            if ((typeFilter & (1u << i)) && (memory.memoryTypes[i].propertyFlags & flags) == flags) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+} // namespace vkp::graphics
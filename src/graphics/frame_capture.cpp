@@ -0,0 +1,200 @@
+#include <vkp/graphics/frame_capture.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <filesystem>
+
+namespace vkp::graphics {
+
+    FrameCapture::FrameCapture(
+        Device& device,
+        const uint32_t framesInFlight,
+        std::string directory,
+        const core::ImageFileFormat format)
+        : device_(device)
+        , directory_(std::move(directory))
+        , format_(format)
+        , slots_(framesInFlight)
+    {
+        // Cached memory keeps the encoder's reads of the mapped copy fast; it needs an explicit
+        // invalidate when it is not also coherent.
+        constexpr VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        if (device_.caps().hasMemoryType(cached)) {
+            memoryFlags_ = cached;
+        } else {
+            LOG_WARN("no host-cached memory type, frame capture falls back to coherent memory");
+            memoryFlags_ = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        }
+        coherent_ = (memoryFlags_ & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+        std::filesystem::create_directories(directory_);
+
+        LOG_INFO("capturing frames to {} as {}", directory_, core::fileExtension(format_));
+    }
+
+    FrameCapture::~FrameCapture() {
+        core::JobSystem::get().wait(encoding_);
+        for (auto& readback : readbacks_) destroyReadback(*readback);
+
+        if (dropped_ > 0) {
+            LOG_WARN("frame capture dropped {} frame(s) because the encoders fell behind", dropped_);
+        }
+    }
+
+    bool FrameCapture::supportsFormat(const VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void FrameCapture::ensureCapacity(Readback& readback, const VkDeviceSize size) {
+        if (readback.size >= size) return;
+        destroyReadback(readback);
+
+        device_.createBuffer(
+            size,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            memoryFlags_,
+            readback.buffer,
+            readback.memory,
+            MemoryCategory::Staging);
+        if (vkMapMemory(device_.device(), readback.memory, 0, VK_WHOLE_SIZE, 0, &readback.mapped) != VK_SUCCESS) {
+            throw std::runtime_error("failed to map capture readback buffer");
+        }
+        readback.size = size;
+    }
+
+    void FrameCapture::destroyReadback(Readback& readback) {
+        if (readback.buffer == VK_NULL_HANDLE) return;
+        vkUnmapMemory(device_.device(), readback.memory);
+        vkDestroyBuffer(device_.device(), readback.buffer, device_.allocator());
+        device_.freeMemory(readback.memory);
+        readback = {};
+    }
+
+    void FrameCapture::record(
+        const VkCommandBuffer cmd,
+        const uint32_t frameIndex,
+        const VkImage image,
+        const VkImageLayout layout,
+        const VkFormat format,
+        const VkExtent2D extent,
+        const uint64_t frameNumber)
+    {
+        VKP_PROFILE_SCOPE("FrameCapture::record");
+        Slot& slot = slots_[frameIndex];
+        // collect() has already handed this slot's previous copy to an encoder.
+        if (slot.readback == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!freeReadbacks_.empty()) {
+                slot.readback = freeReadbacks_.back();
+                freeReadbacks_.pop_back();
+            }
+        }
+        if (slot.readback == nullptr) {
+            // Every buffer is either in flight or still being encoded.
+            if (readbacks_.size() >= slots_.size() + MAX_QUEUED_JOBS) {
+                ++dropped_;
+                return;
+            }
+            slot.readback = readbacks_.emplace_back(std::make_unique<Readback>()).get();
+        }
+        ensureCapacity(*slot.readback, static_cast<VkDeviceSize>(extent.width) * extent.height * 4);
+
+        VkImageMemoryBarrier toTransfer{};
+        toTransfer.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toTransfer.srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        toTransfer.dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT;
+        toTransfer.oldLayout           = layout;
+        toTransfer.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.image               = image;
+        toTransfer.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        vkCmdPipelineBarrier(cmd,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        region.imageExtent      = { extent.width, extent.height, 1 };
+        vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.readback->buffer, 1, &region);
+
+        VkImageMemoryBarrier toOriginal = toTransfer;
+        toOriginal.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        toOriginal.dstAccessMask = 0;
+        toOriginal.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toOriginal.newLayout     = layout;
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer              = slot.readback->buffer;
+        toHost.size                = VK_WHOLE_SIZE;
+
+        // ALL_COMMANDS rather than BOTTOM_OF_PIPE so a later barrier on the image (video's
+        // toSampled) chains after this layout transition.
+        vkCmdPipelineBarrier(cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toOriginal);
+        vkCmdPipelineBarrier(cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+        slot.frameNumber = frameNumber;
+        slot.extent      = extent;
+        slot.order       = (format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM)
+                         ? core::PixelOrder::RGBA : core::PixelOrder::BGRA;
+    }
+
+    void FrameCapture::collect(const uint32_t frameIndex) {
+        Slot& slot = slots_[frameIndex];
+        if (slot.readback == nullptr) return;
+        VKP_PROFILE_SCOPE("FrameCapture::collect");
+
+        if (!coherent_) {
+            VkMappedMemoryRange range{};
+            range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = slot.readback->memory;
+            range.size   = VK_WHOLE_SIZE;
+            vkInvalidateMappedMemoryRanges(device_.device(), 1, &range);
+        }
+
+        // The job owns the buffer until it has been written.
+        core::JobSystem::get().schedule([this, job = slot] { encode(job); }, &encoding_);
+        slot.readback = nullptr;
+    }
+
+    void FrameCapture::flush() {
+        for (uint32_t i = 0; i < slots_.size(); ++i) collect(i);
+
+        core::JobSystem::get().wait(encoding_);
+    }
+
+    void FrameCapture::encode(const Slot& slot) {
+        {
+            VKP_PROFILE_SCOPE("encode frame");
+            const std::string path = fmt::format(
+                "{}/frame_{:06}_{}x{}.{}", directory_, slot.frameNumber,
+                slot.extent.width, slot.extent.height, core::fileExtension(format_));
+            core::writeImage(path,
+                             { static_cast<const uint8_t*>(slot.readback->mapped), slot.extent.width,
+                               slot.extent.height, slot.order },
+                             format_);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        freeReadbacks_.push_back(slot.readback);
+    }
+
+} // namespace vkp::graphics
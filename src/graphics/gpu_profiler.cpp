@@ -0,0 +1,182 @@
+#include <vkp/graphics/gpu_profiler.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace vkp::graphics {
+
+    GpuProfiler::GpuProfiler(Device& device, const uint32_t framesInFlight)
+        : device_(device)
+        , slots_(framesInFlight)
+    {
+        const auto& caps = device_.caps();
+        // Device enables pipelineStatisticsQuery wherever it is supported.
+        if (caps.features.pipelineStatisticsQuery) {
+            VkQueryPoolCreateInfo info{};
+            info.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            info.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            info.queryCount         = framesInFlight * MAX_STATISTICS_PER_FRAME;
+            info.pipelineStatistics = STATISTICS;
+            if (vkCreateQueryPool(device_.device(), &info, device_.allocator(), &statisticsPool_) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create pipeline statistics query pool");
+            }
+        } else {
+            LOG_WARN("device does not support pipeline statistics queries, shader invocation counts disabled");
+        }
+
+        const uint32_t validBits = caps.queueFamilies[device_.getGraphicsQueueFamilyIndex()].timestampValidBits;
+        if (validBits == 0) {
+            LOG_WARN("graphics queue does not support timestamps, GPU profiling disabled");
+            return;
+        }
+        validMask_ = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+        nsPerTick_ = static_cast<double>(caps.properties.limits.timestampPeriod);
+
+        VkQueryPoolCreateInfo info{};
+        info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+        info.queryCount = framesInFlight * MAX_SCOPES_PER_FRAME * 2;
+        if (vkCreateQueryPool(device_.device(), &info, device_.allocator(), &queryPool_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool");
+        }
+        readback_.resize(MAX_SCOPES_PER_FRAME * 2);
+
+        calibrate();
+    }
+
+    GpuProfiler::~GpuProfiler() {
+        if (queryPool_) vkDestroyQueryPool(device_.device(), queryPool_, device_.allocator());
+        if (statisticsPool_) vkDestroyQueryPool(device_.device(), statisticsPool_, device_.allocator());
+    }
+
+    void GpuProfiler::calibrate() {
+        // Without VK_EXT_calibrated_timestamps, align a single GPU timestamp with the CPU
+        // time at which its submission is known to have completed. This places GPU work
+        // at most one submission round trip late on the CPU timeline.
+        const VkCommandBuffer cmd = device_.beginSingleTimeCommands();
+        vkCmdResetQueryPool(cmd, queryPool_, 0, 1);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool_, 0);
+        device_.endSingleTimeCommands(cmd);
+        const uint64_t cpuNs = core::Profiler::now();
+
+        uint64_t ticks = 0;
+        if (vkGetQueryPoolResults(device_.device(), queryPool_, 0, 1, sizeof(ticks), &ticks, sizeof(ticks),
+                                  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+            const auto gpuNs = static_cast<int64_t>(static_cast<double>(ticks & validMask_) * nsPerTick_);
+            offsetNs_ = static_cast<int64_t>(cpuNs) - gpuNs;
+        }
+    }
+
+    void GpuProfiler::beginFrame(const VkCommandBuffer cmd, const uint32_t frameIndex, const uint64_t frameNumber) {
+        if (!enabled() && !statisticsEnabled()) return;
+        collect(frameIndex);
+
+        currentSlot_ = frameIndex;
+        slots_[frameIndex].names.clear();
+        slots_[frameIndex].statistics.clear();
+        slots_[frameIndex].frameNumber = frameNumber;
+        if (enabled()) {
+            vkCmdResetQueryPool(cmd, queryPool_, firstQuery(frameIndex), MAX_SCOPES_PER_FRAME * 2);
+        }
+        if (statisticsEnabled()) {
+            vkCmdResetQueryPool(cmd, statisticsPool_, frameIndex * MAX_STATISTICS_PER_FRAME, MAX_STATISTICS_PER_FRAME);
+        }
+        slots_[frameIndex].pending = true;
+    }
+
+    uint32_t GpuProfiler::beginScope(const VkCommandBuffer cmd, const char* name) {
+        auto& slot = slots_[currentSlot_];
+        if (!enabled() || slot.names.size() >= MAX_SCOPES_PER_FRAME) return UINT32_MAX;
+
+        const auto scope = static_cast<uint32_t>(slot.names.size());
+        slot.names.push_back(name);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool_,
+                            firstQuery(currentSlot_) + scope * 2);
+        return scope;
+    }
+
+    void GpuProfiler::endScope(const VkCommandBuffer cmd, const uint32_t scope) {
+        if (scope == UINT32_MAX) return;
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool_,
+                            firstQuery(currentSlot_) + scope * 2 + 1);
+    }
+
+    uint32_t GpuProfiler::beginStatistics(const VkCommandBuffer cmd, const char* name) {
+        auto& slot = slots_[currentSlot_];
+        // Only one query of a type may be active at a time.
+        if (!statisticsEnabled() || statisticsActive_ || slot.statistics.size() >= MAX_STATISTICS_PER_FRAME) {
+            return UINT32_MAX;
+        }
+
+        const auto query = static_cast<uint32_t>(slot.statistics.size());
+        slot.statistics.push_back(name);
+        vkCmdBeginQuery(cmd, statisticsPool_, currentSlot_ * MAX_STATISTICS_PER_FRAME + query, 0);
+        statisticsActive_ = true;
+        return query;
+    }
+
+    void GpuProfiler::endStatistics(const VkCommandBuffer cmd, const uint32_t query) {
+        if (query == UINT32_MAX) return;
+        vkCmdEndQuery(cmd, statisticsPool_, currentSlot_ * MAX_STATISTICS_PER_FRAME + query);
+        statisticsActive_ = false;
+    }
+
+    void GpuProfiler::collectStatistics(FrameSlot& slot, const uint32_t frameIndex) {
+        if (slot.statistics.empty()) return;
+
+        constexpr uint32_t VALUES = 3;   // one per bit in STATISTICS
+        const auto count = static_cast<uint32_t>(slot.statistics.size());
+        std::array<uint64_t, MAX_STATISTICS_PER_FRAME * VALUES> values{};
+        if (vkGetQueryPoolResults(device_.device(), statisticsPool_, frameIndex * MAX_STATISTICS_PER_FRAME, count,
+                                  count * VALUES * sizeof(uint64_t), values.data(), VALUES * sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return;
+        }
+
+        lastStatistics_.clear();
+        lastStatisticsFrame_ = slot.frameNumber;
+        for (uint32_t i = 0; i < count; ++i) {
+            lastStatistics_.push_back({
+                slot.statistics[i], values[i * VALUES], values[i * VALUES + 1], values[i * VALUES + 2] });
+        }
+    }
+
+    void GpuProfiler::collect(const uint32_t frameIndex) {
+        auto& slot = slots_[frameIndex];
+        if (!slot.pending) return;
+        slot.pending = false;
+        collectStatistics(slot, frameIndex);
+        if (slot.names.empty()) return;
+
+        const auto count = static_cast<uint32_t>(slot.names.size()) * 2;
+        if (vkGetQueryPoolResults(device_.device(), queryPool_, firstQuery(frameIndex), count,
+                                  count * sizeof(uint64_t), readback_.data(), sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return; // not ready: drop this frame rather than stall
+        }
+
+        auto toCpuNs = [this](const uint64_t ticks) {
+            const auto gpuNs = static_cast<int64_t>(static_cast<double>(ticks & validMask_) * nsPerTick_);
+            return static_cast<uint64_t>(std::max<int64_t>(0, gpuNs + offsetNs_));
+        };
+
+        lastResults_.clear();
+        uint64_t frameStart = UINT64_MAX;
+        uint64_t frameEnd   = 0;
+        for (size_t i = 0; i < slot.names.size(); ++i) {
+            const ScopeResult result{ slot.names[i], toCpuNs(readback_[i * 2]), toCpuNs(readback_[i * 2 + 1]) };
+            lastResults_.push_back(result);
+            frameStart = std::min(frameStart, result.start_ns);
+            frameEnd   = std::max(frameEnd, result.end_ns);
+#ifdef VKP_PROFILE_ENABLED
+            core::Profiler::get().recordGpu(result.name, result.start_ns, result.end_ns);
+#endif
+        }
+        lastFrameMs_     = static_cast<double>(frameEnd - frameStart) / 1e6;
+        lastFrameNumber_ = slot.frameNumber;
+    }
+
+} // namespace vkp::graphics
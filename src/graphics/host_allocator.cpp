@@ -0,0 +1,209 @@
+#include <vkp/graphics/host_allocator.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace vkp::graphics {
+
+    HostAllocator::HostAllocator() {
+        callbacks_.pUserData             = this;
+        callbacks_.pfnAllocation         = &HostAllocator::onAllocation;
+        callbacks_.pfnReallocation       = &HostAllocator::onReallocation;
+        callbacks_.pfnFree               = &HostAllocator::onFree;
+        callbacks_.pfnInternalAllocation = &HostAllocator::onInternalAllocation;
+        callbacks_.pfnInternalFree       = &HostAllocator::onInternalFree;
+    }
+
+    HostAllocator::~HostAllocator() {
+        for (auto& sizeClass : classes_) {
+            for (void* chunk : sizeClass.chunks) ::operator delete(chunk);
+        }
+    }
+
+    std::unique_ptr<HostAllocator> HostAllocator::fromEnvironment() {
+        const char* value = std::getenv("VKP_HOST_ALLOCATOR");
+        if (value == nullptr || *value == '\0' || std::strcmp(value, "0") == 0) return nullptr;
+        LOG_INFO("routing Vulkan host allocations through HostAllocator");
+        return std::make_unique<HostAllocator>();
+    }
+
+    void* HostAllocator::allocate(const size_t size, size_t alignment, const VkSystemAllocationScope scope) {
+        if (size == 0) return nullptr;
+        assert(std::has_single_bit(alignment) && "Vulkan alignments are powers of two");
+        alignment = std::max<size_t>(alignment, HEADER_SIZE);
+        const auto scopeIndex = static_cast<uint8_t>(scope);
+
+        // Pool blocks are HEADER_SIZE aligned, so the user pointer right after the header is too.
+        const bool poolable = isPoolableScope(scope)
+                           && alignment == HEADER_SIZE
+                           && size + HEADER_SIZE <= (size_t{ 1 } << (MIN_CLASS_SHIFT + CLASS_COUNT - 1));
+        if (poolable) {
+            size_t sizeClass = 0;
+            while ((size_t{ 1 } << (MIN_CLASS_SHIFT + sizeClass)) < size + HEADER_SIZE) ++sizeClass;
+            void* block = popBlock(sizeClass);
+            if (block == nullptr) return nullptr;
+            auto* header = static_cast<Header*>(block);
+            *header = { size, static_cast<uint32_t>(HEADER_SIZE), static_cast<uint8_t>(sizeClass), scopeIndex,
+                        static_cast<uint8_t>(std::countr_zero(HEADER_SIZE)) };
+            countAllocation(scopeIndex, size, true);
+            return static_cast<std::byte*>(block) + HEADER_SIZE;
+        }
+
+        // The header sits in the last HEADER_SIZE bytes of the padding in front of the user pointer.
+        const size_t offset = alignment;
+        void* block = ::operator new(size + offset, std::align_val_t{ alignment }, std::nothrow);
+        if (block == nullptr) return nullptr;
+        void* memory = static_cast<std::byte*>(block) + offset;
+        *headerOf(memory) = { size, static_cast<uint32_t>(offset), NO_CLASS, scopeIndex,
+                              static_cast<uint8_t>(std::countr_zero(alignment)) };
+        countAllocation(scopeIndex, size, false);
+        return memory;
+    }
+
+    void* HostAllocator::reallocate(void* original, const size_t size, const size_t alignment,
+                                    const VkSystemAllocationScope scope) {
+        if (original == nullptr) return allocate(size, alignment, scope);
+        if (size == 0) {
+            release(original);
+            return nullptr;
+        }
+
+        Header* header = headerOf(original);
+        // Stay in place when the block's size class still fits and the new scope is pooled too.
+        if (header->sizeClass != NO_CLASS && alignment <= HEADER_SIZE && isPoolableScope(scope)
+            && size + HEADER_SIZE <= (size_t{ 1 } << (MIN_CLASS_SHIFT + header->sizeClass))) {
+            // The bytes move to the new scope, which may differ from the one it was allocated in.
+            scopes_[header->scope].liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+            header->scope = static_cast<uint8_t>(scope);
+            header->size  = size;
+            addLiveBytes(header->scope, size);
+            return original;
+        }
+
+        void* memory = allocate(size, alignment, scope);
+        if (memory == nullptr) return nullptr;
+        std::memcpy(memory, original, std::min<size_t>(size, header->size));
+        release(original);
+        return memory;
+    }
+
+    void HostAllocator::release(void* memory) {
+        if (memory == nullptr) return;
+        const Header header = *headerOf(memory);
+        auto& stats = scopes_[header.scope];
+        stats.frees.fetch_add(1, std::memory_order_relaxed);
+        stats.liveBytes.fetch_sub(header.size, std::memory_order_relaxed);
+
+        void* block = static_cast<std::byte*>(memory) - header.offset;
+        if (header.sizeClass != NO_CLASS) {
+            pushBlock(header.sizeClass, block);
+        } else {
+            ::operator delete(block, std::align_val_t{ size_t{ 1 } << header.alignmentShift });
+        }
+    }
+
+    void* HostAllocator::popBlock(const size_t sizeClass) {
+        SizeClass& pool = classes_[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.freeList == nullptr) {
+            // Carve a new chunk into blocks and thread them onto the free list.
+            const size_t blockSize = size_t{ 1 } << (MIN_CLASS_SHIFT + sizeClass);
+            auto* chunk = static_cast<std::byte*>(::operator new(CHUNK_SIZE, std::nothrow));
+            if (chunk == nullptr) return nullptr;
+            pool.chunks.push_back(chunk);
+            reservedBytes_.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+            for (size_t offset = 0; offset + blockSize <= CHUNK_SIZE; offset += blockSize) {
+                *reinterpret_cast<void**>(chunk + offset) = pool.freeList;
+                pool.freeList = chunk + offset;
+            }
+        }
+        void* block = pool.freeList;
+        pool.freeList = *static_cast<void**>(block);
+        return block;
+    }
+
+    void HostAllocator::pushBlock(const size_t sizeClass, void* block) {
+        SizeClass& pool = classes_[sizeClass];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        *static_cast<void**>(block) = pool.freeList;
+        pool.freeList = block;
+    }
+
+    void HostAllocator::countAllocation(const uint8_t scope, const uint64_t size, const bool pooled) {
+        auto& stats = scopes_[scope];
+        stats.allocations.fetch_add(1, std::memory_order_relaxed);
+        if (pooled) stats.pooled.fetch_add(1, std::memory_order_relaxed);
+        addLiveBytes(scope, size);
+    }
+
+    void HostAllocator::addLiveBytes(const uint8_t scope, const uint64_t size) {
+        auto& stats = scopes_[scope];
+        const uint64_t live = stats.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        uint64_t peak = stats.peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !stats.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    bool HostAllocator::isPoolableScope(const VkSystemAllocationScope scope) {
+        return scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND || scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+    }
+
+    HostAllocator::Stats HostAllocator::stats() const {
+        Stats out;
+        for (size_t i = 0; i < SCOPE_COUNT; ++i) {
+            out.scopes[i].allocations = scopes_[i].allocations.load(std::memory_order_relaxed);
+            out.scopes[i].frees       = scopes_[i].frees.load(std::memory_order_relaxed);
+            out.scopes[i].liveBytes   = scopes_[i].liveBytes.load(std::memory_order_relaxed);
+            out.scopes[i].peakBytes   = scopes_[i].peakBytes.load(std::memory_order_relaxed);
+            out.scopes[i].pooled      = scopes_[i].pooled.load(std::memory_order_relaxed);
+        }
+        out.reservedBytes = reservedBytes_.load(std::memory_order_relaxed);
+        out.internalBytes = internalBytes_.load(std::memory_order_relaxed);
+        return out;
+    }
+
+    const char* HostAllocator::scopeName(const size_t scope) {
+        static constexpr const char* NAMES[SCOPE_COUNT] = { "command", "object", "cache", "device", "instance" };
+        return scope < SCOPE_COUNT ? NAMES[scope] : "unknown";
+    }
+
+    void HostAllocator::logDelta(const char* label, const Stats& before, const Stats& after) {
+        for (size_t i = 0; i < SCOPE_COUNT; ++i) {
+            const auto& a = before.scopes[i];
+            const auto& b = after.scopes[i];
+            if (b.allocations == a.allocations && b.frees == a.frees) continue;
+            LOG_INFO("host allocations {} [{}]: {} allocs ({} pooled), {} frees, live {} KiB, peak {} KiB",
+                     label, scopeName(i), b.allocations - a.allocations, b.pooled - a.pooled, b.frees - a.frees,
+                     b.liveBytes >> 10, b.peakBytes >> 10);
+        }
+    }
+
+    void* VKAPI_PTR HostAllocator::onAllocation(void* user, const size_t size, const size_t alignment,
+                                                const VkSystemAllocationScope scope) {
+        return static_cast<HostAllocator*>(user)->allocate(size, alignment, scope);
+    }
+
+    void* VKAPI_PTR HostAllocator::onReallocation(void* user, void* original, const size_t size,
+                                                  const size_t alignment, const VkSystemAllocationScope scope) {
+        return static_cast<HostAllocator*>(user)->reallocate(original, size, alignment, scope);
+    }
+
+    void VKAPI_PTR HostAllocator::onFree(void* user, void* memory) {
+        static_cast<HostAllocator*>(user)->release(memory);
+    }
+
+    void VKAPI_PTR HostAllocator::onInternalAllocation(void* user, const size_t size, VkInternalAllocationType,
+                                                       VkSystemAllocationScope) {
+        static_cast<HostAllocator*>(user)->internalBytes_.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void VKAPI_PTR HostAllocator::onInternalFree(void* user, const size_t size, VkInternalAllocationType,
+                                                 VkSystemAllocationScope) {
+        static_cast<HostAllocator*>(user)->internalBytes_.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+} // namespace vkp::graphics
@@ -0,0 +1,162 @@
+#include <vkp/graphics/ktx2.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace vkp::graphics {
+
+    namespace {
+        constexpr std::array<uint8_t, 12> IDENTIFIER = {
+            0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+        // Identifier, nine uint32 header fields, then the index: four uint32 and two uint64.
+        constexpr size_t HEADER_SIZE      = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+        constexpr size_t LEVEL_ENTRY_SIZE = 3 * 8;
+
+        struct FormatBlock {
+            uint32_t width, height, bytes;
+        };
+
+        bool in(const VkFormat format, const VkFormat first, const VkFormat last) {
+            return format >= first && format <= last;
+        }
+
+        // Block size of the colour formats a texture may come in; nullopt for depth, stencil,
+        // multi-planar and unknown formats.
+        std::optional<FormatBlock> formatBlock(const VkFormat f) {
+            if (f == VK_FORMAT_R4G4_UNORM_PACK8 || in(f, VK_FORMAT_R8_UNORM, VK_FORMAT_R8_SRGB)) return FormatBlock{ 1, 1, 1 };
+            if (in(f, VK_FORMAT_R4G4B4A4_UNORM_PACK16, VK_FORMAT_A1R5G5B5_UNORM_PACK16) ||
+                in(f, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8_SRGB) || in(f, VK_FORMAT_R16_UNORM, VK_FORMAT_R16_SFLOAT)) {
+                return FormatBlock{ 1, 1, 2 };
+            }
+            if (in(f, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_B8G8R8_SRGB)) return FormatBlock{ 1, 1, 3 };
+            if (in(f, VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_A2B10G10R10_SINT_PACK32) ||
+                in(f, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16_SFLOAT) ||
+                in(f, VK_FORMAT_R32_UINT, VK_FORMAT_R32_SFLOAT) ||
+                f == VK_FORMAT_B10G11R11_UFLOAT_PACK32 || f == VK_FORMAT_E5B9G9R9_UFLOAT_PACK32) {
+                return FormatBlock{ 1, 1, 4 };
+            }
+            if (in(f, VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16_SFLOAT)) return FormatBlock{ 1, 1, 6 };
+            if (in(f, VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT) ||
+                in(f, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32_SFLOAT) || in(f, VK_FORMAT_R64_UINT, VK_FORMAT_R64_SFLOAT)) {
+                return FormatBlock{ 1, 1, 8 };
+            }
+            if (in(f, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32_SFLOAT)) return FormatBlock{ 1, 1, 12 };
+            if (in(f, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_R32G32B32A32_SFLOAT) ||
+                in(f, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64_SFLOAT)) {
+                return FormatBlock{ 1, 1, 16 };
+            }
+            if (in(f, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64_SFLOAT)) return FormatBlock{ 1, 1, 24 };
+            if (in(f, VK_FORMAT_R64G64B64A64_UINT, VK_FORMAT_R64G64B64A64_SFLOAT)) return FormatBlock{ 1, 1, 32 };
+
+            // BC1 and BC4, ETC2 without alpha or with 1-bit alpha, and EAC R11 have 8-byte blocks.
+            if (in(f, VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK) ||
+                in(f, VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_SNORM_BLOCK) ||
+                in(f, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK) ||
+                in(f, VK_FORMAT_EAC_R11_UNORM_BLOCK, VK_FORMAT_EAC_R11_SNORM_BLOCK)) {
+                return FormatBlock{ 4, 4, 8 };
+            }
+            // BC2, BC3, BC5, BC6H and BC7; BC4 in between returned above.
+            if (in(f, VK_FORMAT_BC2_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK) ||
+                in(f, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK) ||
+                in(f, VK_FORMAT_EAC_R11G11_UNORM_BLOCK, VK_FORMAT_EAC_R11G11_SNORM_BLOCK)) {
+                return FormatBlock{ 4, 4, 16 };
+            }
+            // ASTC: 16-byte blocks, listed in UNORM/SRGB pairs.
+            if (in(f, VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_12x12_SRGB_BLOCK)) {
+                constexpr std::array<std::array<uint32_t, 2>, 14> ASTC_BLOCKS = { {
+                    { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 },
+                    { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 } } };
+                const auto& block = ASTC_BLOCKS[(f - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+                return FormatBlock{ block[0], block[1], 16 };
+            }
+            return std::nullopt;
+        }
+
+        // KTX2 is little-endian throughout.
+        template<typename T>
+        T read(const std::byte* data, const size_t offset) {
+            T value;
+            std::memcpy(&value, data + offset, sizeof(T));
+            return value;
+        }
+    }
+
+    uint32_t fullMipCount(const uint32_t width, const uint32_t height) {
+        return std::bit_width(std::max({ width, height, 1u }));
+    }
+
+    Ktx2Image parseKtx2(const std::byte* data, const size_t size) {
+        if (data == nullptr || size < HEADER_SIZE || std::memcmp(data, IDENTIFIER.data(), IDENTIFIER.size()) != 0) {
+            throw std::runtime_error("not a KTX2 file");
+        }
+
+        const auto format      = read<uint32_t>(data, 12);
+        const auto width       = read<uint32_t>(data, 20);
+        const auto height      = read<uint32_t>(data, 24);
+        const auto depth       = read<uint32_t>(data, 28);
+        const auto layers      = read<uint32_t>(data, 32);
+        const auto faces       = read<uint32_t>(data, 36);
+        const auto levelCount  = read<uint32_t>(data, 40);
+        const auto compression = read<uint32_t>(data, 44);
+
+        // VK_FORMAT_UNDEFINED marks Basis Universal payloads, which need a transcoder.
+        if (format == VK_FORMAT_UNDEFINED) {
+            throw std::runtime_error("KTX2 files with VK_FORMAT_UNDEFINED (Basis Universal) are not supported");
+        }
+        if (compression != 0) {
+            throw std::runtime_error("supercompressed KTX2 files are not supported (scheme " +
+                                     std::to_string(compression) + ")");
+        }
+        if (width == 0 || height == 0 || depth != 0 || layers > 1 || faces != 1) {
+            throw std::runtime_error("only single-layer 2D KTX2 textures are supported");
+        }
+        if (levelCount > fullMipCount(width, height)) {
+            throw std::runtime_error("KTX2 file has more mip levels than its size allows");
+        }
+        const auto block = formatBlock(static_cast<VkFormat>(format));
+        if (!block) {
+            throw std::runtime_error("KTX2 format " + std::to_string(format) + " is not a supported colour format");
+        }
+
+        Ktx2Image image;
+        image.format       = static_cast<VkFormat>(format);
+        image.blockWidth   = block->width;
+        image.blockHeight  = block->height;
+        image.blockBytes   = block->bytes;
+        image.width        = width;
+        image.height       = height;
+        image.generateMips = levelCount == 0;
+
+        const uint32_t stored = std::max(levelCount, 1u);
+        if (size < HEADER_SIZE + stored * LEVEL_ENTRY_SIZE) {
+            throw std::runtime_error("truncated KTX2 level index");
+        }
+        image.levels.resize(stored);
+        for (uint32_t i = 0; i < stored; ++i) {
+            const size_t entry = HEADER_SIZE + i * LEVEL_ENTRY_SIZE;
+            Ktx2Level& level = image.levels[i];
+            level.offset = read<uint64_t>(data, entry);
+            level.size   = read<uint64_t>(data, entry + 8);
+            level.width  = std::max(width >> i, 1u);
+            level.height = std::max(height >> i, 1u);
+            if (level.size == 0 || level.offset > size || level.size > size - level.offset) {
+                throw std::runtime_error("KTX2 mip level " + std::to_string(i) + " lies outside the file");
+            }
+            // The upload copies the whole level tightly packed, so it must hold every block.
+            const uint64_t blocks = ((uint64_t{ level.width } + block->width - 1) / block->width) *
+                                    ((uint64_t{ level.height } + block->height - 1) / block->height);
+            if (blocks > level.size / block->bytes) {
+                throw std::runtime_error("KTX2 mip level " + std::to_string(i) + " holds " +
+                                         std::to_string(level.size) + " bytes, its extent needs " +
+                                         std::to_string(blocks * block->bytes));
+            }
+        }
+        return image;
+    }
+
+} // namespace vkp::graphics
@@ -0,0 +1,158 @@
+#include <vkp/graphics/offscreen_target.h>
+
+#include <array>
+#include <stdexcept>
+
+namespace vkp::graphics {
+
+    OffscreenTarget::OffscreenTarget(
+        Device& device,
+        const VkExtent2D extent,
+        const VkFormat colorFormat,
+        const VkFormat depthFormat,
+        const bool dynamicRendering)
+        : device_(device)
+        , extent_(extent)
+        , colorFormat_(colorFormat)
+    {
+        createImage(colorFormat,
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                    VK_IMAGE_ASPECT_COLOR_BIT, colorImage_, colorMemory_, colorView_);
+        if (!dynamicRendering) {
+            createImage(depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                        VK_IMAGE_ASPECT_DEPTH_BIT, depthImage_, depthMemory_, depthView_);
+            createRenderPass(depthFormat);
+            createFramebuffer();
+        }
+    }
+
+    OffscreenTarget::~OffscreenTarget() {
+        const VkDevice dev = device_.device();
+        if (framebuffer_ != VK_NULL_HANDLE) vkDestroyFramebuffer(dev, framebuffer_, device_.allocator());
+        if (renderPass_ != VK_NULL_HANDLE) vkDestroyRenderPass(dev, renderPass_, device_.allocator());
+        if (depthImage_ != VK_NULL_HANDLE) {
+            vkDestroyImageView(dev, depthView_, device_.allocator());
+            vkDestroyImage(dev, depthImage_, device_.allocator());
+            device_.freeMemory(depthMemory_);
+        }
+        vkDestroyImageView(dev, colorView_, device_.allocator());
+        vkDestroyImage(dev, colorImage_, device_.allocator());
+        device_.freeMemory(colorMemory_);
+    }
+
+    void OffscreenTarget::createImage(
+        const VkFormat format,
+        const VkImageUsageFlags usage,
+        const VkImageAspectFlags aspect,
+        VkImage& image,
+        VkDeviceMemory& memory,
+        VkImageView& view) const
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+        imageInfo.extent        = { extent_.width, extent_.height, 1 };
+        imageInfo.mipLevels     = 1;
+        imageInfo.arrayLayers   = 1;
+        imageInfo.format        = format;
+        imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage         = usage;
+        imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        device_.createImageWithInfo(
+            imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory, MemoryCategory::RenderTarget);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image            = image;
+        viewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format           = format;
+        viewInfo.subresourceRange = { aspect, 0, 1, 0, 1 };
+        if (vkCreateImageView(device_.device(), &viewInfo, device_.allocator(), &view) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create offscreen image view");
+        }
+    }
+
+    void OffscreenTarget::createRenderPass(const VkFormat depthFormat) {
+        // Same formats and sample counts as SwapChain::createRenderPass, hence compatible.
+        VkAttachmentDescription color{};
+        color.format         = colorFormat_;
+        color.samples        = VK_SAMPLE_COUNT_1_BIT;
+        color.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+        color.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        color.finalLayout    = FINAL_LAYOUT;
+
+        VkAttachmentDescription depth{};
+        depth.format         = depthFormat;
+        depth.samples        = VK_SAMPLE_COUNT_1_BIT;
+        depth.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depth.storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depth.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        depth.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference colorRef{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        VkAttachmentReference depthRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount    = 1;
+        subpass.pColorAttachments       = &colorRef;
+        subpass.pDepthStencilAttachment = &depthRef;
+
+        // In: the previous frame's readback (copy or compute) must be done before the clear.
+        // Out: make the colour writes visible to the readback passes recorded after the pass.
+        std::array<VkSubpassDependency, 2> dependencies{};
+        dependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass    = 0;
+        dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                      | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask = 0;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                      | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        dependencies[1].srcSubpass    = 0;
+        dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        std::array<VkAttachmentDescription, 2> attachments = { color, depth };
+        VkRenderPassCreateInfo info{};
+        info.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        info.attachmentCount = static_cast<uint32_t>(attachments.size());
+        info.pAttachments    = attachments.data();
+        info.subpassCount    = 1;
+        info.pSubpasses      = &subpass;
+        info.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        info.pDependencies   = dependencies.data();
+
+        if (vkCreateRenderPass(device_.device(), &info, device_.allocator(), &renderPass_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create offscreen render pass");
+        }
+    }
+
+    void OffscreenTarget::createFramebuffer() {
+        std::array<VkImageView, 2> views = { colorView_, depthView_ };
+        VkFramebufferCreateInfo info{};
+        info.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        info.renderPass      = renderPass_;
+        info.attachmentCount = static_cast<uint32_t>(views.size());
+        info.pAttachments    = views.data();
+        info.width           = extent_.width;
+        info.height          = extent_.height;
+        info.layers          = 1;
+
+        if (vkCreateFramebuffer(device_.device(), &info, device_.allocator(), &framebuffer_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create offscreen framebuffer");
+        }
+    }
+
+} // namespace vkp::graphics
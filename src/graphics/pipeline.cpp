@@ -1,52 +1,82 @@
 #include <vkp/graphics/pipeline.h>
+#include <vkp/core/hitch_detector.h>
+#include <vkp/core/metrics.h>
 
 #include <cassert>
-#include <fstream>
 #include <stdexcept>
 
 namespace vkp::graphics {
 
     Pipeline::Pipeline(
         Device& device,
-        const std::string& vertFilepath,
-        const std::string& fragFilepath,
+        const ShaderPermutation& vert,
+        const ShaderPermutation& frag,
+        const PipelineConfigInfo& configInfo)
+      : Pipeline(device, loadShaderModules(device, vert, frag), configInfo)
+    {
+    }
+
+    Pipeline::Pipeline(
+        Device& device,
+        const ShaderModules& modules,
         const PipelineConfigInfo& configInfo)
       : device{device}
+      , vertShaderModule{modules.vert}
+      , fragShaderModule{modules.frag}
     {
-        createGraphicsPipeline(vertFilepath, fragFilepath, configInfo);
+        try {
+            createGraphicsPipeline(configInfo);
+        } catch (...) {
+            // The destructor doesn't run for a constructor that throws.
+            vkDestroyShaderModule(device.device(), vertShaderModule, device.allocator());
+            vkDestroyShaderModule(device.device(), fragShaderModule, device.allocator());
+            throw;
+        }
     }
 
     Pipeline::~Pipeline() {
-        if (vertShaderModule) vkDestroyShaderModule(device.device(), vertShaderModule, nullptr);
-        if (fragShaderModule) vkDestroyShaderModule(device.device(), fragShaderModule, nullptr);
-        if (graphicsPipeline) vkDestroyPipeline(device.device(), graphicsPipeline, nullptr);
+        if (vertShaderModule) vkDestroyShaderModule(device.device(), vertShaderModule, device.allocator());
+        if (fragShaderModule) vkDestroyShaderModule(device.device(), fragShaderModule, device.allocator());
+        if (graphicsPipeline) vkDestroyPipeline(device.device(), graphicsPipeline, device.allocator());
     }
 
-    std::vector<char> Pipeline::readFile(const std::string& filepath) {
-        std::ifstream file{filepath, std::ios::ate | std::ios::binary};
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file: " + filepath);
+    ShaderModules Pipeline::loadShaderModules(
+        const Device& device,
+        const ShaderPermutation& vert,
+        const ShaderPermutation& frag)
+    {
+        const ShaderPermutation stages[] = { vert, frag };
+        const auto code = ShaderCompiler::get().compile(stages);
+        return createShaderModules(device, code[0], code[1]);
+    }
+
+    ShaderModules Pipeline::createShaderModules(
+        const Device& device,
+        const std::vector<uint32_t>& vert,
+        const std::vector<uint32_t>& frag)
+    {
+        ShaderModules modules{};
+        createShaderModule(device, vert, &modules.vert);
+        try {
+            createShaderModule(device, frag, &modules.frag);
+        } catch (...) {
+            vkDestroyShaderModule(device.device(), modules.vert, device.allocator());
+            throw;
         }
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(fileSize);
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        return buffer;
+        return modules;
     }
 
-    void Pipeline::createGraphicsPipeline(
-        const std::string& vertFilepath,
-        const std::string& fragFilepath,
-        const PipelineConfigInfo& configInfo)
+    VkShaderModule Pipeline::loadShaderModule(const Device& device, const ShaderPermutation& shader) {
+        VkShaderModule module = VK_NULL_HANDLE;
+        createShaderModule(device, ShaderCompiler::get().compile(shader), &module);
+        return module;
+    }
+
+    void Pipeline::createGraphicsPipeline(const PipelineConfigInfo& configInfo)
     {
         assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "No pipelineLayout in config");
-        assert(configInfo.renderPass     != VK_NULL_HANDLE && "No renderPass in config");
-
-        // --- load & compile shaders ---
-        auto vertCode = readFile(vertFilepath);
-        auto fragCode = readFile(fragFilepath);
-        createShaderModule(vertCode, &vertShaderModule);
-        createShaderModule(fragCode, &fragShaderModule);
+        assert((configInfo.renderPass != VK_NULL_HANDLE || configInfo.colorAttachmentFormat != VK_FORMAT_UNDEFINED)
+               && "No renderPass or attachment formats in config");
 
         VkPipelineShaderStageCreateInfo shaderStages[2]{};
         shaderStages[0].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -81,26 +111,42 @@ namespace vkp::graphics {
         pipelineInfo.renderPass = configInfo.renderPass;
         pipelineInfo.subpass    = configInfo.subpass;
 
+        // Without a render pass the attachment formats are declared up front instead.
+        VkPipelineRenderingCreateInfo renderingInfo{};
+        if (configInfo.renderPass == VK_NULL_HANDLE) {
+            renderingInfo.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+            renderingInfo.colorAttachmentCount    = 1;
+            renderingInfo.pColorAttachmentFormats = &configInfo.colorAttachmentFormat;
+            renderingInfo.depthAttachmentFormat   = configInfo.depthAttachmentFormat;
+            pipelineInfo.pNext   = &renderingInfo;
+            pipelineInfo.subpass = 0;
+        }
+
+        core::HitchDetector::get().note(core::HitchDetector::PipelineCreate);
+        static auto& compilations = core::MetricsRegistry::get().counter(
+            "vkp_pipeline_compilations_total", "Graphics pipelines created");
+        compilations.inc();
         if (vkCreateGraphicsPipelines(
               device.device(),
               VK_NULL_HANDLE,
               1,
               &pipelineInfo,
-              nullptr,
+              device.allocator(),
               &graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics pipeline");
         }
     }
 
     void Pipeline::createShaderModule(
-        const std::vector<char>& code,
-        VkShaderModule* shaderModule) const
+        const Device& device,
+        const std::vector<uint32_t>& code,
+        VkShaderModule* shaderModule)
     {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode    = reinterpret_cast<const uint32_t*>(code.data());
-        if (vkCreateShaderModule(device.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
+        createInfo.codeSize = code.size() * sizeof(uint32_t);
+        createInfo.pCode    = code.data();
+        if (vkCreateShaderModule(device.device(), &createInfo, device.allocator(), shaderModule) != VK_SUCCESS) {
             throw std::runtime_error("failed to create shader module");
         }
     }
@@ -0,0 +1,579 @@
+#include <vkp/graphics/render_graph.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vkp::graphics {
+
+    namespace {
+        // Layout, stages and access of one usage. Usages without write access can only be read.
+        struct UsageState {
+            VkImageLayout        layout;
+            VkPipelineStageFlags stages;
+            VkAccessFlags        readAccess;
+            VkAccessFlags        writeAccess;
+            VkImageUsageFlags    imageUsage;
+        };
+
+        UsageState usageState(const ResourceUsage usage) {
+            switch (usage) {
+            case ResourceUsage::ColorAttachment:
+                return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                         VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+            case ResourceUsage::DepthAttachment:
+                return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT };
+            case ResourceUsage::SampledFragment:
+                return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_USAGE_SAMPLED_BIT };
+            case ResourceUsage::SampledCompute:
+                return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_USAGE_SAMPLED_BIT };
+            case ResourceUsage::StorageCompute:
+                return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT };
+            case ResourceUsage::TransferSrc:
+                return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_ACCESS_TRANSFER_READ_BIT, 0, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+            case ResourceUsage::TransferDst:
+                return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+            case ResourceUsage::VertexInput:
+                return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                         VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, 0, 0 };
+            }
+            return {};
+        }
+
+        bool isDepthFormat(const VkFormat format) {
+            switch (format) {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_D32_SFLOAT:
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool hasStencil(const VkFormat format) {
+            return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT
+                || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+        }
+
+        // Only sizes transients when the graph plans without a device.
+        VkDeviceSize texelBytes(const VkFormat format) {
+            switch (format) {
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return 8;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                return 16;
+            case VK_FORMAT_D16_UNORM:
+                return 2;
+            default:
+                return 4;
+            }
+        }
+
+        // Barriers cover every aspect of the image; views of depth formats only the depth aspect.
+        VkImageAspectFlags barrierAspect(const VkFormat format) {
+            if (!isDepthFormat(format)) return VK_IMAGE_ASPECT_COLOR_BIT;
+            return hasStencil(format) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT
+                                      : VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+    }
+
+    void PassBuilder::read(const ResourceId resource, const ResourceUsage usage) {
+        graph_.addAccess(pass_, resource, usage, true, false);
+    }
+
+    void PassBuilder::write(const ResourceId resource, const ResourceUsage usage) {
+        graph_.addAccess(pass_, resource, usage, false, true);
+    }
+
+    void PassBuilder::colorAttachment(const ResourceId resource, const std::optional<VkClearColorValue> clear) {
+        graph_.addAccess(pass_, resource, ResourceUsage::ColorAttachment, !clear.has_value(), true);
+        RenderGraph::Attachment attachment{ resource, clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD, {} };
+        if (clear) attachment.clear.color = *clear;
+        graph_.passes_[pass_].colorAttachments.push_back(attachment);
+    }
+
+    void PassBuilder::depthAttachment(const ResourceId resource, const std::optional<float> clear) {
+        graph_.addAccess(pass_, resource, ResourceUsage::DepthAttachment, !clear.has_value(), true);
+        RenderGraph::Attachment attachment{ resource, clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD, {} };
+        if (clear) attachment.clear.depthStencil = { *clear, 0 };
+        graph_.passes_[pass_].depthAttachment = attachment;
+    }
+
+    void PassBuilder::sideEffects() {
+        graph_.passes_[pass_].sideEffects = true;
+    }
+
+    RenderGraph::RenderGraph(Device& device) : device_(&device) {}
+
+    RenderGraph::RenderGraph() : device_(nullptr) {}
+
+    RenderGraph::~RenderGraph() {
+        releaseTransients();
+    }
+
+    ResourceId RenderGraph::createImage(const std::string& name, const TransientImageDesc& desc) {
+        Resource resource;
+        resource.name   = name;
+        resource.format = desc.format;
+        resource.extent = desc.extent;
+        resources_.push_back(std::move(resource));
+        return static_cast<ResourceId>(resources_.size() - 1);
+    }
+
+    ResourceId RenderGraph::importImage(const std::string& name, const ImportedImage& image) {
+        Resource resource;
+        resource.name     = name;
+        resource.imported = true;
+        resource.image    = image.image;
+        resource.view     = image.view;
+        resource.format   = image.format;
+        resource.extent   = image.extent;
+        resource.import   = image;
+        resources_.push_back(std::move(resource));
+        return static_cast<ResourceId>(resources_.size() - 1);
+    }
+
+    ResourceId RenderGraph::importBuffer(const std::string& name, const VkBuffer buffer) {
+        Resource resource;
+        resource.name     = name;
+        resource.isImage  = false;
+        resource.imported = true;
+        resource.buffer   = buffer;
+        resources_.push_back(std::move(resource));
+        return static_cast<ResourceId>(resources_.size() - 1);
+    }
+
+    void RenderGraph::bindImage(const ResourceId resource, const VkImage image, const VkImageView view) {
+        auto& r = resources_[resource];
+        if (!r.imported) throw std::runtime_error("render graph: only imported images can be rebound");
+        r.image = image;
+        r.view  = view;
+    }
+
+    void RenderGraph::addPass(
+        const std::string& name, const std::function<void(PassBuilder&)>& setup, ExecuteFn execute)
+    {
+        Pass pass;
+        pass.name    = name;
+        pass.execute = std::move(execute);
+        passes_.push_back(std::move(pass));
+        PassBuilder builder(*this, static_cast<uint32_t>(passes_.size() - 1));
+        setup(builder);
+    }
+
+    void RenderGraph::addAccess(
+        const uint32_t pass, const ResourceId resource, const ResourceUsage usage, const bool read, const bool write)
+    {
+        Pass& p = passes_[pass];
+        const Resource& r = resources_[resource];
+        const UsageState state = usageState(usage);
+        if (write && state.writeAccess == 0) {
+            throw std::runtime_error("render graph: pass '" + p.name + "' writes read-only usage of '" + r.name + "'");
+        }
+        const bool bufferUsage = usage == ResourceUsage::StorageCompute || usage == ResourceUsage::TransferSrc
+                              || usage == ResourceUsage::TransferDst || usage == ResourceUsage::VertexInput;
+        if (r.isImage ? usage == ResourceUsage::VertexInput : !bufferUsage) {
+            throw std::runtime_error("render graph: pass '" + p.name + "' can't use '" + r.name + "' that way");
+        }
+        for (auto& access : p.accesses) {
+            if (access.resource != resource) continue;
+            // One layout per resource and pass; reading and writing the same usage is a read-modify-write.
+            if (access.usage != usage) {
+                throw std::runtime_error("render graph: pass '" + p.name + "' uses '" + r.name + "' in two ways");
+            }
+            access.read  |= read;
+            access.write |= write;
+            return;
+        }
+        p.accesses.push_back({ resource, usage, read, write });
+    }
+
+    bool RenderGraph::culled(const std::string& pass) const {
+        for (const auto& p : passes_) {
+            if (p.name == pass) return p.culled;
+        }
+        return false;
+    }
+
+    const RenderGraph::Barrier& RenderGraph::barrierBefore(const std::string& pass) const {
+        for (const auto& p : passes_) {
+            if (p.name == pass) return p.before;
+        }
+        throw std::runtime_error("render graph: no pass '" + pass + "'");
+    }
+
+    void RenderGraph::compile() {
+        releaseTransients();
+        stats_ = {};
+        for (auto& r : resources_) {
+            r.usage    = 0;
+            r.firstUse = -1;
+            r.lastUse  = -1;
+            r.block    = -1;
+        }
+        for (const auto& p : passes_) {
+            if ((!p.colorAttachments.empty() || p.depthAttachment) && device_ && !device_->supportsDynamicRendering()) {
+                throw std::runtime_error("render graph: pass '" + p.name + "' needs dynamic rendering");
+            }
+        }
+
+        cull();
+        allocateTransients();
+        planBarriers();
+
+        stats_.passes = static_cast<uint32_t>(passes_.size());
+        stats_.barriers = static_cast<uint32_t>(std::count_if(
+            passes_.begin(), passes_.end(), [](const Pass& p) { return !p.culled && !p.before.empty(); }));
+        if (!after_.empty()) ++stats_.barriers;
+    }
+
+    void RenderGraph::cull() {
+        // Imported resources are visible outside the graph, so writing them keeps a pass alive;
+        // walking backwards, the reads of live passes keep their producers alive in turn.
+        std::vector<bool> needed(resources_.size());
+        for (size_t i = 0; i < resources_.size(); ++i) needed[i] = resources_[i].imported;
+
+        for (auto it = passes_.rbegin(); it != passes_.rend(); ++it) {
+            bool live = it->sideEffects;
+            for (const auto& access : it->accesses) {
+                if (access.write && needed[access.resource]) live = true;
+            }
+            it->culled = !live;
+            if (!live) {
+                ++stats_.culledPasses;
+                LOG_DEBUG("render graph: culled pass '{}'", it->name);
+                continue;
+            }
+            for (const auto& access : it->accesses) {
+                if (access.read) needed[access.resource] = true;
+            }
+        }
+
+        order_.clear();
+        for (uint32_t i = 0; i < passes_.size(); ++i) {
+            if (passes_[i].culled) continue;
+            const int position = static_cast<int>(order_.size());
+            for (const auto& access : passes_[i].accesses) {
+                auto& r = resources_[access.resource];
+                if (r.firstUse < 0) r.firstUse = position;
+                r.lastUse = position;
+                r.usage |= usageState(access.usage).imageUsage;
+            }
+            order_.push_back(i);
+        }
+
+        // Attachments no later pass reads are not written back to memory, e.g. a transient depth buffer.
+        for (size_t position = 0; position < order_.size(); ++position) {
+            Pass& pass = passes_[order_[position]];
+            auto storeOp = [&](Attachment& attachment) {
+                const auto& r = resources_[attachment.resource];
+                attachment.storeOp = r.imported || r.lastUse > static_cast<int>(position)
+                                   ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            };
+            for (auto& attachment : pass.colorAttachments) storeOp(attachment);
+            if (pass.depthAttachment) storeOp(*pass.depthAttachment);
+        }
+    }
+
+    void RenderGraph::allocateTransients() {
+        std::vector<ResourceId> transients;
+        std::vector<VkMemoryRequirements> requirements(resources_.size());
+        for (ResourceId id = 0; id < resources_.size(); ++id) {
+            auto& r = resources_[id];
+            if (r.imported || r.firstUse < 0) continue;
+            if (!device_) {
+                requirements[id] = { static_cast<VkDeviceSize>(r.extent.width) * r.extent.height * texelBytes(r.format), 1, ~0u };
+                stats_.transientBytes += requirements[id].size;
+                transients.push_back(id);
+                continue;
+            }
+            const VkDevice dev = device_->device();
+
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+            imageInfo.extent        = { r.extent.width, r.extent.height, 1 };
+            imageInfo.mipLevels     = 1;
+            imageInfo.arrayLayers   = 1;
+            imageInfo.format        = r.format;
+            imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage         = r.usage;
+            imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+            if (vkCreateImage(dev, &imageInfo, device_->allocator(), &r.image) != VK_SUCCESS) {
+                throw std::runtime_error("render graph: failed to create image '" + r.name + "'");
+            }
+            vkGetImageMemoryRequirements(dev, r.image, &requirements[id]);
+            stats_.transientBytes += requirements[id].size;
+            transients.push_back(id);
+        }
+
+        // Greedy interval packing: an image moves into the first block whose occupants are all done
+        // before it is first used. Blocks grow to the largest occupant.
+        std::stable_sort(transients.begin(), transients.end(), [this](const ResourceId a, const ResourceId b) {
+            return resources_[a].firstUse < resources_[b].firstUse;
+        });
+        for (const ResourceId id : transients) {
+            auto& r = resources_[id];
+            const auto& req = requirements[id];
+            for (size_t b = 0; b < blocks_.size() && r.block < 0; ++b) {
+                auto& block = blocks_[b];
+                if (block.lastUse >= r.firstUse) continue;
+                if ((block.requirements.memoryTypeBits & req.memoryTypeBits) == 0) continue;
+                block.requirements.size           = std::max(block.requirements.size, req.size);
+                block.requirements.alignment      = std::max(block.requirements.alignment, req.alignment);
+                block.requirements.memoryTypeBits &= req.memoryTypeBits;
+                block.lastUse = r.lastUse;
+                r.block = static_cast<int>(b);
+            }
+            if (r.block < 0) {
+                blocks_.push_back({ req, r.lastUse, VK_NULL_HANDLE });
+                r.block = static_cast<int>(blocks_.size() - 1);
+            }
+        }
+
+        stats_.transientImages = static_cast<uint32_t>(transients.size());
+        stats_.memoryBlocks    = static_cast<uint32_t>(blocks_.size());
+        for (const auto& block : blocks_) stats_.allocatedBytes += block.requirements.size;
+        if (!device_) return;
+
+        const VkDevice dev = device_->device();
+        for (auto& block : blocks_) {
+            block.memory = device_->allocateMemory(
+                block.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::RenderTarget);
+        }
+        for (const ResourceId id : transients) {
+            auto& r = resources_[id];
+            if (vkBindImageMemory(dev, r.image, blocks_[r.block].memory, 0) != VK_SUCCESS) {
+                throw std::runtime_error("render graph: failed to bind image '" + r.name + "'");
+            }
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image            = r.image;
+            viewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format           = r.format;
+            viewInfo.subresourceRange = {
+                isDepthFormat(r.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+            if (vkCreateImageView(dev, &viewInfo, device_->allocator(), &r.view) != VK_SUCCESS) {
+                throw std::runtime_error("render graph: failed to create view of '" + r.name + "'");
+            }
+        }
+    }
+
+    void RenderGraph::planBarriers() {
+        // Where each resource was last written and read, replayed over the execution order.
+        struct State {
+            VkImageLayout        layout        = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags writeStages   = 0;
+            VkAccessFlags        writeAccess   = 0;
+            VkPipelineStageFlags readStages    = 0;
+            VkPipelineStageFlags visibleStages = 0;   // readers the last write was made visible to
+        };
+
+        // A transient starts where any occupant of its block, this frame or the previous one, may
+        // still be using the memory; its contents are discarded.
+        std::vector<VkPipelineStageFlags> blockStages(blocks_.size());
+        std::vector<VkAccessFlags>        blockWrites(blocks_.size());
+        for (const uint32_t index : order_) {
+            for (const auto& access : passes_[index].accesses) {
+                const auto& r = resources_[access.resource];
+                if (r.block < 0) continue;
+                const UsageState usage = usageState(access.usage);
+                blockStages[r.block] |= usage.stages;
+                if (access.write) blockWrites[r.block] |= usage.writeAccess;
+            }
+        }
+
+        std::vector<State> states(resources_.size());
+        for (size_t i = 0; i < resources_.size(); ++i) {
+            const auto& r = resources_[i];
+            if (r.imported && r.isImage) {
+                states[i].layout      = r.import.initialLayout;
+                states[i].writeStages = r.import.initialStages;
+                states[i].writeAccess = r.import.initialAccess;
+            } else if (r.block >= 0) {
+                states[i].writeStages = blockStages[r.block];
+                states[i].writeAccess = blockWrites[r.block];
+            }
+        }
+
+        for (auto& pass : passes_) pass.before = {};
+        for (const uint32_t index : order_) {
+            Pass& pass = passes_[index];
+            for (const auto& access : pass.accesses) {
+                const auto& r = resources_[access.resource];
+                State& state = states[access.resource];
+                const UsageState usage = usageState(access.usage);
+                const VkAccessFlags dstAccess = (access.read ? usage.readAccess : 0)
+                                              | (access.write ? usage.writeAccess : 0);
+                const bool layoutChange = r.isImage && state.layout != usage.layout;
+
+                bool                 needed;
+                VkPipelineStageFlags srcStages;
+                if (layoutChange || access.write) {
+                    // Layout transitions write the image, so they wait for earlier readers as well.
+                    srcStages = state.writeStages | state.readStages;
+                    needed    = layoutChange || srcStages != 0;
+                } else {
+                    srcStages = state.writeStages;
+                    needed    = state.writeAccess != 0 && (usage.stages & ~state.visibleStages) != 0;
+                }
+
+                if (needed) {
+                    Barrier& barrier = pass.before;
+                    barrier.srcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                    barrier.dstStages |= usage.stages;
+                    if (r.isImage) {
+                        // Cleared attachments and transients don't need their old contents.
+                        const bool discard = access.write && !access.read;
+                        barrier.images.push_back({
+                            access.resource, barrierAspect(r.format),
+                            discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout, usage.layout,
+                            state.writeAccess, dstAccess });
+                    } else {
+                        barrier.memorySrcAccess |= state.writeAccess;
+                        barrier.memoryDstAccess |= dstAccess;
+                    }
+                }
+
+                if (r.isImage) state.layout = usage.layout;
+                if (access.write) {
+                    state.writeStages   = usage.stages;
+                    state.writeAccess   = usage.writeAccess;
+                    state.readStages    = 0;
+                    state.visibleStages = 0;
+                } else {
+                    state.readStages |= usage.stages;
+                    if (needed) state.visibleStages |= usage.stages;
+                }
+            }
+        }
+
+        after_ = {};
+        for (ResourceId id = 0; id < resources_.size(); ++id) {
+            const auto& r = resources_[id];
+            const State& state = states[id];
+            if (!r.imported || !r.isImage || r.firstUse < 0) continue;
+            if (r.import.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED) continue;
+            if (state.layout == r.import.finalLayout && state.writeAccess == 0) continue;
+            const VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+            after_.srcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            after_.dstStages |= r.import.finalStages;
+            after_.images.push_back({
+                id, barrierAspect(r.format), state.layout, r.import.finalLayout,
+                state.writeAccess, r.import.finalAccess });
+        }
+    }
+
+    void RenderGraph::recordBarrier(const VkCommandBuffer cmd, const Barrier& barrier) const {
+        if (barrier.empty()) return;
+        std::vector<VkImageMemoryBarrier> images;
+        images.reserve(barrier.images.size());
+        for (const auto& planned : barrier.images) {
+            VkImageMemoryBarrier image{};
+            image.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            image.srcAccessMask       = planned.srcAccess;
+            image.dstAccessMask       = planned.dstAccess;
+            image.oldLayout           = planned.oldLayout;
+            image.newLayout           = planned.newLayout;
+            image.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            image.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            image.image               = resources_[planned.resource].image;
+            image.subresourceRange    = { planned.aspect, 0, 1, 0, 1 };
+            images.push_back(image);
+        }
+        VkMemoryBarrier memory{};
+        memory.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memory.srcAccessMask = barrier.memorySrcAccess;
+        memory.dstAccessMask = barrier.memoryDstAccess;
+        const bool global = barrier.memorySrcAccess != 0 || barrier.memoryDstAccess != 0;
+        vkCmdPipelineBarrier(
+            cmd, barrier.srcStages, barrier.dstStages, 0,
+            global ? 1 : 0, global ? &memory : nullptr,
+            0, nullptr,
+            static_cast<uint32_t>(images.size()), images.data());
+    }
+
+    void RenderGraph::execute(const VkCommandBuffer cmd) const {
+        if (!device_) throw std::runtime_error("render graph: a graph without a device can't be executed");
+        for (const uint32_t index : order_) {
+            const Pass& pass = passes_[index];
+            recordBarrier(cmd, pass.before);
+
+            const bool rendering = !pass.colorAttachments.empty() || pass.depthAttachment.has_value();
+            if (!rendering) {
+                pass.execute(cmd, *this);
+                continue;
+            }
+
+            std::vector<VkRenderingAttachmentInfo> colors;
+            VkExtent2D extent{};
+            for (const auto& attachment : pass.colorAttachments) {
+                VkRenderingAttachmentInfo info{};
+                info.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+                info.imageView   = resources_[attachment.resource].view;
+                info.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                info.loadOp      = attachment.loadOp;
+                info.storeOp     = attachment.storeOp;
+                info.clearValue  = attachment.clear;
+                colors.push_back(info);
+                extent = resources_[attachment.resource].extent;
+            }
+            VkRenderingAttachmentInfo depth{};
+            if (pass.depthAttachment) {
+                const auto& r = resources_[pass.depthAttachment->resource];
+                depth.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+                depth.imageView   = r.view;
+                depth.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+                depth.loadOp      = pass.depthAttachment->loadOp;
+                depth.storeOp     = pass.depthAttachment->storeOp;
+                depth.clearValue  = pass.depthAttachment->clear;
+                if (colors.empty()) extent = r.extent;
+            }
+
+            VkRenderingInfo info{};
+            info.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO;
+            info.renderArea           = { { 0, 0 }, extent };
+            info.layerCount           = 1;
+            info.colorAttachmentCount = static_cast<uint32_t>(colors.size());
+            info.pColorAttachments    = colors.data();
+            info.pDepthAttachment     = pass.depthAttachment ? &depth : nullptr;
+            device_->cmdBeginRendering(cmd, info);
+            pass.execute(cmd, *this);
+            device_->cmdEndRendering(cmd);
+        }
+        recordBarrier(cmd, after_);
+    }
+
+    void RenderGraph::releaseTransients() {
+        if (!device_) {
+            blocks_.clear();
+            return;
+        }
+        const VkDevice dev = device_->device();
+        for (auto& r : resources_) {
+            if (r.imported) continue;
+            if (r.view != VK_NULL_HANDLE) vkDestroyImageView(dev, r.view, device_->allocator());
+            if (r.image != VK_NULL_HANDLE) vkDestroyImage(dev, r.image, device_->allocator());
+            r.view  = VK_NULL_HANDLE;
+            r.image = VK_NULL_HANDLE;
+        }
+        for (const auto& block : blocks_) device_->freeMemory(block.memory);
+        blocks_.clear();
+    }
+
+} // namespace vkp::graphics
@@ -0,0 +1,16 @@
+#include <vkp/graphics/render_host.h>
+
+namespace vkp::graphics {
+
+    RenderHost::~RenderHost() {
+        // The renderer idled the device when it shut down, but a failed init may not have.
+        vkDeviceWaitIdle(device_.device());
+        swapChain_.reset();
+    }
+
+    bool RenderHost::reloadRequested() {
+        if (!reloadRequested_ && reloadCheck_) reloadRequested_ = reloadCheck_();
+        return reloadRequested_;
+    }
+
+} // namespace vkp::graphics
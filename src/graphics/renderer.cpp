@@ -1,21 +1,78 @@
 #include <vkp/graphics/renderer.h>
+#include <vkp/graphics/renderer_module.h>
+#include <vkp/core/hitch_detector.h>
+#include <vkp/core/job_system.h>
+#include <vkp/core/metrics.h>
+#include <vkp/core/profiler.h>
+#include <vkp/core/startup_profiler.h>
 #include <vkp/logger.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <exception>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace vkp::graphics {
 
-    // Must match GLSL layout: vec2 + float, padded to 16 bytes.
+    // Must match GLSL layout in scene.glsl: vec2 + float + uint, 16 bytes.
     struct PushConstants {
         glm::vec2 resolution;
         float     time;
+        uint32_t  sparse;
     };
 
-    Renderer::Renderer() = default;
+    static constexpr auto VERT_SHADER_PATH = "shaders/sb_shader.vert";
+    static constexpr auto FRAG_SHADER_PATH = "shaders/sb_shader.frag";
+
+    // The scene marching the distance volume baked by sdf_bake.comp instead of the analytic SDF.
+    static ShaderPermutation bakedFragShader() {
+        return { FRAG_SHADER_PATH, { { "SCENE_BAKED_SDF", "" } } };
+    }
+
+    // Heap usage is polled at this interval. Crossing the warn fraction of a heap's budget logs a
+    // warning; it re-arms once usage drops below the clear fraction.
+    static constexpr uint64_t MEMORY_POLL_NS        = 500'000'000;
+    static constexpr double   MEMORY_WARN_FRACTION  = 0.9;
+    static constexpr double   MEMORY_CLEAR_FRACTION = 0.8;
+
+    namespace {
+        // Registered once; the frame loop only does atomic updates on these.
+        struct FrameMetrics {
+            core::Counter&   frames = core::MetricsRegistry::get().counter(
+                "vkp_frames_rendered_total", "Frames submitted to the GPU");
+            core::Counter&   swapchainRecreations = core::MetricsRegistry::get().counter(
+                "vkp_swapchain_recreations_total", "Swap chain recreations");
+            core::Histogram& frameTime = core::MetricsRegistry::get().histogram(
+                "vkp_frame_time_ms", "Interval between frame starts in milliseconds",
+                { 4, 8, 12, 16.67, 20, 25, 33.3, 50, 66.7, 100, 250 });
+            core::Gauge&     memoryUsage = core::MetricsRegistry::get().gauge(
+                "vkp_gpu_memory_usage_bytes", "Device-local heap usage reported by the driver");
+            core::Gauge&     memoryBudget = core::MetricsRegistry::get().gauge(
+                "vkp_gpu_memory_budget_bytes", "Device-local heap budget reported by the driver");
+            core::Histogram& gpuTime = core::MetricsRegistry::get().histogram(
+                "vkp_gpu_frame_time_ms", "GPU time of the frame scope in milliseconds",
+                { 1, 2, 4, 8, 12, 16.67, 25, 33.3, 50, 100 });
+        };
+
+        FrameMetrics& frameMetrics() {
+            static FrameMetrics metrics;
+            return metrics;
+        }
+
+    }
+
+    Renderer::Renderer(RenderHost& host)
+        : host_(host)
+        , window(host.window())
+        , device(host.device())
+        , swapChain(host.swapChain()) {}
 
     Renderer::~Renderer() {
         shutdown();
@@ -24,30 +81,313 @@ namespace vkp::graphics {
     bool Renderer::init(const renderer_conf& config) {
         width_     = config.start_width;
         height_    = config.start_height;
+        const uint32_t videoFps = std::max(config.video_fps, 1u);
+        const bool     offscreen = config.offscreen_frames > 0;
+        sequence_.startTime  = config.sequence_start;
+        sequence_.frameCount = config.offscreen_frames;
+        sequence_.timeStep   = config.sequence_step > 0.0 ? config.sequence_step : 1.0 / videoFps;
+        // Readback rings and GPU queries are sized to whichever loop runs.
+        const uint32_t framesInFlight = offscreen ? SequenceRenderer::FRAMES_IN_FLIGHT
+                                                  : static_cast<uint32_t>(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        dynamicRendering_ = config.dynamic_rendering && device.supportsDynamicRendering();
+        useSubmitThread_  = config.submit_thread;
+        frameLimit_       = config.window_frames;
+        LOG_INFO("rendering through {}", dynamicRendering_ ? "vkCmdBeginRendering" : "render passes");
+        if (config.temporal_mode != TemporalMode::Off) {
+            if (offscreen) {
+                LOG_INFO("temporal reconstruction is not used for offscreen sequences");
+            } else if (!dynamicRendering_) {
+                LOG_WARN("temporal reconstruction needs dynamic rendering, shading every pixel");
+            } else {
+                temporalMode_ = config.temporal_mode;
+            }
+        }
+        if (config.sdf_volume > 0) {
+            if (temporalMode_ != TemporalMode::Off) {
+                LOG_WARN("the baked SDF is not used with temporal reconstruction, marching the analytic SDF");
+            } else if (!SdfVolume::supported(device)) {
+                LOG_WARN("R16 storage images with linear filtering are unsupported, marching the analytic SDF");
+            } else {
+                VKP_STARTUP_SCOPE("sdf volume");
+                sdfVolume_   = std::make_unique<SdfVolume>(device, config.sdf_volume, config.sdf_threshold);
+                useBakedSdf_ = true;
+            }
+        }
+        if (!config.textures.empty()) {
+            if (offscreen) {
+                LOG_INFO("textures are only streamed in the window loop");
+            } else {
+                textureStreamer_ = std::make_unique<TextureStreamer>(
+                    device, static_cast<VkDeviceSize>(config.texture_budget_mb) << 20);
+                for (const char* path : config.textures) textureStreamer_->load(path);
+            }
+        }
+        if (config.sdf_benchmark != nullptr) {
+            if (!offscreen || !sdfVolume_) {
+                LOG_WARN("the sdf benchmark needs an offscreen sequence and a baked SDF volume, skipped");
+            } else {
+                sdfBenchmark_ = std::make_unique<SdfBenchmark>(config.sdf_benchmark);
+            }
+        }
+
+        // Shader modules and the ImGui font atlas don't depend on the swap chain,
+        // so they are built as jobs while the swap chain is created here.
+        core::JobSystem& jobs = core::JobSystem::get();
+        ShaderModules    shaderModules{};
+        core::JobCounter shadersLoaded, fontAtlasBuilt, pipelinesBuilt;
+        // If anything below throws, the jobs still write shaderModules and this renderer: let them
+        // finish before the stack unwinds. Their own errors are dropped in favour of the first one.
+        struct DrainOnThrow {
+            core::JobSystem&                 jobs;
+            std::array<core::JobCounter*, 3> counters;
+            ~DrainOnThrow() {
+                if (std::uncaught_exceptions() == 0) return;
+                for (core::JobCounter* counter : counters) {
+                    try {
+                        jobs.wait(*counter);
+                    } catch (...) {}
+                }
+            }
+        } drainOnThrow{ jobs, { &shadersLoaded, &pipelinesBuilt, &fontAtlasBuilt } };
+        jobs.schedule([this, &shaderModules] {
+            VKP_STARTUP_SCOPE("shader modules");
+            // The baked variant compiles alongside on a cache miss; its pipeline below then hits the cache.
+            if (sdfVolume_) {
+                const ShaderPermutation stages[] = { VERT_SHADER_PATH, FRAG_SHADER_PATH, bakedFragShader() };
+                (void)ShaderCompiler::get().compile(stages);
+            }
+            shaderModules = Pipeline::loadShaderModules(device, VERT_SHADER_PATH, FRAG_SHADER_PATH);
+        }, &shadersLoaded);
+        jobs.schedule([] {
+            VKP_STARTUP_SCOPE("imgui font atlas");
+            vkp::ImGuiLayer::PrepareContext();
+        }, &fontAtlasBuilt);
+
+        {
+            VKP_STARTUP_SCOPE("pipeline layout");
+            createPipelineLayout();
+        }
+        {
+            VKP_STARTUP_SCOPE("swap chain");
+            // Readback passes need extra image usage, which is only requested when they run on it.
+            VkImageUsageFlags usage = 0;
+            if (!offscreen && config.capture_dir != nullptr) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            if (!offscreen && config.video_path != nullptr)  usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+            // A reloaded module keeps the host's swap chain; the previous renderer idled the device.
+            if (swapChain && swapChain->usesDynamicRendering() == dynamicRendering_ && swapChain->hasImageUsage(usage)) {
+                LOG_INFO("reusing the swap chain");
+            } else {
+                swapChain.reset();
+                swapChain = std::make_unique<vkp::graphics::SwapChain>(
+                    device, window.getExtent(), usage, dynamicRendering_);
+            }
+        }
 
-        createPipelineLayout();
-        recreateSwapChain();
-        createCommandBuffers();
+        // The scene pipeline only needs the render pass or attachment formats and the modules;
+        // compile it while ImGui sets up its backend.
+        jobs.scheduleAfter(shadersLoaded, [this, &shaderModules] {
+            // A failed load is reported by waiting on shadersLoaded.
+            if (shaderModules.vert == VK_NULL_HANDLE || shaderModules.frag == VK_NULL_HANDLE) return;
+            VKP_STARTUP_SCOPE("scene pipeline");
+            pipeline = createPipeline(shaderModules);
+            if (sdfVolume_) {
+                bakedPipeline_ = createPipeline(
+                    Pipeline::loadShaderModules(device, VERT_SHADER_PATH, bakedFragShader()));
+            }
+        }, &pipelinesBuilt);
+        {
+            VKP_STARTUP_SCOPE("command buffers");
+            createCommandBuffers();
+        }
+        {
+            VKP_STARTUP_SCOPE("gpu profiler");
+            gpuProfiler = std::make_unique<GpuProfiler>(device, framesInFlight);
+        }
+        jobs.wait(fontAtlasBuilt);
+        {
+            VKP_STARTUP_SCOPE("imgui backend");
+            imguiLayer = std::make_unique<vkp::ImGuiLayer>(
+                window, device, static_cast<uint32_t>(swapChain->imageCount()), swapChain->getRenderPass(), 0,
+                swapChain->getSwapChainImageFormat(), swapChain->getDepthFormat()
+            );
+            imguiLayer->OnAttach();
+            imguiLayer->SetFrameStats(&frameStats_, config.frame_budget_ms);
+            imguiLayer->SetMemoryReport(&memoryReport_);
+            if (device.enableValidationLayers) imguiLayer->SetDebugMessages(&device.debugMessages());
+            if (gpuProfiler->statisticsEnabled()) imguiLayer->SetPipelineStatistics(&gpuProfiler->lastStatistics());
+            if (textureStreamer_) imguiLayer->SetTextureStreamer(textureStreamer_.get());
+        }
+        jobs.wait(pipelinesBuilt);
+        jobs.wait(shadersLoaded);
+
+        if (offscreen) {
+            // Same formats as the swap chain, so the scene pipeline renders into it unchanged.
+            sequenceRenderer = std::make_unique<SequenceRenderer>(
+                device,
+                VkExtent2D{ static_cast<uint32_t>(width_), static_cast<uint32_t>(height_) },
+                swapChain->getSwapChainImageFormat(),
+                swapChain->getDepthFormat(),
+                dynamicRendering_);
+            glfwHideWindow(window.handle());
+        }
+        if (dynamicRendering_) {
+            VKP_STARTUP_SCOPE("frame graph");
+            buildFrameGraph();
+        }
+        const VkFormat   targetFormat = swapChain->getSwapChainImageFormat();
+        const VkExtent2D targetExtent = offscreen ? sequenceRenderer->extent() : swapChain->getSwapChainExtent();
+
+        if (config.capture_dir != nullptr) {
+            if (!offscreen && !swapChain->hasImageUsage(VK_IMAGE_USAGE_TRANSFER_SRC_BIT)) {
+                LOG_WARN("swap chain images can't be used as a transfer source, frame capture disabled");
+            } else if (!FrameCapture::supportsFormat(targetFormat)) {
+                LOG_WARN("frame capture supports 8-bit RGBA/BGRA swap chains only, capture disabled");
+            } else {
+                frameCapture = std::make_unique<FrameCapture>(
+                    device, framesInFlight, config.capture_dir, config.capture_format);
+            }
+        }
+        if (config.video_path != nullptr) {
+            if (!offscreen && !swapChain->hasImageUsage(VK_IMAGE_USAGE_SAMPLED_BIT)) {
+                LOG_WARN("swap chain images can't be sampled, video output disabled");
+            } else if (!VideoStream::supportsFormat(targetFormat)) {
+                LOG_WARN("video output supports 8-bit RGBA/BGRA swap chains only, video disabled");
+            } else {
+                videoStream = std::make_unique<VideoStream>(
+                    device, framesInFlight,
+                    VideoStreamSettings{ config.video_path, config.video_format, videoFps },
+                    targetExtent);
+            }
+        }
 
-        imguiLayer = std::make_unique<vkp::ImGuiLayer>(
-            window, device, *swapChain, swapChain->getRenderPass()
-        );
-        imguiLayer->OnAttach();
+        core::HitchDetector::get().configure(config.frame_budget_ms, "engine/logs/hitches.txt");
+        updateMemoryReport(core::Profiler::now());
+        if (config.metrics_endpoint != nullptr) {
+            frameMetrics();
+            metricsServer = std::make_unique<core::MetricsServer>(config.metrics_endpoint);
+            if (!metricsServer->listening()) {
+                metricsServer.reset();
+            }
+        }
+        core::StartupProfiler::get().report();
+        if (const auto* host = device.hostAllocator()) {
+            HostAllocator::logDelta("during startup", {}, host->stats());
+        }
         return true;
     }
 
     bool Renderer::run() {
-        while (!window.shouldClose()) {
-            glfwPollEvents();
-            drawFrame();
+        {
+            VKP_PROFILE_SCOPE("Renderer::run");
+            if (sequenceRenderer) {
+                VKP_PROFILE_THREAD("render");
+                runOffscreen();
+            } else {
+                runWindowed();
+            }
+            vkDeviceWaitIdle(device.device());
+            if (frameCapture) frameCapture->flush();
+            if (videoStream) videoStream->flush();
+            core::HitchDetector::get().flush();
         }
-        vkDeviceWaitIdle(device.device());
+#ifdef VKP_PROFILE_ENABLED
+        core::Profiler::get().writeChromeTrace("engine/logs/trace.json");
+#endif
         return true;
     }
 
-    void Renderer::shutdown() const {
-        imguiLayer->OnDetach();
-        vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+    void Renderer::runWindowed() {
+        VKP_PROFILE_THREAD("main");
+        // The render thread owns every Vulkan submission from here on; this thread only talks to GLFW.
+        std::atomic<bool>  rendering{ true };
+        std::exception_ptr renderError;
+        std::thread renderThread([this, &rendering, &renderError] {
+            VKP_PROFILE_THREAD("render");
+            try {
+                renderLoop();
+            } catch (...) {
+                renderError = std::current_exception();
+            }
+            rendering.store(false, std::memory_order_release);
+            glfwPostEmptyEvent();
+        });
+
+        core::JobSystem& jobs = core::JobSystem::get();
+        bool closePosted = false;
+        while (rendering.load(std::memory_order_acquire)) {
+            {
+                VKP_PROFILE_SCOPE("glfwWaitEvents");
+                glfwWaitEventsTimeout(EVENT_WAIT_SECONDS);
+            }
+            // Window and input work that jobs handed to the main thread.
+            jobs.pumpMain();
+            // A reload stops rendering the same way as closing the window; the host tells them apart.
+            if (!closePosted && (window.shouldClose() || host_.reloadRequested())) {
+                closePosted = window.postEvent({ WindowEvent::Type::Close });
+            }
+        }
+        renderThread.join();
+        if (window.droppedEvents() > 0) {
+            LOG_WARN("{} window event(s) dropped because the render thread fell behind", window.droppedEvents());
+        }
+        if (renderError) std::rethrow_exception(renderError);
+    }
+
+    void Renderer::renderLoop() {
+        if (useSubmitThread_) submitThread_ = std::make_unique<SubmitThread>();
+        while (pumpWindowEvents()) {
+            VKP_PROFILE_SCOPE("frame");
+            const uint64_t frameStart  = core::Profiler::now();
+            const uint64_t frameNumber = frameNumber_;
+            core::HitchDetector::get().beginFrame(frameStart);
+            drawFrame();
+            endFrame(frameStart, frameNumber);
+            if (frameLimit_ != 0 && frameNumber_ >= frameLimit_) break;
+        }
+        submitThread_.reset();
+
+        if (sampledFrames_ > 0) {
+            LOG_INFO("window loop: {} frames, mean CPU time {:.3f} ms, mean frame interval {:.3f} ms, submit thread {}",
+                     sampledFrames_ + 1, cpuMsTotal_ / static_cast<double>(sampledFrames_),
+                     frameMsTotal_ / static_cast<double>(sampledFrames_), useSubmitThread_ ? "on" : "off");
+        }
+    }
+
+    bool Renderer::pumpWindowEvents() {
+        WindowEvent event;
+        while (window.pollEvent(event)) {
+            if (event.type == WindowEvent::Type::Close) {
+                closeRequested_ = true;
+            } else if (imguiLayer) {
+                // Resizes are picked up through Window::consumeResize when the frame is presented.
+                imguiLayer->OnInput(event);
+            }
+        }
+        return !closeRequested_;
+    }
+
+    void Renderer::shutdown() {
+        submitThread_.reset();
+        vkDeviceWaitIdle(device.device());
+        deletionQueue_.flush();
+        textureStreamer_.reset();
+        temporal_.reset();
+        frameGraphs_.clear();
+        metricsServer.reset();
+        videoStream.reset();
+        sequenceRenderer.reset();
+        frameCapture.reset();
+        gpuProfiler.reset();
+        // Also runs after a failed init, so anything below may not have been created.
+        if (imguiLayer) imguiLayer->OnDetach();
+        // The command pool belongs to the device, which outlives this renderer.
+        if (!commandBuffers.empty()) {
+            vkFreeCommandBuffers(device.device(), device.getCommandPool(),
+                                 static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+        }
+        if (pipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device.device(), pipelineLayout, device.allocator());
+        }
     }
 
     void Renderer::createPipelineLayout() {
@@ -59,40 +399,86 @@ namespace vkp::graphics {
 
         VkPipelineLayoutCreateInfo info{};
         info.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        info.setLayoutCount         = 0;
-        info.pSetLayouts            = nullptr;
+        // Set 0 is the baked SDF volume; the analytic shader doesn't use it.
+        const VkDescriptorSetLayout sdfLayout = sdfVolume_ ? sdfVolume_->sampleSetLayout() : VK_NULL_HANDLE;
+        info.setLayoutCount         = sdfVolume_ ? 1 : 0;
+        info.pSetLayouts            = sdfVolume_ ? &sdfLayout : nullptr;
         info.pushConstantRangeCount = 1;
         info.pPushConstantRanges    = &pushConstantRange;
 
         if (vkCreatePipelineLayout(
-                device.device(), &info, nullptr, &pipelineLayout
+                device.device(), &info, device.allocator(), &pipelineLayout
             ) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout");
         }
     }
 
     void Renderer::recreateSwapChain() {
+        // Minimized: wait for the main thread to report a usable size, or to close.
         auto extent = window.getExtent();
         while (extent.width == 0 || extent.height == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (!pumpWindowEvents()) return;
             extent = window.getExtent();
-            glfwWaitEvents();
         }
-        vkDeviceWaitIdle(device.device());
-
-        if (swapChain == nullptr) {
-            swapChain = std::make_unique<vkp::graphics::SwapChain>(device, extent);
-        } else {
-            swapChain = std::make_unique<vkp::graphics::SwapChain>(device, extent, std::move(swapChain));
-            if (swapChain->imageCount() != commandBuffers.size()) {
-                freeCommandBuffers();
-                createCommandBuffers();
+        // The submit thread may still present to the old chain, and its results refer to it.
+        if (submitThread_) {
+            submitThread_->drain();
+            submitThread_->takeResult();
+        }
+        core::HitchDetector::get().note(core::HitchDetector::SwapchainRecreate);
+        frameMetrics().swapchainRecreations.inc();
+        const auto* host = device.hostAllocator();
+        const auto hostBefore = host ? host->stats() : HostAllocator::Stats{};
+
+        // No device wait: the old chain keeps presenting through oldSwapchain and is destroyed,
+        // with its views and depth images (and framebuffers without dynamic rendering), once its
+        // frames have completed.
+        std::shared_ptr<SwapChain> previous = std::move(swapChain);
+        swapChain = std::make_unique<vkp::graphics::SwapChain>(device, extent, previous);
+        deletionQueue_.retire(frameNumber_, [previous]() mutable { previous.reset(); });
+
+        // The pipeline only depends on the attachment formats; a plain resize keeps it.
+        if (previous->getSwapChainImageFormat() != swapChain->getSwapChainImageFormat()
+         || previous->getDepthFormat() != swapChain->getDepthFormat()) {
+            // Both are built before either is replaced, so a shader that no longer compiles
+            // leaves the working pipelines in place.
+            try {
+                std::unique_ptr<Pipeline> rebuilt =
+                    createPipeline(Pipeline::loadShaderModules(device, VERT_SHADER_PATH, FRAG_SHADER_PATH));
+                std::unique_ptr<Pipeline> rebuiltBaked;
+                if (sdfVolume_) {
+                    rebuiltBaked = createPipeline(
+                        Pipeline::loadShaderModules(device, VERT_SHADER_PATH, bakedFragShader()));
+                }
+                std::shared_ptr<Pipeline> retired = std::exchange(pipeline, std::move(rebuilt));
+                std::shared_ptr<Pipeline> retiredBaked = std::exchange(bakedPipeline_, std::move(rebuiltBaked));
+                deletionQueue_.retire(frameNumber_, [retired, retiredBaked]() mutable {
+                    retired.reset();
+                    retiredBaked.reset();
+                });
+            } catch (const std::exception& e) {
+                LOG_ERROR("failed to rebuild the scene pipelines for the new swap chain, keeping the previous ones: {}",
+                          e.what());
             }
         }
-
-        createPipeline();
+        if (!frameGraphs_.empty() || temporal_) {
+            // Their images may still be in use by the frames in flight. The rebuilt temporal
+            // history starts out invalid, so the first frame at the new size is shaded in full.
+            auto retired = std::make_shared<std::vector<std::unique_ptr<RenderGraph>>>(std::move(frameGraphs_));
+            frameGraphs_.clear();
+            std::shared_ptr<TemporalReconstruction> retiredTemporal = std::move(temporal_);
+            deletionQueue_.retire(frameNumber_, [retired, retiredTemporal]() mutable {
+                retiredTemporal.reset();
+                retired.reset();
+            });
+            buildFrameGraph(retiredTemporal.get());
+        }
+        previous.reset();
+        if (host) HostAllocator::logDelta("for swap chain recreation", hostBefore, host->stats());
     }
 
-    void Renderer::createPipeline() {
+    std::unique_ptr<Pipeline> Renderer::createPipeline(const ShaderModules& modules) {
         assert(swapChain && "Cannot create pipeline before swap chain");
         assert(pipelineLayout && "Cannot create pipeline before layout");
 
@@ -100,17 +486,100 @@ namespace vkp::graphics {
         vkp::graphics::Pipeline::defaultPipelineConfigInfo(conf);
         conf.renderPass    = swapChain->getRenderPass();
         conf.pipelineLayout = pipelineLayout;
+        conf.colorAttachmentFormat = swapChain->getSwapChainImageFormat();
+        conf.depthAttachmentFormat = swapChain->getDepthFormat();
 
-        pipeline = std::make_unique<vkp::graphics::Pipeline>(
-            device,
-            "shaders/sb_shader.vert.spv",
-            "shaders/sb_shader.frag.spv",
-            conf
-        );
+        return std::make_unique<vkp::graphics::Pipeline>(device, modules, conf);
+    }
+
+    const Pipeline& Renderer::scenePipeline() const {
+        return useBakedSdf_ && bakedPipeline_ ? *bakedPipeline_ : *pipeline;
+    }
+
+    void Renderer::buildFrameGraph(const TemporalReconstruction* previousTemporal) {
+        const VkExtent2D extent = sequenceRenderer ? sequenceRenderer->extent() : swapChain->getSwapChainExtent();
+        if (temporalMode_ != TemporalMode::Off) {
+            // Only the window loop uses it; it keeps a pair of graphs per frame slot for the same
+            // reason as frameGraphs_ below.
+            temporal_ = std::make_unique<TemporalReconstruction>(
+                device, temporalMode_, extent, SwapChain::MAX_FRAMES_IN_FLIGHT,
+                swapChain->getSwapChainImageFormat(), swapChain->getDepthFormat(),
+                pipelineLayout,
+                [this](const VkCommandBuffer cmd, const VkExtent2D viewport, const VkExtent2D resolution,
+                       const uint32_t sparse, const Pipeline& scenePipeline) {
+                    recordScene(cmd, viewport, resolution, sceneTime_, sparse, scenePipeline);
+                },
+                [this](const VkCommandBuffer cmd, const VkExtent2D target) {
+                    VKP_GPU_DRAW_SCOPE(*gpuProfiler, cmd, "imgui");
+                    imguiLayer->OnRender(cmd, target);
+                },
+                previousTemporal);
+            const VkExtent2D sparse = temporal_->sparseExtent();
+            const auto& stats = temporal_->sparseGraph().stats();
+            LOG_INFO("temporal reconstruction x{}: shading {}x{} of {}x{} per frame, {} barriers, {} KiB transient",
+                     SwapChain::MAX_FRAMES_IN_FLIGHT, sparse.width, sparse.height, extent.width, extent.height,
+                     stats.barriers, stats.allocatedBytes >> 10);
+            return;
+        }
+
+        // One graph per frame in flight, each with its own transient depth buffer: a shared one would
+        // be cleared by the next frame while the previous frame's depth tests may still be running.
+        const uint32_t slots = sequenceRenderer ? SequenceRenderer::FRAMES_IN_FLIGHT : SwapChain::MAX_FRAMES_IN_FLIGHT;
+        frameGraphs_.clear();
+        for (uint32_t slot = 0; slot < slots; slot++) {
+            frameGraphs_.push_back(buildSceneGraph(extent));
+        }
+
+        const auto& stats = frameGraphs_.front()->stats();
+        LOG_INFO("frame graph x{}: {} passes ({} culled), {} barriers, {} transient images in {} blocks, {} KiB of {} KiB",
+                 slots, stats.passes, stats.culledPasses, stats.barriers, stats.transientImages, stats.memoryBlocks,
+                 stats.allocatedBytes >> 10, stats.transientBytes >> 10);
+    }
+
+    std::unique_ptr<RenderGraph> Renderer::buildSceneGraph(const VkExtent2D extent) {
+        // The resource ids come out the same for every slot's graph.
+        auto graph = std::make_unique<RenderGraph>(device);
+
+        // The colour target is rebound to the acquired image or sequence slot every frame. Readback
+        // passes are recorded after the graph and expect the layouts the render passes left behind.
+        ImportedImage color{};
+        color.format = swapChain->getSwapChainImageFormat();
+        color.extent = extent;
+        if (sequenceRenderer) {
+            color.initialStages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            color.finalLayout   = OffscreenTarget::FINAL_LAYOUT;
+            color.finalStages   = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            color.finalAccess   = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        } else {
+            // The acquire semaphore is waited at this stage.
+            color.initialStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            color.finalLayout   = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            color.finalStages   = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        }
+        colorTarget_ = graph->importImage("color", color);
+        depthTarget_ = graph->createImage("depth", { swapChain->getDepthFormat(), extent });
+
+        graph->addPass(
+            "main",
+            [this](PassBuilder& pass) {
+                pass.colorAttachment(colorTarget_, VkClearColorValue{{0.01f, 0.01f, 0.01f, 1.0f}});
+                pass.depthAttachment(depthTarget_, 1.0f);
+            },
+            [this](const VkCommandBuffer cmd, const RenderGraph& graph) {
+                const VkExtent2D target = graph.extent(colorTarget_);
+                recordScene(cmd, target, sceneTime_);
+                if (!sequenceRenderer) {
+                    VKP_GPU_DRAW_SCOPE(*gpuProfiler, cmd, "imgui");
+                    imguiLayer->OnRender(cmd, target);
+                }
+            });
+        graph->compile();
+        return graph;
     }
 
     void Renderer::createCommandBuffers() {
-        commandBuffers.resize(swapChain->imageCount());
+        // One per frame in flight: the frame fence waited in acquireNextImage guards its reuse.
+        commandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
         VkCommandBufferAllocateInfo alloc{};
         alloc.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         alloc.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -124,59 +593,102 @@ namespace vkp::graphics {
         }
     }
 
-    void Renderer::freeCommandBuffers() {
-        vkFreeCommandBuffers(
-            device.device(),
-            device.getCommandPool(),
-            static_cast<uint32_t>(commandBuffers.size()),
-            commandBuffers.data()
-        );
-        commandBuffers.clear();
-    }
-
-    void Renderer::recordCommandBuffer(int imageIndex) const {
-        static int frame = 0;
-        frame = (frame + 1) % 100;
+    void Renderer::recordCommandBuffer(int imageIndex, const uint64_t frameNumber) {
+        VKP_PROFILE_SCOPE("Renderer::recordCommandBuffer");
 
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
-        if (vkBeginCommandBuffer(commandBuffers[imageIndex], &beginInfo) != VK_SUCCESS) {
+        const auto frameIndex = static_cast<uint32_t>(swapChain->currentFrameIndex());
+        const VkCommandBuffer cmd = commandBuffers[frameIndex];
+        if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
             throw std::runtime_error("failed to begin recording command buffer");
         }
+        gpuProfiler->beginFrame(cmd, frameIndex, frameNumber);
+        if (frameCapture) frameCapture->collect(frameIndex);
+        if (videoStream) videoStream->collect(frameIndex);
+        const uint32_t gpuFrameScope = gpuProfiler->beginScope(cmd, "frame");
+
+        if (textureStreamer_) {
+            VKP_GPU_SCOPE(*gpuProfiler, cmd, "texture upload");
+            // The frame slot's fence was waited, so all but the last MAX_FRAMES_IN_FLIGHT - 1 frames are done.
+            constexpr uint64_t pending = SwapChain::MAX_FRAMES_IN_FLIGHT - 1;
+            textureStreamer_->update(cmd, frameNumber, frameNumber > pending ? frameNumber - pending : 0);
+        }
 
-        VkRenderPassBeginInfo rpInfo{};
-        rpInfo.sType               = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    rpInfo.renderPass              = swapChain->getRenderPass();
-        rpInfo.framebuffer         = swapChain->getFrameBuffer(imageIndex);
-        rpInfo.renderArea.offset = {0, 0};
-        rpInfo.renderArea.extent   = swapChain->getSwapChainExtent();
+        const VkExtent2D extent = swapChain->getSwapChainExtent();
+        sceneTime_ = static_cast<float>(glfwGetTime());
+        recordSdfBake(cmd, sceneTime_);
+        if (temporal_) {
+            temporal_->execute(cmd, frameIndex, swapChain->getImage(imageIndex), swapChain->getImageView(imageIndex),
+                               sceneTime_);
+        } else if (!frameGraphs_.empty()) {
+            RenderGraph& graph = *frameGraphs_[frameIndex];
+            graph.bindImage(colorTarget_, swapChain->getImage(imageIndex), swapChain->getImageView(imageIndex));
+            graph.execute(cmd);
+        } else {
+            VkRenderPassBeginInfo rpInfo{};
+            rpInfo.sType               = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            rpInfo.renderPass          = swapChain->getRenderPass();
+            rpInfo.framebuffer         = swapChain->getFrameBuffer(imageIndex);
+            rpInfo.renderArea.offset   = {0, 0};
+            rpInfo.renderArea.extent   = extent;
+
+            std::array<VkClearValue, 2> clears{};
+            clears[0].color        = {{0.01f, 0.01f, 0.01f, 1.0f}};
+            clears[1].depthStencil = {1.0f, 0};
+            rpInfo.clearValueCount   = static_cast<uint32_t>(clears.size());
+            rpInfo.pClearValues      = clears.data();
+
+            vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+            recordScene(cmd, extent, sceneTime_);
+            {
+                VKP_GPU_DRAW_SCOPE(*gpuProfiler, cmd, "imgui");
+                imguiLayer->OnRender(cmd, extent);
+            }
+            vkCmdEndRenderPass(cmd);
+        }
 
-        std::array<VkClearValue, 2> clears{};
-        clears[0].color        = {{0.01f, 0.01f, 0.01f, 1.0f}};
-        clears[1].depthStencil = {1.0f, 0};
-        rpInfo.clearValueCount   = static_cast<uint32_t>(clears.size());
-        rpInfo.pClearValues      = clears.data();
+        recordReadback(
+            cmd, frameIndex,
+            swapChain->getImage(imageIndex), swapChain->getImageView(imageIndex), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            swapChain->getSwapChainImageFormat(), extent, frameNumber);
+        gpuProfiler->endScope(cmd, gpuFrameScope);
+        if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record command buffer");
+        }
+    }
 
-        vkCmdBeginRenderPass(commandBuffers[imageIndex], &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+    void Renderer::recordScene(const VkCommandBuffer cmd, const VkExtent2D extent, const float time) const {
+        recordScene(cmd, extent, extent, time, 0, scenePipeline());
+    }
 
+    void Renderer::recordScene(
+        const VkCommandBuffer cmd,
+        const VkExtent2D viewportExtent,
+        const VkExtent2D resolution,
+        const float time,
+        const uint32_t sparse,
+        const Pipeline& scenePipeline) const
+    {
         VkViewport viewport{};
         viewport.x        = 0.0f;
         viewport.y        = 0.0f;
-        viewport.width    = static_cast<float>(swapChain->getSwapChainExtent().width);
-        viewport.height   = static_cast<float>(swapChain->getSwapChainExtent().height);
+        viewport.width    = static_cast<float>(viewportExtent.width);
+        viewport.height   = static_cast<float>(viewportExtent.height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        VkRect2D scissor{{0, 0}, swapChain->getSwapChainExtent()};
-        vkCmdSetViewport(commandBuffers[imageIndex], 0, 1, &viewport);
-        vkCmdSetScissor(commandBuffers[imageIndex], 0, 1, &scissor);
+        VkRect2D scissor{{0, 0}, viewportExtent};
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-        // Push constants: resolution & time
+        // Push constants: resolution, time & temporal pattern
         PushConstants pc{};
-        pc.resolution = { static_cast<float>(width_), static_cast<float>(height_) };
-        pc.time       = static_cast<float>(glfwGetTime());
+        pc.resolution = { static_cast<float>(resolution.width), static_cast<float>(resolution.height) };
+        pc.time       = time;
+        pc.sparse     = sparse;
         vkCmdPushConstants(
-            commandBuffers[imageIndex],
+            cmd,
             pipelineLayout,
             VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
             0,
@@ -184,20 +696,201 @@ namespace vkp::graphics {
             &pc
         );
 
-        pipeline->bind(commandBuffers[imageIndex]);
-        vkCmdDraw(commandBuffers[imageIndex], 3, 1, 0, 0);
+        VKP_GPU_DRAW_SCOPE(*gpuProfiler, cmd, "scene");
+        scenePipeline.bind(cmd);
+        if (&scenePipeline == bakedPipeline_.get()) {
+            const VkDescriptorSet set = sdfVolume_->sampleSet();
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &set, 0, nullptr);
+        }
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+    }
 
-        imguiLayer->OnRender(commandBuffers[imageIndex]);
+    void Renderer::recordSdfBake(const VkCommandBuffer cmd, const float time) {
+        if (!sdfVolume_ || !useBakedSdf_ || !sdfVolume_->needsBake(time)) return;
+        VKP_GPU_SCOPE(*gpuProfiler, cmd, "sdf bake");
+        sdfVolume_->bake(cmd, time);
+    }
 
-        vkCmdEndRenderPass(commandBuffers[imageIndex]);
-        if (vkEndCommandBuffer(commandBuffers[imageIndex]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to record command buffer");
+    void Renderer::recordReadback(
+        const VkCommandBuffer cmd,
+        const uint32_t frameIndex,
+        const VkImage image,
+        const VkImageView view,
+        const VkImageLayout layout,
+        const VkFormat format,
+        const VkExtent2D extent,
+        const uint64_t frameNumber) const
+    {
+        if (frameCapture) {
+            VKP_GPU_SCOPE(*gpuProfiler, cmd, "capture copy");
+            frameCapture->record(cmd, frameIndex, image, layout, format, extent, frameNumber);
+        }
+        if (videoStream) {
+            VKP_GPU_SCOPE(*gpuProfiler, cmd, "yuv convert");
+            videoStream->record(cmd, frameIndex, image, view, layout, format, extent, frameNumber);
         }
     }
 
+    void Renderer::endFrame(const uint64_t frameStartNs, const uint64_t frameNumber) {
+        const uint64_t now = core::Profiler::now();
+
+        // drawFrame only advances the frame number once it submitted GPU work.
+        auto& hitches = core::HitchDetector::get();
+        const bool submitted = frameNumber_ != frameNumber;
+        hitches.endFrame(frameNumber, now, submitted && gpuProfiler->enabled());
+        if (hitches.awaitingGpu()) {
+            std::vector<core::ProfileEvent> scopes;
+            for (const auto& result : gpuProfiler->lastResults()) {
+                scopes.push_back({ result.name, result.start_ns, result.end_ns, 0 });
+            }
+            hitches.gpuResults(gpuProfiler->lastFrameNumber(), scopes);
+        }
+
+        auto& metrics = frameMetrics();
+        if (submitted) metrics.frames.inc();
+        device.debugMessages().endFrame();
+
+        // The first frame has no previous start to measure an interval from.
+        if (lastFrameStartNs_ != 0) {
+            const core::FrameSample sample{
+                now,
+                static_cast<float>(frameStartNs - lastFrameStartNs_) * 1e-6f,
+                static_cast<float>(now - frameStartNs) * 1e-6f,
+                static_cast<float>(gpuProfiler->lastFrameMs()),
+            };
+            frameStats_.push(sample);
+            ++sampledFrames_;
+            cpuMsTotal_   += sample.cpu_ms;
+            frameMsTotal_ += sample.frame_ms;
+            metrics.frameTime.observe(sample.frame_ms);
+            if (gpuProfiler->enabled()) metrics.gpuTime.observe(sample.gpu_ms);
+        }
+        lastFrameStartNs_ = frameStartNs;
+        updateMemoryReport(now);
+    }
+
+    void Renderer::updateMemoryReport(const uint64_t nowNs) {
+        if (lastMemoryPollNs_ != 0 && nowNs - lastMemoryPollNs_ < MEMORY_POLL_NS) return;
+        lastMemoryPollNs_ = nowNs;
+        memoryReport_ = device.queryMemoryReport();
+
+        heapOverBudget_.resize(memoryReport_.heaps.size(), false);
+        VkDeviceSize localUsage = 0, localBudget = 0;
+        for (size_t i = 0; i < memoryReport_.heaps.size(); ++i) {
+            const auto& heap = memoryReport_.heaps[i];
+            if (heap.deviceLocal) {
+                localUsage  += heap.usage;
+                localBudget += heap.budget;
+            }
+            if (heap.budget == 0) continue;
+            const double fraction = static_cast<double>(heap.usage) / static_cast<double>(heap.budget);
+            if (!heapOverBudget_[i] && fraction >= MEMORY_WARN_FRACTION) {
+                heapOverBudget_[i] = true;
+                LOG_WARN("memory heap {} at {:.0f}% of its budget ({} / {} MiB), the driver may start paging",
+                         i, fraction * 100.0, heap.usage >> 20, heap.budget >> 20);
+            } else if (heapOverBudget_[i] && fraction < MEMORY_CLEAR_FRACTION) {
+                heapOverBudget_[i] = false;
+            }
+        }
+        frameMetrics().memoryUsage.set(static_cast<double>(localUsage));
+        frameMetrics().memoryBudget.set(static_cast<double>(localBudget));
+    }
+
+    void Renderer::runOffscreen() {
+        VKP_PROFILE_SCOPE("Renderer::runOffscreen");
+        if (sdfBenchmark_) {
+            runSdfBenchmark();
+        } else {
+            renderSequence();
+        }
+    }
+
+    void Renderer::runSdfBenchmark() {
+        if (!gpuProfiler->enabled()) {
+            LOG_WARN("the sdf benchmark needs GPU timestamps, which this device doesn't support");
+            return;
+        }
+        // The same sequence twice; the volume is baked from scratch for the second run.
+        for (const bool baked : { false, true }) {
+            useBakedSdf_ = baked;
+            sdfVolume_->invalidate();
+            const uint64_t bakesBefore = sdfVolume_->bakes();
+            const VkExtent2D extent = sequenceRenderer->extent();
+            sdfBenchmark_->beginRun(baked ? "baked" : "analytic", frameNumber_,
+                                    sequence_.startTime, sequence_.timeStep,
+                                    static_cast<uint64_t>(extent.width) * extent.height);
+            renderSequence();
+            if (baked) LOG_INFO("sdf volume baked {} times for {} frames", sdfVolume_->bakes() - bakesBefore,
+                                sequence_.frameCount);
+        }
+        sdfBenchmark_->finish();
+    }
+
+    void Renderer::renderSequence() {
+        const VkExtent2D extent = sequenceRenderer->extent();
+        sequenceRenderer->run(sequence_, [this, extent](const VkCommandBuffer cmd, const SequenceFrame& frame) {
+            gpuProfiler->beginFrame(cmd, frame.slot, frameNumber_ + frame.index);
+            if (sdfBenchmark_) sdfBenchmark_->collect(*gpuProfiler);
+            if (frameCapture) frameCapture->collect(frame.slot);
+            if (videoStream) videoStream->collect(frame.slot);
+            const uint32_t gpuFrameScope = gpuProfiler->beginScope(cmd, "frame");
+
+            recordSdfBake(cmd, frame.time);
+            if (!frameGraphs_.empty()) {
+                RenderGraph& graph = *frameGraphs_[frame.slot];
+                graph.bindImage(colorTarget_, frame.target.colorImage(), frame.target.colorView());
+                sceneTime_ = frame.time;
+                graph.execute(cmd);
+            } else {
+                std::array<VkClearValue, 2> clears{};
+                clears[0].color        = {{0.01f, 0.01f, 0.01f, 1.0f}};
+                clears[1].depthStencil = {1.0f, 0};
+                VkRenderPassBeginInfo rpInfo{};
+                rpInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                rpInfo.renderPass        = frame.target.renderPass();
+                rpInfo.framebuffer       = frame.target.framebuffer();
+                rpInfo.renderArea.extent = extent;
+                rpInfo.clearValueCount   = static_cast<uint32_t>(clears.size());
+                rpInfo.pClearValues      = clears.data();
+
+                vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+                recordScene(cmd, extent, frame.time);
+                vkCmdEndRenderPass(cmd);
+            }
+
+            recordReadback(
+                cmd, frame.slot, frame.target.colorImage(), frame.target.colorView(),
+                OffscreenTarget::FINAL_LAYOUT, frame.target.colorFormat(), extent, frameNumber_ + frame.index);
+            gpuProfiler->endScope(cmd, gpuFrameScope);
+            frameMetrics().frames.inc();
+            updateMemoryReport(core::Profiler::now());
+            core::StartupProfiler::get().markFirstFrame();
+        });
+        frameNumber_ += sequence_.frameCount;
+    }
+
     void Renderer::drawFrame() {
+        VKP_PROFILE_SCOPE("Renderer::drawFrame");
+        if (submitThread_) {
+            // The fence waited below belongs to a frame that must have been submitted by now, and
+            // no more images may wait for their present than the swap chain allows.
+            submitThread_->waitPending(std::min<uint64_t>(
+                SwapChain::MAX_FRAMES_IN_FLIGHT - 1, swapChain->acquireAhead()));
+            // Presents report back here, a frame or two late.
+            const VkResult presented = submitThread_->takeResult();
+            if (presented == VK_ERROR_OUT_OF_DATE_KHR || presented == VK_SUBOPTIMAL_KHR) {
+                recreateSwapChain();
+                return;
+            } else if (presented != VK_SUCCESS) {
+                throw std::runtime_error("failed to present swapchain image");
+            }
+        }
+
         uint32_t imageIndex;
         auto result = swapChain->acquireNextImage(&imageIndex);
+        // The frame slot's fence was just waited, so every frame but the last MAX_FRAMES_IN_FLIGHT - 1 is done.
+        constexpr uint64_t pending = SwapChain::MAX_FRAMES_IN_FLIGHT - 1;
+        deletionQueue_.collect(frameNumber_ > pending ? frameNumber_ - pending : 0);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreateSwapChain();
@@ -207,13 +900,23 @@ namespace vkp::graphics {
             throw std::runtime_error("failed to acquire swapchain image");
         }
 
-        recordCommandBuffer(imageIndex);
-        result = swapChain->submitCommandBuffers(&commandBuffers[imageIndex], &imageIndex);
+        const size_t frameIndex = swapChain->currentFrameIndex();
+        recordCommandBuffer(imageIndex, frameNumber_);
+        const FrameSubmission frame = swapChain->prepareSubmit(commandBuffers[frameIndex], imageIndex);
+        if (submitThread_) {
+            submitThread_->push(frame);
+            result = VK_SUCCESS;
+        } else {
+            result = swapChain->submitAndPresent(frame);
+        }
+        ++frameNumber_;
+        core::StartupProfiler::get().markFirstFrame();
 
+        // Taken unconditionally so a resize that coincides with an out-of-date chain isn't handled twice.
+        const bool resized = window.consumeResize();
         if (result == VK_ERROR_OUT_OF_DATE_KHR
          || result == VK_SUBOPTIMAL_KHR
-         || window.wasWindowResized()) {
-            window.resetWindowResizedFlag();
+         || resized) {
             recreateSwapChain();
             return;
         } else if (result != VK_SUCCESS) {
@@ -222,3 +925,22 @@ namespace vkp::graphics {
     }
 
 } // namespace vkp::graphics
+
+extern "C" const vkp::graphics::RendererModuleApi* vkpRendererModule() {
+    using vkp::graphics::Renderer;
+    static constexpr vkp::graphics::RendererModuleApi api{
+        [](vkp::graphics::RenderHost& host) { return new Renderer(host); },
+        // Reported as a failed init, so the caller still destroys the half-built renderer.
+        [](Renderer& renderer, const vkp::graphics::renderer_conf& config) {
+            try {
+                return renderer.init(config);
+            } catch (const std::exception& e) {
+                LOG_ERROR("renderer init failed: {}", e.what());
+                return false;
+            }
+        },
+        [](Renderer& renderer) { return renderer.run(); },
+        [](Renderer* renderer) { delete renderer; },
+    };
+    return &api;
+}
@@ -0,0 +1,18 @@
+#include <vkp/graphics/renderer_conf.h>
+
+namespace vkp::graphics {
+
+    bool parseVideoFormat(const std::string& name, VideoFormat& format) {
+        if (name == "y4m")  { format = VideoFormat::Y4M;  return true; }
+        if (name == "nv12") { format = VideoFormat::NV12; return true; }
+        return false;
+    }
+
+    bool parseTemporalMode(const std::string& name, TemporalMode& mode) {
+        if (name == "off")     { mode = TemporalMode::Off;          return true; }
+        if (name == "checker") { mode = TemporalMode::Checkerboard; return true; }
+        if (name == "quarter") { mode = TemporalMode::Quarter;      return true; }
+        return false;
+    }
+
+} // namespace vkp::graphics
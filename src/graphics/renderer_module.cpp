@@ -0,0 +1,120 @@
+#include <vkp/graphics/renderer_module.h>
+#include <vkp/core/job_system.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#ifdef __linux__
+    #include <dlfcn.h>
+#endif
+
+namespace vkp::graphics {
+
+    RendererModule::RendererModule(const RendererModuleApi& api)
+        : api_(&api) {}
+
+    // Loaded libraries are never unmapped, so nothing the host still holds (a profile event name,
+    // a callback, a static destructor registered by a module) outlives the code it points into.
+    RendererModule::~RendererModule() = default;
+
+#ifdef __linux__
+    RendererModule::RendererModule(std::filesystem::path path)
+        : path_(std::move(path)) {
+        if (!load()) {
+            throw std::runtime_error("failed to load the renderer module " + path_.string());
+        }
+        seen_ = loaded_;
+        LOG_INFO("loaded {}, reloading it when it changes", path_.string());
+    }
+
+    std::filesystem::path RendererModule::besideExecutable(const char* fileName) {
+        std::error_code error;
+        const std::filesystem::path exe = std::filesystem::read_symlink("/proc/self/exe", error);
+        return error ? std::filesystem::path(fileName) : exe.parent_path() / fileName;
+    }
+
+    RendererModule::FileState RendererModule::fileState() const {
+        std::error_code error;
+        FileState state;
+        state.time = std::filesystem::last_write_time(path_, error);
+        if (error) return {};
+        state.size = std::filesystem::file_size(path_, error);
+        if (error) return {};
+        return state;
+    }
+
+    bool RendererModule::load() {
+        loaded_ = fileState();
+        // dlopen of a path that is already loaded returns the old library, and the linker may
+        // rewrite the original in place, so every load maps its own copy.
+        const std::filesystem::path copy =
+            path_.parent_path() / fmt::format(".{}.{}", path_.filename().string(), ++generation_);
+        std::error_code error;
+        std::filesystem::copy_file(path_, copy, std::filesystem::copy_options::overwrite_existing, error);
+        if (error) {
+            LOG_ERROR("failed to copy {}: {}", path_.string(), error.message());
+            return false;
+        }
+        void* const library = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+        // The mapping outlives the file.
+        std::filesystem::remove(copy, error);
+        if (library == nullptr) {
+            LOG_ERROR("failed to load {}: {}", path_.string(), dlerror());
+            return false;
+        }
+
+        using EntryPoint = const RendererModuleApi* (*)();
+        const auto entry = reinterpret_cast<EntryPoint>(dlsym(library, ENTRY_POINT));
+        const RendererModuleApi* api = entry != nullptr ? entry() : nullptr;
+        if (api == nullptr) {
+            LOG_ERROR("{} has no {}", path_.string(), ENTRY_POINT);
+            dlclose(library);
+            return false;
+        }
+
+        // The previous library stays mapped for the same reason as in the destructor.
+        library_ = library;
+        api_     = api;
+        return true;
+    }
+
+    bool RendererModule::changed() {
+        if (library_ == nullptr) return false;
+        const auto now = std::chrono::steady_clock::now();
+        if (now - polledAt_ < POLL_INTERVAL) return false;
+        polledAt_ = now;
+
+        const FileState state = fileState();
+        if (state != seen_) {
+            seen_   = state;
+            seenAt_ = now;
+            return false;
+        }
+        // A missing or empty file is the linker at work.
+        return state.size > 0 && state != loaded_ && now - seenAt_ >= RELOAD_SETTLE;
+    }
+
+    bool RendererModule::reload() {
+        if (library_ == nullptr) return false;
+        // Queued main-thread jobs and recorded scope names may point into the old module.
+        core::JobSystem::get().pumpMain();
+        core::Profiler::get().discardEvents();
+        if (!load()) {
+            LOG_WARN("keeping the loaded renderer module");
+            return false;
+        }
+        LOG_INFO("reloaded {}", path_.string());
+        return true;
+    }
+#else
+    bool RendererModule::changed() { return false; }
+
+    bool RendererModule::reload() { return false; }
+#endif
+
+} // namespace vkp::graphics
@@ -0,0 +1,343 @@
+#include <vkp/graphics/sdf_volume.h>
+#include <vkp/graphics/pipeline.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace vkp::graphics {
+
+    static constexpr auto BAKE_SHADER_PATH = "shaders/sdf_bake.comp";
+    static constexpr uint32_t BAKE_GROUP_SIZE = 4;   // local_size in sdf_bake.comp
+    // How far the warp moves a point per radian the warp axis turns, at most. The warp rotates a
+    // point at radius r by theta(r) = pi * smoothstep(100, 2, r^2)^5 (rotSpace() in sdf.glsl);
+    // turning the axis by d moves it by |(y - R y) x R p| * d <= 2 r sin(theta(r) / 2) * d.
+    // That peaks at about 7.5 near r = 4.3 and is zero outside r = 10.
+    static float warpDisplacementPerRadian() {
+        static const float bound = [] {
+            constexpr float pi = 3.1415926536f;
+            float peak = 0.f;
+            for (int i = 1; i <= 1000; i++) {
+                const float r = static_cast<float>(i) * 0.01f;
+                const float t = std::clamp((r * r - 100.f) / (2.f - 100.f), 0.f, 1.f);
+                const float theta = pi * std::pow(t * t * (3.f - 2.f * t), 5.f);
+                peak = std::max(peak, 2.f * r * std::sin(theta * 0.5f));
+            }
+            return peak;
+        }();
+        return bound;
+    }
+
+    bool SdfVolume::supported(const Device& device) {
+        return device.caps().supportsFormat(
+            FORMAT, VK_IMAGE_TILING_OPTIMAL,
+            VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    }
+
+    SdfVolume::SdfVolume(Device& device, const uint32_t resolution, const float thresholdVoxels)
+        : device_(device)
+        , resolution_(std::max(resolution, BAKE_GROUP_SIZE))
+        , threshold_(thresholdVoxels * 2.f * HALF_EXTENT / static_cast<float>(resolution_))
+    {
+        createImage();
+        createPipeline();
+        createDescriptors();
+        LOG_INFO("sdf volume: {}^3 texels, {} MiB, re-baked after {:.3f} units of change",
+                 resolution_, (static_cast<uint64_t>(resolution_) * resolution_ * resolution_ * 2) >> 20, threshold_);
+    }
+
+    SdfVolume::~SdfVolume() {
+        const VkDevice dev = device_.device();
+        vkDestroyPipeline(dev, pipeline_, device_.allocator());
+        vkDestroyPipelineLayout(dev, pipelineLayout_, device_.allocator());
+        vkDestroyDescriptorPool(dev, descriptorPool_, device_.allocator());
+        vkDestroyDescriptorSetLayout(dev, bakeSetLayout_, device_.allocator());
+        vkDestroyDescriptorSetLayout(dev, sampleSetLayout_, device_.allocator());
+        vkDestroySampler(dev, sampler_, device_.allocator());
+        vkDestroyImageView(dev, view_, device_.allocator());
+        vkDestroyImage(dev, image_, device_.allocator());
+        device_.freeMemory(memory_);
+    }
+
+    void SdfVolume::createImage() {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType     = VK_IMAGE_TYPE_3D;
+        imageInfo.extent        = { resolution_, resolution_, resolution_ };
+        imageInfo.mipLevels     = 1;
+        imageInfo.arrayLayers   = 1;
+        imageInfo.format        = FORMAT;
+        imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage         = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        device_.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image_, memory_, MemoryCategory::Texture);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image            = image_;
+        viewInfo.viewType         = VK_IMAGE_VIEW_TYPE_3D;
+        viewInfo.format           = FORMAT;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        if (vkCreateImageView(device_.device(), &viewInfo, device_.allocator(), &view_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create sdf volume view");
+        }
+
+        // Moved to GENERAL once; every bake discards the contents anyway.
+        const VkCommandBuffer cmd = device_.beginSingleTimeCommands();
+        VkImageMemoryBarrier toGeneral{};
+        toGeneral.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toGeneral.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+        toGeneral.newLayout           = VK_IMAGE_LAYOUT_GENERAL;
+        toGeneral.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toGeneral.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toGeneral.image               = image_;
+        toGeneral.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toGeneral);
+        device_.endSingleTimeCommands(cmd);
+    }
+
+    void SdfVolume::createPipeline() {
+        const VkDevice dev = device_.device();
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding         = 0;
+        binding.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        binding.descriptorCount = 1;
+        binding.stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+        setLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInfo.bindingCount = 1;
+        setLayoutInfo.pBindings    = &binding;
+        if (vkCreateDescriptorSetLayout(dev, &setLayoutInfo, device_.allocator(), &bakeSetLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create sdf bake descriptor set layout");
+        }
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        binding.stageFlags     = VK_SHADER_STAGE_FRAGMENT_BIT;
+        if (vkCreateDescriptorSetLayout(dev, &setLayoutInfo, device_.allocator(), &sampleSetLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create sdf sample descriptor set layout");
+        }
+
+        VkPushConstantRange pushRange{};
+        pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushRange.size       = sizeof(float);
+
+        VkPipelineLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount         = 1;
+        layoutInfo.pSetLayouts            = &bakeSetLayout_;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges    = &pushRange;
+        if (vkCreatePipelineLayout(dev, &layoutInfo, device_.allocator(), &pipelineLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create sdf bake pipeline layout");
+        }
+
+        const VkShaderModule module = Pipeline::loadShaderModule(device_, BAKE_SHADER_PATH);
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = module;
+        pipelineInfo.stage.pName  = "main";
+        pipelineInfo.layout       = pipelineLayout_;
+        const VkResult result = vkCreateComputePipelines(dev, VK_NULL_HANDLE, 1, &pipelineInfo, device_.allocator(), &pipeline_);
+        vkDestroyShaderModule(dev, module, device_.allocator());
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create sdf bake pipeline");
+        }
+    }
+
+    void SdfVolume::createDescriptors() {
+        const VkDevice dev = device_.device();
+
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_LINEAR;
+        samplerInfo.minFilter    = VK_FILTER_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        if (vkCreateSampler(dev, &samplerInfo, device_.allocator(), &sampler_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create sdf sampler");
+        }
+
+        std::array<VkDescriptorPoolSize, 2> poolSizes{};
+        poolSizes[0] = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 };
+        poolSizes[1] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 };
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = 2;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes    = poolSizes.data();
+        if (vkCreateDescriptorPool(dev, &poolInfo, device_.allocator(), &descriptorPool_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create sdf descriptor pool");
+        }
+
+        const std::array<VkDescriptorSetLayout, 2> layouts = { bakeSetLayout_, sampleSetLayout_ };
+        std::array<VkDescriptorSet, 2> sets{};
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool     = descriptorPool_;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+        allocInfo.pSetLayouts        = layouts.data();
+        if (vkAllocateDescriptorSets(dev, &allocInfo, sets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate sdf descriptor sets");
+        }
+        bakeSet_   = sets[0];
+        sampleSet_ = sets[1];
+
+        const VkDescriptorImageInfo storageInfo{ VK_NULL_HANDLE, view_, VK_IMAGE_LAYOUT_GENERAL };
+        const VkDescriptorImageInfo sampledInfo{ sampler_, view_, VK_IMAGE_LAYOUT_GENERAL };
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        writes[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet          = bakeSet_;
+        writes[0].dstBinding      = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[0].pImageInfo      = &storageInfo;
+        writes[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet          = sampleSet_;
+        writes[1].dstBinding      = 0;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[1].pImageInfo      = &sampledInfo;
+        vkUpdateDescriptorSets(dev, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    SdfVolume::Params SdfVolume::params(const float time) {
+        // Mirrors axisDir() and sceneBoxes() in sdf.glsl. Arms longer than the volume's diagonal
+        // don't change what is inside it.
+        const float l = std::max(time * 0.2f - 0.2f, 0.f);
+        return { time * 0.3f, std::min(std::min(std::pow(l, 6.f), 1000.f), 2.f * HALF_EXTENT) };
+    }
+
+    bool SdfVolume::needsBake(const float time) const {
+        if (!baked_) return true;
+        const Params now = params(time);
+        const float moved = std::max(std::abs(now.axisAngle - bakedParams_.axisAngle) * warpDisplacementPerRadian(),
+                                     std::abs(now.armLength - bakedParams_.armLength));
+        return moved > threshold_;
+    }
+
+    void SdfVolume::bake(const VkCommandBuffer cmd, const float time) {
+        VKP_PROFILE_SCOPE("SdfVolume::bake");
+        VkImageMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image               = image_;
+        barrier.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+        // Earlier frames may still be marching the old volume; its contents are discarded.
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_, 0, 1, &bakeSet_, 0, nullptr);
+        vkCmdPushConstants(cmd, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(float), &time);
+        const uint32_t groups = (resolution_ + BAKE_GROUP_SIZE - 1) / BAKE_GROUP_SIZE;
+        vkCmdDispatch(cmd, groups, groups, groups);
+
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        baked_       = true;
+        bakedParams_ = params(time);
+        ++bakes_;
+    }
+
+    void SdfBenchmark::beginRun(
+        const char* variant, const uint64_t firstFrame, const double startTime, const double timeStep,
+        const uint64_t pixels)
+    {
+        runs_.push_back({ variant, firstFrame, startTime, timeStep, pixels });
+    }
+
+    void SdfBenchmark::collect(const GpuProfiler& profiler) {
+        const uint64_t frame = profiler.lastFrameNumber();
+        if (profiler.lastResults().empty() || frame == lastFrame_ || runs_.empty()) return;
+        if (frame < runs_.front().firstFrame) return;
+        lastFrame_ = frame;
+
+        size_t run = 0;
+        while (run + 1 < runs_.size() && runs_[run + 1].firstFrame <= frame) ++run;
+        Row row{ run, frame - runs_[run].firstFrame, profiler.lastFrameMs(), 0.0, 0.0, 0, 0, 0 };
+        for (const auto& scope : profiler.lastResults()) {
+            const double ms = static_cast<double>(scope.end_ns - scope.start_ns) * 1e-6;
+            // Scope names as recorded by Renderer.
+            if (std::strcmp(scope.name, "scene") == 0)    row.sceneMs += ms;
+            if (std::strcmp(scope.name, "sdf bake") == 0) row.bakeMs  += ms;
+        }
+        if (profiler.lastStatisticsFrame() == frame) {
+            for (const auto& stats : profiler.lastStatistics()) {
+                if (std::strcmp(stats.name, "scene") != 0) continue;
+                row.vertexInvocations   += stats.vertexInvocations;
+                row.clippingPrimitives  += stats.clippingPrimitives;
+                row.fragmentInvocations += stats.fragmentInvocations;
+            }
+        }
+        rows_.push_back(row);
+    }
+
+    bool SdfBenchmark::finish() const {
+        const std::filesystem::path file(path_);
+        if (file.has_parent_path()) {
+            std::error_code error;
+            std::filesystem::create_directories(file.parent_path(), error);
+        }
+        std::ofstream out(path_, std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("failed to open benchmark file {}", path_);
+            return false;
+        }
+
+        out << "variant,frame,time_s,gpu_frame_ms,scene_ms,bake_ms,"
+               "scene_vs_invocations,scene_clip_primitives,scene_fs_invocations,scene_fs_per_pixel\n";
+        for (const auto& row : rows_) {
+            const Run& run = runs_[row.run];
+            const double perPixel = run.pixels > 0
+                ? static_cast<double>(row.fragmentInvocations) / static_cast<double>(run.pixels) : 0.0;
+            out << fmt::format("{},{},{:.4f},{:.4f},{:.4f},{:.4f},{},{},{},{:.3f}\n", run.variant, row.index,
+                               run.startTime + static_cast<double>(row.index) * run.timeStep,
+                               row.frameMs, row.sceneMs, row.bakeMs,
+                               row.vertexInvocations, row.clippingPrimitives, row.fragmentInvocations, perPixel);
+        }
+
+        // The last frames in flight of the final run are never collected and are missing.
+        for (size_t i = 0; i < runs_.size(); i++) {
+            size_t frames = 0;
+            double frameMs = 0.0, sceneMs = 0.0, bakeMs = 0.0;
+            for (const auto& row : rows_) {
+                if (row.run != i) continue;
+                ++frames;
+                frameMs += row.frameMs;
+                sceneMs += row.sceneMs;
+                bakeMs  += row.bakeMs;
+            }
+            if (frames == 0) continue;
+            const auto n = static_cast<double>(frames);
+            LOG_INFO("sdf benchmark {}: {} frames, gpu frame {:.3f} ms, scene {:.3f} ms, bake {:.3f} ms (means)",
+                     runs_[i].variant, frames, frameMs / n, sceneMs / n, bakeMs / n);
+        }
+        LOG_INFO("sdf benchmark written to {}", path_);
+        return true;
+    }
+
+} // namespace vkp::graphics
@@ -0,0 +1,109 @@
+#include <vkp/graphics/sequence_renderer.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <chrono>
+#include <stdexcept>
+
+namespace vkp::graphics {
+
+    SequenceRenderer::SequenceRenderer(
+        Device& device,
+        const VkExtent2D extent,
+        const VkFormat colorFormat,
+        const VkFormat depthFormat,
+        const bool dynamicRendering)
+        : device_(device)
+    {
+        for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+            targets_.push_back(std::make_unique<OffscreenTarget>(
+                device_, extent, colorFormat, depthFormat, dynamicRendering));
+        }
+
+        commandBuffers_.resize(FRAMES_IN_FLIGHT);
+        VkCommandBufferAllocateInfo alloc{};
+        alloc.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc.commandPool        = device_.getCommandPool();
+        alloc.commandBufferCount = FRAMES_IN_FLIGHT;
+        if (vkAllocateCommandBuffers(device_.device(), &alloc, commandBuffers_.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate sequence command buffers");
+        }
+
+        // Signaled, so the first use of every slot doesn't wait.
+        fences_.resize(FRAMES_IN_FLIGHT);
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        for (auto& fence : fences_) {
+            if (vkCreateFence(device_.device(), &fenceInfo, device_.allocator(), &fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create sequence fence");
+            }
+        }
+    }
+
+    SequenceRenderer::~SequenceRenderer() {
+        vkWaitForFences(device_.device(), FRAMES_IN_FLIGHT, fences_.data(), VK_TRUE, UINT64_MAX);
+        for (const auto fence : fences_) vkDestroyFence(device_.device(), fence, device_.allocator());
+        vkFreeCommandBuffers(device_.device(), device_.getCommandPool(), FRAMES_IN_FLIGHT, commandBuffers_.data());
+    }
+
+    SequenceStats SequenceRenderer::run(
+        const SequenceSettings& settings,
+        const RecordFn& record)
+    {
+        VKP_PROFILE_SCOPE("SequenceRenderer::run");
+        using clock = std::chrono::steady_clock;
+
+        SequenceStats stats{};
+        clock::duration fenceWait{};
+        const auto start = clock::now();
+
+        for (uint64_t i = 0; i < settings.frameCount; ++i) {
+            VKP_PROFILE_SCOPE("sequence frame");
+            const auto slot = static_cast<uint32_t>(i % FRAMES_IN_FLIGHT);
+            {
+                VKP_PROFILE_SCOPE("wait slot fence");
+                const auto waitStart = clock::now();
+                vkWaitForFences(device_.device(), 1, &fences_[slot], VK_TRUE, UINT64_MAX);
+                fenceWait += clock::now() - waitStart;
+            }
+            vkResetFences(device_.device(), 1, &fences_[slot]);
+
+            const VkCommandBuffer cmd = commandBuffers_[slot];
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording command buffer");
+            }
+
+            // Accumulating in double keeps long sequences free of float drift.
+            const auto time = static_cast<float>(settings.startTime + static_cast<double>(i) * settings.timeStep);
+            record(cmd, SequenceFrame{ slot, i, time, *targets_[slot] });
+
+            if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record command buffer");
+            }
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &cmd;
+            VKP_PROFILE_SCOPE("vkQueueSubmit");
+            if (vkQueueSubmit(device_.graphicsQueue(), 1, &submitInfo, fences_[slot]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit sequence frame");
+            }
+        }
+        vkWaitForFences(device_.device(), FRAMES_IN_FLIGHT, fences_.data(), VK_TRUE, UINT64_MAX);
+
+        stats.frames      = settings.frameCount;
+        stats.seconds     = std::chrono::duration<double>(clock::now() - start).count();
+        stats.fps         = stats.seconds > 0.0 ? static_cast<double>(stats.frames) / stats.seconds : 0.0;
+        stats.fenceWaitMs = std::chrono::duration<double, std::milli>(fenceWait).count();
+        LOG_INFO("rendered {} frame(s) in {:.2f}s: {:.1f} fps, {:.1f} ms waiting on the GPU",
+                 stats.frames, stats.seconds, stats.fps, stats.fenceWaitMs);
+        return stats;
+    }
+
+} // namespace vkp::graphics
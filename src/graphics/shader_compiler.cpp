@@ -0,0 +1,364 @@
+#include <vkp/graphics/shader_compiler.h>
+#include <vkp/core/job_system.h>
+#include <vkp/core/metrics.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <shaderc/shaderc.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+// Set by CMake from the shaderc package it found.
+#ifndef VKP_SHADERC_VERSION
+    #define VKP_SHADERC_VERSION "unknown"
+#endif
+
+namespace vkp::graphics {
+
+    namespace {
+        // Bump when the cached blobs or the compile options change.
+        constexpr uint32_t CACHE_FORMAT = 1;
+        constexpr uint32_t SPIRV_MAGIC  = 0x07230203;
+        // Nested includes beyond this are a cycle.
+        constexpr size_t   MAX_INCLUDE_DEPTH = 32;
+
+#ifdef NDEBUG
+        constexpr shaderc_optimization_level OPTIMIZATION = shaderc_optimization_level_performance;
+        constexpr bool                       DEBUG_INFO   = false;
+#else
+        constexpr shaderc_optimization_level OPTIMIZATION = shaderc_optimization_level_zero;
+        constexpr bool                       DEBUG_INFO   = true;
+#endif
+
+        struct ShaderMetrics {
+            core::Counter& hits = core::MetricsRegistry::get().counter(
+                "vkp_shader_cache_hits_total", "Shader permutations found in memory or in the SPIR-V cache");
+            core::Counter& compilations = core::MetricsRegistry::get().counter(
+                "vkp_shader_compilations_total", "Shader permutations compiled from GLSL");
+        };
+
+        ShaderMetrics& shaderMetrics() {
+            static ShaderMetrics metrics;
+            return metrics;
+        }
+
+        // Two FNV-1a lanes with different offsets, for a 128-bit key that is stable across runs
+        // and platforms, unlike std::hash.
+        class KeyHasher {
+        public:
+            void add(const void* data, const size_t size) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    lo_ = (lo_ ^ bytes[i]) * PRIME;
+                    hi_ = (hi_ ^ bytes[i]) * PRIME;
+                }
+            }
+            // Length-prefixed, so adjacent strings can't run into each other.
+            void add(const std::string& text) {
+                const uint64_t size = text.size();
+                add(&size, sizeof(size));
+                add(text.data(), text.size());
+            }
+            void add(const uint32_t value) { add(&value, sizeof(value)); }
+
+            [[nodiscard]] std::string hex() const { return fmt::format("{:016x}{:016x}", hi_, lo_); }
+
+        private:
+            static constexpr uint64_t PRIME = 0x100000001b3ULL;
+            uint64_t lo_ = 0xcbf29ce484222325ULL;
+            uint64_t hi_ = 0x84222325cbf29ce4ULL;
+        };
+
+        std::string readText(const std::filesystem::path& path) {
+            std::ifstream file{ path, std::ios::binary };
+            if (!file.is_open()) {
+                throw std::runtime_error("failed to open shader source " + path.string());
+            }
+            std::ostringstream text;
+            text << file.rdbuf();
+            return text.str();
+        }
+
+        shaderc_shader_kind shaderKind(const std::filesystem::path& source) {
+            const std::string extension = source.extension().string();
+            if (extension == ".vert") return shaderc_glsl_vertex_shader;
+            if (extension == ".frag") return shaderc_glsl_fragment_shader;
+            if (extension == ".comp") return shaderc_glsl_compute_shader;
+            throw std::runtime_error("unknown shader stage for " + source.string());
+        }
+
+        // The names in #include "..." and #include <...> lines, in order.
+        std::vector<std::string> includeNames(const std::string& text) {
+            std::vector<std::string> names;
+            std::istringstream lines(text);
+            std::string line;
+            while (std::getline(lines, line)) {
+                size_t at = line.find_first_not_of(" \t");
+                if (at == std::string::npos || line[at] != '#') continue;
+                at = line.find_first_not_of(" \t", at + 1);
+                if (at == std::string::npos || line.compare(at, 7, "include") != 0) continue;
+                at = line.find_first_of("\"<", at + 7);
+                if (at == std::string::npos) continue;
+                const size_t end = line.find(line[at] == '<' ? '>' : '"', at + 1);
+                if (end != std::string::npos) names.push_back(line.substr(at + 1, end - at - 1));
+            }
+            return names;
+        }
+
+        // A permutation's source and everything it includes, read once so the key and the
+        // compiler see the same text.
+        struct SourceSet {
+            struct File {
+                std::string path;   // as handed to the compiler
+                std::string text;
+            };
+            std::filesystem::path   root;
+            std::vector<File>       files;   // the source first, then includes in the order met
+
+            // Relative to the including file, then to the source's directory.
+            [[nodiscard]] std::filesystem::path resolve(const std::string& name, const std::string& includer) const {
+                const std::filesystem::path local = std::filesystem::path(includer).parent_path() / name;
+                if (std::filesystem::exists(local)) return local.lexically_normal();
+                return (root.parent_path() / name).lexically_normal();
+            }
+            [[nodiscard]] const File* find(const std::string& path) const {
+                for (const auto& file : files) {
+                    if (file.path == path) return &file;
+                }
+                return nullptr;
+            }
+
+            void gather(const std::filesystem::path& path, KeyHasher& key, const size_t depth) {
+                if (depth > MAX_INCLUDE_DEPTH) {
+                    throw std::runtime_error("shader includes nested too deep at " + path.string());
+                }
+                const std::string name = path.generic_string();
+                // Include guards make repeated includes no-ops; one copy in the key is enough.
+                if (find(name) != nullptr) return;
+                files.push_back({ name, readText(path) });
+                key.add(name);
+                key.add(files.back().text);
+                for (const auto& include : includeNames(files.back().text)) {
+                    const std::filesystem::path resolved = resolve(include, name);
+                    // Possibly behind an inactive #if; if not, the compiler reports it.
+                    if (!std::filesystem::exists(resolved)) {
+                        key.add("missing " + resolved.generic_string());
+                        continue;
+                    }
+                    gather(resolved, key, depth + 1);
+                }
+            }
+        };
+
+        // Serves #include from the set gathered for the key. Includes inside inactive #if
+        // branches were gathered too, which only makes the key more conservative.
+        class Includer final : public shaderc::CompileOptions::IncluderInterface {
+        public:
+            explicit Includer(const SourceSet& sources) : sources_(sources) {}
+
+            shaderc_include_result* GetInclude(
+                const char* requested, shaderc_include_type, const char* requesting, size_t) override
+            {
+                auto* result = new shaderc_include_result{};
+                const std::string path = sources_.resolve(requested, requesting).generic_string();
+                if (const SourceSet::File* file = sources_.find(path)) {
+                    result->source_name        = file->path.c_str();
+                    result->source_name_length = file->path.size();
+                    result->content            = file->text.c_str();
+                    result->content_length     = file->text.size();
+                } else {
+                    // An empty name tells shaderc the content is the error.
+                    auto* error = new std::string("cannot find include " + path);
+                    result->content        = error->c_str();
+                    result->content_length = error->size();
+                    result->user_data      = error;
+                }
+                return result;
+            }
+
+            void ReleaseInclude(shaderc_include_result* result) override {
+                delete static_cast<std::string*>(result->user_data);
+                delete result;
+            }
+
+        private:
+            const SourceSet& sources_;
+        };
+
+        shaderc::Compiler& compiler() {
+            // shaderc allows concurrent compiles on one compiler.
+            static shaderc::Compiler instance;
+            return instance;
+        }
+
+        bool validSpirv(const std::vector<uint32_t>& words) {
+            return words.size() >= 5 && words[0] == SPIRV_MAGIC;
+        }
+
+        std::vector<uint32_t> readCached(const std::filesystem::path& path) {
+            std::ifstream file{ path, std::ios::binary | std::ios::ate };
+            if (!file.is_open()) return {};
+            const auto size = static_cast<size_t>(file.tellg());
+            if (size % sizeof(uint32_t) != 0) return {};
+            std::vector<uint32_t> words(size / sizeof(uint32_t));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(size));
+            if (!file || !validSpirv(words)) return {};
+            return words;
+        }
+
+        uint64_t processId() {
+#ifdef _WIN32
+            return GetCurrentProcessId();
+#else
+            return static_cast<uint64_t>(getpid());
+#endif
+        }
+
+        // Through a temporary file, so other processes never read a partial blob. The name holds
+        // the process and thread, so concurrent writers of the same entry don't share it.
+        void writeCached(const std::filesystem::path& path, const std::vector<uint32_t>& words) {
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+            const std::filesystem::path temporary = path.string() +
+                fmt::format(".{}.{}.tmp", processId(), std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            {
+                std::ofstream file{ temporary, std::ios::binary | std::ios::trunc };
+                file.write(reinterpret_cast<const char*>(words.data()),
+                           static_cast<std::streamsize>(words.size() * sizeof(uint32_t)));
+                if (!file) {
+                    LOG_WARN("failed to write the shader cache entry {}", path.string());
+                    std::filesystem::remove(temporary, error);
+                    return;
+                }
+            }
+            std::filesystem::rename(temporary, path, error);
+            if (error) {
+                LOG_WARN("failed to write the shader cache entry {}: {}", path.string(), error.message());
+                std::filesystem::remove(temporary, error);
+            }
+        }
+
+        std::string describe(const ShaderPermutation& permutation) {
+            std::string text = permutation.source.generic_string();
+            for (const auto& define : permutation.defines) {
+                text += define.value.empty() ? fmt::format(" -D{}", define.name)
+                                             : fmt::format(" -D{}={}", define.name, define.value);
+            }
+            return text;
+        }
+    }
+
+    ShaderCompiler& ShaderCompiler::get() {
+        static ShaderCompiler instance;
+        return instance;
+    }
+
+    ShaderCompiler::ShaderCompiler()
+        : cacheDir_(CACHE_DIR) {
+        if (!compiler().IsValid()) {
+            throw std::runtime_error("failed to initialize the shader compiler");
+        }
+    }
+
+    std::vector<uint32_t> ShaderCompiler::compile(const ShaderPermutation& permutation) {
+        VKP_PROFILE_SCOPE("ShaderCompiler::compile");
+        const shaderc_shader_kind kind = shaderKind(permutation.source);
+
+        KeyHasher key;
+        key.add(CACHE_FORMAT);
+        key.add(std::string(VKP_SHADERC_VERSION));
+        unsigned spirvVersion = 0, spirvRevision = 0;
+        shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+        key.add(spirvVersion);
+        key.add(spirvRevision);
+        key.add(static_cast<uint32_t>(kind));
+        key.add(static_cast<uint32_t>(OPTIMIZATION));
+        key.add(static_cast<uint32_t>(DEBUG_INFO));
+        // The same set in any order is the same permutation.
+        std::vector<ShaderDefine> defines = permutation.defines;
+        std::sort(defines.begin(), defines.end(),
+                  [](const ShaderDefine& a, const ShaderDefine& b) { return a.name < b.name; });
+        key.add(static_cast<uint32_t>(defines.size()));
+        for (const auto& define : defines) {
+            key.add(define.name);
+            key.add(define.value);
+        }
+        SourceSet sources;
+        sources.root = permutation.source;
+        sources.gather(permutation.source, key, 0);
+        const std::string hex = key.hex();
+
+        {
+            std::lock_guard lock(mutex_);
+            if (const auto found = memory_.find(hex); found != memory_.end()) {
+                shaderMetrics().hits.inc();
+                return found->second;
+            }
+        }
+        const std::filesystem::path cached = cacheDir_ / (hex + ".spv");
+        std::vector<uint32_t> words = readCached(cached);
+        if (!words.empty()) {
+            shaderMetrics().hits.inc();
+        } else {
+            const auto start = std::chrono::steady_clock::now();
+            shaderc::CompileOptions options;
+            for (const auto& define : defines) options.AddMacroDefinition(define.name, define.value);
+            options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+            options.SetOptimizationLevel(OPTIMIZATION);
+            if (DEBUG_INFO) options.SetGenerateDebugInfo();
+            options.SetIncluder(std::make_unique<Includer>(sources));
+
+            const SourceSet::File& main = sources.files.front();
+            const shaderc::SpvCompilationResult result = compiler().CompileGlslToSpv(
+                main.text.data(), main.text.size(), kind, main.path.c_str(), "main", options);
+            if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+                throw std::runtime_error(fmt::format("failed to compile {}:\n{}", describe(permutation),
+                                                     result.GetErrorMessage()));
+            }
+            words.assign(result.cbegin(), result.cend());
+            shaderMetrics().compilations.inc();
+            LOG_INFO("compiled {} in {:.1f} ms", describe(permutation),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            writeCached(cached, words);
+        }
+
+        std::lock_guard lock(mutex_);
+        memory_.emplace(hex, words);
+        return words;
+    }
+
+    std::vector<std::vector<uint32_t>> ShaderCompiler::compile(const std::span<const ShaderPermutation> permutations) {
+        std::vector<std::vector<uint32_t>> results(permutations.size());
+        if (permutations.size() == 1) {
+            results[0] = compile(permutations[0]);
+            return results;
+        }
+        core::JobSystem& jobs = core::JobSystem::get();
+        core::JobCounter compiled;
+        for (size_t i = 0; i < permutations.size(); ++i) {
+            jobs.schedule([this, &results, &permutations, i] { results[i] = compile(permutations[i]); }, &compiled);
+        }
+        jobs.wait(compiled);
+        return results;
+    }
+
+} // namespace vkp::graphics
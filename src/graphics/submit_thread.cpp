@@ -0,0 +1,84 @@
+#include <vkp/graphics/submit_thread.h>
+#include <vkp/core/profiler.h>
+
+#include <utility>
+
+namespace vkp::graphics {
+
+    namespace {
+        // Higher wins when several presents report back before the render thread looks.
+        int severity(const VkResult result) {
+            switch (result) {
+                case VK_SUCCESS:               return 0;
+                case VK_SUBOPTIMAL_KHR:        return 1;
+                case VK_ERROR_OUT_OF_DATE_KHR: return 2;
+                default:                       return 3;
+            }
+        }
+    }
+
+    SubmitThread::SubmitThread()
+        : thread_([this] { run(); }) {}
+
+    SubmitThread::~SubmitThread() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        queued_.notify_one();
+        thread_.join();
+    }
+
+    void SubmitThread::push(const FrameSubmission& frame) {
+        VKP_PROFILE_SCOPE("SubmitThread::push");
+        {
+            std::unique_lock lock(mutex_);
+            presented_.wait(lock, [this] { return pushed_ - done_ < QUEUE_SIZE; });
+            frames_[pushed_ % QUEUE_SIZE] = frame;
+            ++pushed_;
+        }
+        queued_.notify_one();
+    }
+
+    void SubmitThread::waitPending(const uint64_t frames) {
+        VKP_PROFILE_SCOPE("SubmitThread::waitPending");
+        std::unique_lock lock(mutex_);
+        presented_.wait(lock, [this, frames] { return pushed_ - done_ <= frames; });
+    }
+
+    VkResult SubmitThread::takeResult() {
+        std::lock_guard lock(mutex_);
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+        return std::exchange(result_, VK_SUCCESS);
+    }
+
+    void SubmitThread::run() {
+        VKP_PROFILE_THREAD("submit");
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            // Frames still queued at stop are submitted too: their fences are waited on later.
+            queued_.wait(lock, [this] { return stop_ || done_ != pushed_; });
+            if (done_ == pushed_) return;
+
+            // The frame keeps its slot until it is presented, so push can't overwrite it.
+            const FrameSubmission frame = frames_[done_ % QUEUE_SIZE];
+            lock.unlock();
+            VkResult result = VK_SUCCESS;
+            std::exception_ptr error;
+            try {
+                result = frame.swapChain->submitAndPresent(frame);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            if (error && !error_) error_ = error;
+            if (severity(result) > severity(result_)) result_ = result;
+            ++done_;
+            presented_.notify_all();
+        }
+    }
+
+} // namespace vkp::graphics
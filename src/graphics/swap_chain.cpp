@@ -1,4 +1,6 @@
 #include <vkp/graphics/swap_chain.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
 
 #include <array>
 #include <cstdlib>
@@ -10,14 +12,25 @@
 
 namespace vkp::graphics {
 
-SwapChain::SwapChain(Device &deviceRef, const VkExtent2D extent)
-    : device{deviceRef}, windowExtent{extent} {
+SwapChain::SwapChain(
+    Device &deviceRef,
+    const VkExtent2D extent,
+    const VkImageUsageFlags extraUsage,
+    const bool dynamicRendering)
+    : dynamicRendering{dynamicRendering},
+      requestedUsage{extraUsage},
+      device{deviceRef},
+      windowExtent{extent} {
   init();
 }
 
 SwapChain::SwapChain(
     Device &deviceRef, const VkExtent2D extent, std::shared_ptr<SwapChain> previous)
-    : device{deviceRef}, windowExtent{extent}, oldSwapChain{previous} {
+    : dynamicRendering{previous->dynamicRendering},
+      requestedUsage{previous->requestedUsage},
+      device{deviceRef},
+      windowExtent{extent},
+      oldSwapChain{previous} {
   init();
   oldSwapChain = nullptr;
 }
@@ -25,88 +38,125 @@ SwapChain::SwapChain(
 void SwapChain::init() {
   createSwapChain();
   createImageViews();
-  createRenderPass();
-  createDepthResources();
-  createFramebuffers();
+  depthFormat = findDepthFormat();
+  if (!dynamicRendering) {
+    createRenderPass();
+    createDepthResources();
+    createFramebuffers();
+  }
   createSyncObjects();
 }
 
 SwapChain::~SwapChain() {
   for (const auto imageView : swapChainImageViews) {
-    vkDestroyImageView(device.device(), imageView, nullptr);
+    vkDestroyImageView(device.device(), imageView, device.allocator());
   }
   swapChainImageViews.clear();
 
   if (swapChain != nullptr) {
-    vkDestroySwapchainKHR(device.device(), swapChain, nullptr);
+    vkDestroySwapchainKHR(device.device(), swapChain, device.allocator());
     swapChain = nullptr;
   }
 
   for (int i = 0; i < depthImages.size(); i++) {
-    vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-    vkDestroyImage(device.device(), depthImages[i], nullptr);
-    vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+    vkDestroyImageView(device.device(), depthImageViews[i], device.allocator());
+    vkDestroyImage(device.device(), depthImages[i], device.allocator());
+    device.freeMemory(depthImageMemorys[i]);
   }
 
   for (auto framebuffer : swapChainFramebuffers) {
-    vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
+    vkDestroyFramebuffer(device.device(), framebuffer, device.allocator());
   }
 
-  vkDestroyRenderPass(device.device(), renderPass, nullptr);
+  if (renderPass != VK_NULL_HANDLE) {
+    vkDestroyRenderPass(device.device(), renderPass, device.allocator());
+  }
 
-  // cleanup synchronization objects
-  for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
-    vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-    vkDestroyFence(device.device(), inFlightFences[i], nullptr);
+  // cleanup synchronization objects, unless they were handed to a successor
+  for (size_t i = 0; i < inFlightFences.size(); i++) {
+    vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], device.allocator());
+    vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], device.allocator());
+    vkDestroyFence(device.device(), inFlightFences[i], device.allocator());
   }
 }
 
 VkResult SwapChain::acquireNextImage(uint32_t *imageIndex) const {
-  vkWaitForFences(
-      device.device(),
-      1,
-      &inFlightFences[currentFrame],
-      VK_TRUE,
-      std::numeric_limits<uint64_t>::max());
-
-  VkResult result = vkAcquireNextImageKHR(
-      device.device(),
-      swapChain,
-      std::numeric_limits<uint64_t>::max(),
-      imageAvailableSemaphores[currentFrame],  // must be a not signaled semaphore
-      VK_NULL_HANDLE,
-      imageIndex);
+  VKP_PROFILE_SCOPE("SwapChain::acquireNextImage");
+  {
+    VKP_PROFILE_SCOPE("wait frame fence");
+    vkWaitForFences(
+        device.device(),
+        1,
+        &inFlightFences[currentFrame],
+        VK_TRUE,
+        std::numeric_limits<uint64_t>::max());
+  }
+
+  VKP_PROFILE_SCOPE("vkAcquireNextImageKHR");
+  // Waiting in slices keeps a present on the submit thread from being held up for a whole vsync.
+  VkResult result;
+  do {
+    std::lock_guard lock(hostAccess);
+    result = vkAcquireNextImageKHR(
+        device.device(),
+        swapChain,
+        ACQUIRE_SLICE_NS,
+        imageAvailableSemaphores[currentFrame],  // must be a not signaled semaphore
+        VK_NULL_HANDLE,
+        imageIndex);
+  } while (result == VK_TIMEOUT || result == VK_NOT_READY);
 
   return result;
 }
 
 VkResult SwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, const uint32_t *imageIndex) {
-  if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-    vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
+  return submitAndPresent(prepareSubmit(*buffers, *imageIndex));
+}
+
+FrameSubmission SwapChain::prepareSubmit(const VkCommandBuffer buffer, const uint32_t imageIndex) {
+  VKP_PROFILE_SCOPE("SwapChain::prepareSubmit");
+  if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
+    VKP_PROFILE_SCOPE("wait image fence");
+    vkWaitForFences(device.device(), 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
   }
-  imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
+  imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+  vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
+
+  FrameSubmission frame{};
+  frame.swapChain = this;
+  frame.commandBuffer = buffer;
+  frame.imageIndex = imageIndex;
+  frame.imageAvailable = imageAvailableSemaphores[currentFrame];
+  frame.renderFinished = renderFinishedSemaphores[currentFrame];
+  frame.inFlightFence = inFlightFences[currentFrame];
+
+  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+  return frame;
+}
 
+VkResult SwapChain::submitAndPresent(const FrameSubmission &frame) {
+  VKP_PROFILE_SCOPE("SwapChain::submitAndPresent");
   VkSubmitInfo submitInfo = {};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-  VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
+  VkSemaphore waitSemaphores[] = {frame.imageAvailable};
   VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
   submitInfo.waitSemaphoreCount = 1;
   submitInfo.pWaitSemaphores = waitSemaphores;
   submitInfo.pWaitDstStageMask = waitStages;
 
   submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = buffers;
+  submitInfo.pCommandBuffers = &frame.commandBuffer;
 
-  VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
+  VkSemaphore signalSemaphores[] = {frame.renderFinished};
   submitInfo.signalSemaphoreCount = 1;
   submitInfo.pSignalSemaphores = signalSemaphores;
 
-  vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
-  if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) !=
-      VK_SUCCESS) {
-    throw std::runtime_error("failed to submit draw command buffer!");
+  {
+    VKP_PROFILE_SCOPE("vkQueueSubmit");
+    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, frame.inFlightFence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to submit draw command buffer!");
+    }
   }
 
   VkPresentInfoKHR presentInfo = {};
@@ -119,22 +169,26 @@ VkResult SwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, const u
   presentInfo.swapchainCount = 1;
   presentInfo.pSwapchains = swapChains;
 
-  presentInfo.pImageIndices = imageIndex;
-
-  auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
-
-  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+  presentInfo.pImageIndices = &frame.imageIndex;
 
+  VkResult result;
+  {
+    VKP_PROFILE_SCOPE("vkQueuePresentKHR");
+    std::lock_guard lock(hostAccess);
+    result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+  }
   return result;
 }
 
 void SwapChain::createSwapChain() {
-  auto [capabilities, formats, presentModes] = device.getSwapChainSupport();
+  // Formats and present modes come from the device snapshot; only the capabilities follow the window.
+  const VkSurfaceCapabilitiesKHR capabilities = device.getSurfaceCapabilities();
 
-  auto [format, colorSpace] = chooseSwapSurfaceFormat(formats);
-  VkPresentModeKHR presentMode = chooseSwapPresentMode(presentModes);
+  auto [format, colorSpace] = chooseSwapSurfaceFormat(device.caps().surfaceFormats);
+  VkPresentModeKHR presentMode = chooseSwapPresentMode(device.caps().presentModes);
   VkExtent2D extent = chooseSwapExtent(capabilities);
 
+  minImageCount = capabilities.minImageCount;
   uint32_t imageCount = capabilities.minImageCount + 1;
   // Clamp image count to max if the surface imposes a limit.
   if (capabilities.maxImageCount > 0 &&
@@ -151,9 +205,13 @@ void SwapChain::createSwapChain() {
   createInfo.imageColorSpace = colorSpace;
   createInfo.imageExtent = extent;
   createInfo.imageArrayLayers = 1;
-  createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  // Extra usage can cost the driver its compressed layouts, so it is only requested on demand
+  // and only the bits the surface supports.
+  imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+               (requestedUsage & capabilities.supportedUsageFlags);
+  createInfo.imageUsage = imageUsage;
 
-  QueueFamilyIndices indices = device.findPhysicalQueueFamilies();
+  const QueueFamilyIndices &indices = device.findPhysicalQueueFamilies();
   uint32_t queueFamilyIndices[] = {indices.graphicsFamily, indices.presentFamily};
 
   // If graphics and present queues are different, enable concurrent sharing.
@@ -175,7 +233,7 @@ void SwapChain::createSwapChain() {
 
   createInfo.oldSwapchain = oldSwapChain == nullptr ? VK_NULL_HANDLE : oldSwapChain->swapChain;
 
-  if (vkCreateSwapchainKHR(device.device(), &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
+  if (vkCreateSwapchainKHR(device.device(), &createInfo, device.allocator(), &swapChain) != VK_SUCCESS) {
     throw std::runtime_error("failed to create swap chain!");
   }
 
@@ -202,7 +260,7 @@ void SwapChain::createImageViews() {
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
-    if (vkCreateImageView(device.device(), &viewInfo, nullptr, &swapChainImageViews[i]) !=
+    if (vkCreateImageView(device.device(), &viewInfo, device.allocator(), &swapChainImageViews[i]) !=
         VK_SUCCESS) {
       throw std::runtime_error("failed to create texture image view!");
     }
@@ -211,7 +269,7 @@ void SwapChain::createImageViews() {
 
 void SwapChain::createRenderPass() {
   VkAttachmentDescription depthAttachment{};
-  depthAttachment.format = findDepthFormat();
+  depthAttachment.format = depthFormat;
   depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
   depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
   depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -263,7 +321,7 @@ void SwapChain::createRenderPass() {
   renderPassInfo.dependencyCount = 1;
   renderPassInfo.pDependencies = &dependency;
 
-  if (vkCreateRenderPass(device.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+  if (vkCreateRenderPass(device.device(), &renderPassInfo, device.allocator(), &renderPass) != VK_SUCCESS) {
     throw std::runtime_error("failed to create render pass!");
   }
 }
@@ -286,7 +344,7 @@ void SwapChain::createFramebuffers() {
     if (vkCreateFramebuffer(
             device.device(),
             &framebufferInfo,
-            nullptr,
+            device.allocator(),
             &swapChainFramebuffers[i]) != VK_SUCCESS) {
       throw std::runtime_error("failed to create framebuffer!");
     }
@@ -294,7 +352,6 @@ void SwapChain::createFramebuffers() {
 }
 
 void SwapChain::createDepthResources() {
-  VkFormat depthFormat = findDepthFormat();
   auto [width, height] = getSwapChainExtent();
 
   depthImages.resize(imageCount());
@@ -322,7 +379,8 @@ void SwapChain::createDepthResources() {
         imageInfo,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         depthImages[i],
-        depthImageMemorys[i]);
+        depthImageMemorys[i],
+        MemoryCategory::SwapchainDepth);
 
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -335,17 +393,31 @@ void SwapChain::createDepthResources() {
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
-    if (vkCreateImageView(device.device(), &viewInfo, nullptr, &depthImageViews[i]) != VK_SUCCESS) {
+    if (vkCreateImageView(device.device(), &viewInfo, device.allocator(), &depthImageViews[i]) != VK_SUCCESS) {
       throw std::runtime_error("failed to create texture image view!");
     }
   }
 }
 
 void SwapChain::createSyncObjects() {
+  imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+
+  // Frame fences carry over from the previous swap chain, so waiting on a frame slot still covers
+  // the frames submitted before the recreation and nothing has to wait for the device.
+  if (oldSwapChain != nullptr) {
+    imageAvailableSemaphores = std::move(oldSwapChain->imageAvailableSemaphores);
+    renderFinishedSemaphores = std::move(oldSwapChain->renderFinishedSemaphores);
+    inFlightFences = std::move(oldSwapChain->inFlightFences);
+    currentFrame = oldSwapChain->currentFrame;
+    oldSwapChain->imageAvailableSemaphores.clear();
+    oldSwapChain->renderFinishedSemaphores.clear();
+    oldSwapChain->inFlightFences.clear();
+    return;
+  }
+
   imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
   renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
   inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-  imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
 
   VkSemaphoreCreateInfo semaphoreInfo = {};
   semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -355,11 +427,11 @@ void SwapChain::createSyncObjects() {
   fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
   for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
+    if (vkCreateSemaphore(device.device(), &semaphoreInfo, device.allocator(), &imageAvailableSemaphores[i]) !=
             VK_SUCCESS ||
-        vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) !=
+        vkCreateSemaphore(device.device(), &semaphoreInfo, device.allocator(), &renderFinishedSemaphores[i]) !=
             VK_SUCCESS ||
-        vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+        vkCreateFence(device.device(), &fenceInfo, device.allocator(), &inFlightFences[i]) != VK_SUCCESS) {
       throw std::runtime_error("failed to create synchronization objects for a frame!");
     }
   }
@@ -381,7 +453,7 @@ VkPresentModeKHR SwapChain::chooseSwapPresentMode(
     const std::vector<VkPresentModeKHR> &availablePresentModes) const {
   for (const auto &availablePresentMode : availablePresentModes) {
     if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-      std::cout << "Present mode: Mailbox" << std::endl;
+      LOG_INFO("Present mode: Mailbox");
       return availablePresentMode;
     }
   }
@@ -394,7 +466,7 @@ VkPresentModeKHR SwapChain::chooseSwapPresentMode(
   //   }
   // }
 
-  std::cout << "Present mode: V-Sync" << std::endl;
+  LOG_INFO("Present mode: V-Sync");
   return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -0,0 +1,405 @@
+#include <vkp/graphics/temporal_reconstruction.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace vkp::graphics {
+
+    static constexpr auto SCENE_VERT_SHADER_PATH  = "shaders/sb_shader.vert";
+    static constexpr auto SPARSE_FRAG_SHADER_PATH = "shaders/sb_sparse.frag";
+    static constexpr auto FULLSCREEN_SHADER_PATH  = "shaders/fullscreen.vert";
+    static constexpr auto RESOLVE_SHADER_PATH     = "shaders/temporal_resolve.frag";
+    static constexpr auto COMPOSITE_SHADER_PATH   = "shaders/temporal_composite.frag";
+
+    // Pattern ids in the low nibble of the sparse word; must match sb_sparse.frag.
+    static constexpr uint32_t PATTERN_CHECKERBOARD = 1;
+    static constexpr uint32_t PATTERN_QUARTER      = 2;
+    // Quarter mode visits the 2x2 block diagonally first, so two consecutive frames already
+    // cover both rows and columns.
+    static constexpr uint32_t QUARTER_PHASES[4] = { 0, 3, 1, 2 };
+
+    namespace {
+        ImportedImage outputImport(const VkFormat format, const VkExtent2D extent) {
+            ImportedImage output{};
+            output.format        = format;
+            output.extent        = extent;
+            output.initialStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;   // acquire semaphore wait
+            output.finalLayout   = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            output.finalStages   = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            return output;
+        }
+
+        // History images rest in SHADER_READ_ONLY between frames, where the composite pass leaves
+        // them. The one written this frame is cleared first, so its previous layout doesn't matter.
+        ImportedImage historyImport(const VkExtent2D extent) {
+            ImportedImage history{};
+            history.format        = TemporalReconstruction::HISTORY_FORMAT;
+            history.extent        = extent;
+            history.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            history.initialStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            return history;
+        }
+    }
+
+    TemporalReconstruction::TemporalReconstruction(
+        Device& device,
+        const TemporalMode mode,
+        const VkExtent2D extent,
+        const uint32_t frameSlots,
+        const VkFormat outputFormat,
+        const VkFormat depthFormat,
+        const VkPipelineLayout sceneLayout,
+        SceneFn scene,
+        OverlayFn overlay,
+        const TemporalReconstruction* previous)
+        : device_(device)
+        , mode_(mode)
+        , extent_(extent)
+        , scene_(std::move(scene))
+        , overlay_(std::move(overlay))
+    {
+        if (mode == TemporalMode::Off) {
+            throw std::runtime_error("temporal reconstruction needs a sparse mode");
+        }
+        sparseExtent_ = mode == TemporalMode::Checkerboard
+            ? VkExtent2D{ (extent.width + 1) / 2, extent.height }
+            : VkExtent2D{ (extent.width + 1) / 2, (extent.height + 1) / 2 };
+
+        // Sized before building: the pass callbacks keep references to their Graph.
+        sparse_.resize(frameSlots);
+        refresh_.resize(frameSlots);
+        resolveSets_.resize(frameSlots);
+
+        for (auto& history : history_) createHistory(history);
+        createDescriptors();
+        createPipelines(outputFormat, depthFormat, sceneLayout, previous);
+        for (uint32_t slot = 0; slot < frameSlots; slot++) {
+            buildSparseGraph(sparse_[slot], slot, outputFormat, depthFormat);
+            buildRefreshGraph(refresh_[slot], outputFormat, depthFormat);
+        }
+        writeDescriptors();
+    }
+
+    TemporalReconstruction::~TemporalReconstruction() {
+        const VkDevice dev = device_.device();
+        sparse_.clear();
+        refresh_.clear();
+        shadePipeline_.reset();
+        resolvePipeline_.reset();
+        compositePipeline_.reset();
+        vkDestroyPipelineLayout(dev, resolveLayout_, device_.allocator());
+        vkDestroyPipelineLayout(dev, compositeLayout_, device_.allocator());
+        vkDestroyDescriptorPool(dev, descriptorPool_, device_.allocator());
+        vkDestroyDescriptorSetLayout(dev, resolveSetLayout_, device_.allocator());
+        vkDestroyDescriptorSetLayout(dev, compositeSetLayout_, device_.allocator());
+        vkDestroySampler(dev, sampler_, device_.allocator());
+        for (auto& history : history_) {
+            vkDestroyImageView(dev, history.view, device_.allocator());
+            vkDestroyImage(dev, history.image, device_.allocator());
+            device_.freeMemory(history.memory);
+        }
+    }
+
+    void TemporalReconstruction::createHistory(History& history) const {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+        imageInfo.extent        = { extent_.width, extent_.height, 1 };
+        imageInfo.mipLevels     = 1;
+        imageInfo.arrayLayers   = 1;
+        imageInfo.format        = HISTORY_FORMAT;
+        imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage         = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        device_.createImageWithInfo(
+            imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, history.image, history.memory, MemoryCategory::RenderTarget);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image            = history.image;
+        viewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format           = HISTORY_FORMAT;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        if (vkCreateImageView(device_.device(), &viewInfo, device_.allocator(), &history.view) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create history image view");
+        }
+    }
+
+    void TemporalReconstruction::createDescriptors() {
+        const VkDevice dev = device_.device();
+
+        // Everything is read with texelFetch; the sampler only completes the combined descriptors.
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        if (vkCreateSampler(dev, &samplerInfo, device_.allocator(), &sampler_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create temporal sampler");
+        }
+
+        // Resolve: current sparse samples and previous history. Composite: the new history.
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        for (uint32_t i = 0; i < bindings.size(); i++) {
+            bindings[i].binding         = i;
+            bindings[i].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+        }
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+        setLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInfo.bindingCount = 2;
+        setLayoutInfo.pBindings    = bindings.data();
+        if (vkCreateDescriptorSetLayout(dev, &setLayoutInfo, device_.allocator(), &resolveSetLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create resolve descriptor set layout");
+        }
+        setLayoutInfo.bindingCount = 1;
+        if (vkCreateDescriptorSetLayout(dev, &setLayoutInfo, device_.allocator(), &compositeSetLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create composite descriptor set layout");
+        }
+
+        VkPushConstantRange pushRange{};
+        pushRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushRange.size       = sizeof(uint32_t);
+
+        VkPipelineLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount         = 1;
+        layoutInfo.pSetLayouts            = &resolveSetLayout_;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges    = &pushRange;
+        if (vkCreatePipelineLayout(dev, &layoutInfo, device_.allocator(), &resolveLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create resolve pipeline layout");
+        }
+        layoutInfo.pSetLayouts            = &compositeSetLayout_;
+        layoutInfo.pushConstantRangeCount = 0;
+        layoutInfo.pPushConstantRanges    = nullptr;
+        if (vkCreatePipelineLayout(dev, &layoutInfo, device_.allocator(), &compositeLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create composite pipeline layout");
+        }
+
+        // Two resolve sets (two images each) per frame slot and two composite sets.
+        const auto resolveCount = static_cast<uint32_t>(resolveSets_.size() * 2);
+        VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, resolveCount * 2 + 2 };
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = resolveCount + 2;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes    = &poolSize;
+        if (vkCreateDescriptorPool(dev, &poolInfo, device_.allocator(), &descriptorPool_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create temporal descriptor pool");
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(resolveCount, resolveSetLayout_);
+        layouts.push_back(compositeSetLayout_);
+        layouts.push_back(compositeSetLayout_);
+        std::vector<VkDescriptorSet> sets(layouts.size());
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool     = descriptorPool_;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+        allocInfo.pSetLayouts        = layouts.data();
+        if (vkAllocateDescriptorSets(dev, &allocInfo, sets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate temporal descriptor sets");
+        }
+        for (size_t slot = 0; slot < resolveSets_.size(); slot++) {
+            resolveSets_[slot] = { sets[slot * 2], sets[slot * 2 + 1] };
+        }
+        compositeSets_ = { sets[resolveCount], sets[resolveCount + 1] };
+    }
+
+    void TemporalReconstruction::createPipelines(
+        const VkFormat outputFormat, const VkFormat depthFormat, const VkPipelineLayout sceneLayout,
+        const TemporalReconstruction* previous)
+    {
+        // Full-screen passes that overwrite every pixel: no depth test.
+        PipelineConfigInfo conf{};
+        Pipeline::defaultPipelineConfigInfo(conf);
+        conf.depthStencilInfo.depthTestEnable  = VK_FALSE;
+        conf.depthStencilInfo.depthWriteEnable = VK_FALSE;
+
+        // Compile the stages that miss the shader cache in parallel.
+        enum Stage { SceneVert, SparseFrag, FullscreenVert, ResolveFrag, CompositeFrag };
+        const ShaderPermutation stages[] = {
+            SCENE_VERT_SHADER_PATH, SPARSE_FRAG_SHADER_PATH, FULLSCREEN_SHADER_PATH, RESOLVE_SHADER_PATH,
+            COMPOSITE_SHADER_PATH,
+        };
+        try {
+            spirv_ = ShaderCompiler::get().compile(stages);
+        } catch (const std::exception& e) {
+            // A resize after a broken shader edit keeps rendering with the shaders that worked.
+            if (previous == nullptr) throw;
+            LOG_ERROR("temporal reconstruction: {}; keeping the previous pipelines", e.what());
+            spirv_ = previous->spirv_;
+        }
+        const auto modules = [this](const Stage vert, const Stage frag) {
+            return Pipeline::createShaderModules(device_, spirv_[vert], spirv_[frag]);
+        };
+
+        conf.pipelineLayout        = sceneLayout;
+        conf.colorAttachmentFormat = HISTORY_FORMAT;
+        shadePipeline_ = std::make_unique<Pipeline>(device_, modules(SceneVert, SparseFrag), conf);
+
+        conf.pipelineLayout = resolveLayout_;
+        resolvePipeline_ = std::make_unique<Pipeline>(device_, modules(FullscreenVert, ResolveFrag), conf);
+
+        // Shares the pass with the overlay, so it renders with the swap chain's depth format too.
+        conf.pipelineLayout        = compositeLayout_;
+        conf.colorAttachmentFormat = outputFormat;
+        conf.depthAttachmentFormat = depthFormat;
+        compositePipeline_ = std::make_unique<Pipeline>(device_, modules(FullscreenVert, CompositeFrag), conf);
+    }
+
+    void TemporalReconstruction::buildSparseGraph(
+        Graph& g, const uint32_t slot, const VkFormat outputFormat, const VkFormat depthFormat)
+    {
+        g.graph = std::make_unique<RenderGraph>(device_);
+
+        g.output  = g.graph->importImage("output", outputImport(outputFormat, extent_));
+        g.next    = g.graph->importImage("history_next", historyImport(extent_));
+        g.prev    = g.graph->importImage("history_prev", historyImport(extent_));
+        g.current = g.graph->createImage("current", { HISTORY_FORMAT, sparseExtent_ });
+        const ResourceId depth = g.graph->createImage("depth", { depthFormat, extent_ });
+
+        g.graph->addPass(
+            "shade",
+            [&g](PassBuilder& pass) { pass.colorAttachment(g.current, VkClearColorValue{}); },
+            [this](const VkCommandBuffer cmd, const RenderGraph&) {
+                scene_(cmd, sparseExtent_, extent_, sparseWord_, *shadePipeline_);
+            });
+        g.graph->addPass(
+            "resolve",
+            [&g](PassBuilder& pass) {
+                pass.read(g.current, ResourceUsage::SampledFragment);
+                pass.read(g.prev, ResourceUsage::SampledFragment);
+                pass.colorAttachment(g.next, VkClearColorValue{});
+            },
+            [this, slot](const VkCommandBuffer cmd, const RenderGraph&) {
+                setViewport(cmd, extent_);
+                resolvePipeline_->bind(cmd);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, resolveLayout_, 0, 1,
+                                        &resolveSets_[slot][parity_], 0, nullptr);
+                vkCmdPushConstants(cmd, resolveLayout_, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &sparseWord_);
+                vkCmdDraw(cmd, 3, 1, 0, 0);
+            });
+        addCompositePass(g, depth);
+        g.graph->compile();
+    }
+
+    void TemporalReconstruction::buildRefreshGraph(Graph& g, const VkFormat outputFormat, const VkFormat depthFormat) {
+        // Shades every pixel straight into the new history; used whenever the old one can't be trusted.
+        g.graph = std::make_unique<RenderGraph>(device_);
+
+        g.output = g.graph->importImage("output", outputImport(outputFormat, extent_));
+        g.next   = g.graph->importImage("history_next", historyImport(extent_));
+        const ResourceId depth = g.graph->createImage("depth", { depthFormat, extent_ });
+
+        g.graph->addPass(
+            "shade_full",
+            [&g](PassBuilder& pass) { pass.colorAttachment(g.next, VkClearColorValue{}); },
+            [this](const VkCommandBuffer cmd, const RenderGraph&) {
+                scene_(cmd, extent_, extent_, 0, *shadePipeline_);
+            });
+        addCompositePass(g, depth);
+        g.graph->compile();
+    }
+
+    void TemporalReconstruction::addCompositePass(Graph& g, const ResourceId depth) const {
+        g.graph->addPass(
+            "composite",
+            [&g, depth](PassBuilder& pass) {
+                pass.read(g.next, ResourceUsage::SampledFragment);
+                pass.colorAttachment(g.output, VkClearColorValue{{0.01f, 0.01f, 0.01f, 1.0f}});
+                pass.depthAttachment(depth, 1.0f);
+            },
+            [this](const VkCommandBuffer cmd, const RenderGraph&) {
+                setViewport(cmd, extent_);
+                compositePipeline_->bind(cmd);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, compositeLayout_, 0, 1,
+                                        &compositeSets_[parity_], 0, nullptr);
+                vkCmdDraw(cmd, 3, 1, 0, 0);
+                if (overlay_) overlay_(cmd, extent_);
+            });
+    }
+
+    void TemporalReconstruction::writeDescriptors() {
+        // The views never change: each slot's sparse target is owned by its sparse graph and the
+        // history images only swap roles, which the per-parity sets cover.
+        std::vector<VkDescriptorImageInfo> images;
+        std::vector<VkDescriptorSet>       sets;
+        std::vector<uint32_t>              bindings;
+        const auto add = [&](const VkDescriptorSet set, const uint32_t binding, const VkImageView view) {
+            images.push_back({ sampler_, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+            sets.push_back(set);
+            bindings.push_back(binding);
+        };
+        for (uint32_t parity = 0; parity < 2; parity++) {
+            for (size_t slot = 0; slot < sparse_.size(); slot++) {
+                add(resolveSets_[slot][parity], 0, sparse_[slot].graph->view(sparse_[slot].current));
+                add(resolveSets_[slot][parity], 1, history_[parity ^ 1].view);
+            }
+            add(compositeSets_[parity], 0, history_[parity].view);
+        }
+
+        std::vector<VkWriteDescriptorSet> writes(images.size());
+        for (size_t i = 0; i < writes.size(); i++) {
+            auto& write = writes[i];
+            write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet          = sets[i];
+            write.dstBinding      = bindings[i];
+            write.descriptorCount = 1;
+            write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo      = &images[i];
+        }
+        vkUpdateDescriptorSets(device_.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void TemporalReconstruction::setViewport(const VkCommandBuffer cmd, const VkExtent2D extent) const {
+        VkViewport viewport{};
+        viewport.width    = static_cast<float>(extent.width);
+        viewport.height   = static_cast<float>(extent.height);
+        viewport.maxDepth = 1.0f;
+        VkRect2D scissor{{0, 0}, extent};
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
+    }
+
+    uint32_t TemporalReconstruction::patternWord() const {
+        if (mode_ == TemporalMode::Checkerboard) return PATTERN_CHECKERBOARD | ((phase_ & 1) << 4);
+        return PATTERN_QUARTER | (QUARTER_PHASES[phase_ & 3] << 4);
+    }
+
+    void TemporalReconstruction::execute(
+        const VkCommandBuffer cmd, const uint32_t frameSlot, const VkImage output, const VkImageView outputView,
+        const float time)
+    {
+        VKP_PROFILE_SCOPE("TemporalReconstruction::execute");
+        // The camera is fixed, so the only cuts are jumps in scene time (a stall or a seek).
+        const bool refresh = !historyValid_ || std::abs(time - lastTime_) > MAX_TIME_STEP;
+        parity_ ^= 1;
+
+        Graph& g = refresh ? refresh_[frameSlot] : sparse_[frameSlot];
+        g.graph->bindImage(g.output, output, outputView);
+        g.graph->bindImage(g.next, history_[parity_].image, history_[parity_].view);
+        if (refresh) {
+            sparseWord_ = 0;
+            ++refreshes_;
+            LOG_DEBUG("temporal history refreshed ({} total)", refreshes_);
+        } else {
+            g.graph->bindImage(g.prev, history_[parity_ ^ 1].image, history_[parity_ ^ 1].view);
+            sparseWord_ = patternWord();
+            ++phase_;
+        }
+        g.graph->execute(cmd);
+
+        historyValid_ = true;
+        lastTime_     = time;
+    }
+
+} // namespace vkp::graphics
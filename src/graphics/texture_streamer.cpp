@@ -0,0 +1,504 @@
+#include <vkp/graphics/texture_streamer.h>
+#include <vkp/core/metrics.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+namespace vkp::graphics {
+
+    namespace {
+        struct TextureMetrics {
+            core::Counter& uploadedBytes = core::MetricsRegistry::get().counter(
+                "vkp_texture_upload_bytes_total", "Texture bytes uploaded from staging buffers");
+            core::Counter& evictions = core::MetricsRegistry::get().counter(
+                "vkp_texture_evictions_total", "Texture mip levels evicted to stay within the residency budget");
+            core::Gauge& residentBytes = core::MetricsRegistry::get().gauge(
+                "vkp_texture_resident_bytes", "Device memory held by streamed textures");
+        };
+
+        TextureMetrics& textureMetrics() {
+            static TextureMetrics metrics;
+            return metrics;
+        }
+
+        VkExtent2D levelExtent(const Ktx2Image& header, const uint32_t level) {
+            return { std::max(header.width >> level, 1u), std::max(header.height >> level, 1u) };
+        }
+
+        VkImageMemoryBarrier imageBarrier(
+            const VkImage image, const uint32_t firstLevel, const uint32_t levels,
+            const VkImageLayout oldLayout, const VkImageLayout newLayout,
+            const VkAccessFlags srcAccess, const VkAccessFlags dstAccess)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout           = oldLayout;
+            barrier.newLayout           = newLayout;
+            barrier.srcAccessMask       = srcAccess;
+            barrier.dstAccessMask       = dstAccess;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image               = image;
+            barrier.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, firstLevel, levels, 0, 1 };
+            return barrier;
+        }
+
+        // Wherever a texture may be sampled.
+        constexpr VkPipelineStageFlags SAMPLING_STAGES =
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+
+    TextureStreamer::TextureStreamer(Device& device, const VkDeviceSize budget)
+        : device_(device)
+        , budget_(budget)
+    {
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType            = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter        = VK_FILTER_LINEAR;
+        samplerInfo.minFilter        = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode       = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.addressModeU     = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeV     = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW     = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        // Device requires samplerAnisotropy.
+        samplerInfo.anisotropyEnable = VK_TRUE;
+        samplerInfo.maxAnisotropy    = std::min(16.f, device_.properties.limits.maxSamplerAnisotropy);
+        samplerInfo.maxLod           = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(device_.device(), &samplerInfo, device_.allocator(), &sampler_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture sampler");
+        }
+    }
+
+    TextureStreamer::~TextureStreamer() {
+        // The jobs catch their own errors.
+        core::JobSystem::get().wait(jobs_);
+
+        const VkDevice dev = device_.device();
+        for (auto& staged : staged_) ready_.push_back(std::move(staged));
+        for (const auto& staged : ready_) {
+            vkDestroyBuffer(dev, staged.buffer, device_.allocator());
+            device_.freeMemory(staged.memory);
+        }
+        retired_.flush();
+        for (const auto& texture : textures_) {
+            vkDestroyImageView(dev, texture.view, device_.allocator());
+            vkDestroyImage(dev, texture.image, device_.allocator());
+            device_.freeMemory(texture.memory);
+        }
+        vkDestroySampler(dev, sampler_, device_.allocator());
+        textureMetrics().residentBytes.set(0.0);
+    }
+
+    TextureId TextureStreamer::load(std::filesystem::path path) {
+        const auto id = static_cast<TextureId>(textures_.size());
+        Texture& texture = textures_.emplace_back();
+        texture.path = path;
+        texture.name = path.filename().string();
+
+        core::JobSystem::get().schedule([this, id, path = std::move(path)] {
+            VKP_PROFILE_SCOPE("TextureStreamer::load");
+            Loaded loaded{ id, nullptr, {}, false };
+            try {
+                loaded.file   = std::make_shared<core::MappedFile>(path);
+                loaded.header = parseKtx2(loaded.file->data(), loaded.file->size());
+            } catch (const std::exception& e) {
+                LOG_ERROR("failed to load texture {}: {}", path.string(), e.what());
+                loaded.failed = true;
+            }
+            std::lock_guard lock(mutex_);
+            loaded_.push_back(std::move(loaded));
+        }, &jobs_);
+        return id;
+    }
+
+    void TextureStreamer::touch(const TextureId id) {
+        textures_[id].lastUsed = frameNumber_;
+    }
+
+    void TextureStreamer::retire(std::function<void()> destroy) {
+        retired_.retire(frameNumber_ + 1, std::move(destroy));
+    }
+
+    VkExtent2D TextureStreamer::residentExtent(const TextureId id) const {
+        const Texture& texture = textures_[id];
+        return texture.residentMip == NONE ? VkExtent2D{ 0, 0 } : levelExtent(texture.header, texture.residentMip);
+    }
+
+    VkExtent2D TextureStreamer::extent(const TextureId id) const {
+        return { textures_[id].header.width, textures_[id].header.height };
+    }
+
+    void TextureStreamer::finishLoad(Loaded& loaded) {
+        Texture& texture = textures_[loaded.id];
+        if (loaded.failed) {
+            texture.state = State::Failed;
+            return;
+        }
+
+        const Ktx2Image& header = loaded.header;
+        const auto& caps = device_.caps();
+        if (!caps.supportsFormat(header.format, VK_IMAGE_TILING_OPTIMAL,
+                                 VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT)) {
+            LOG_ERROR("texture {}: format {} can't be sampled on this device", texture.name,
+                      static_cast<int>(header.format));
+            texture.state = State::Failed;
+            return;
+        }
+        bool generate = header.generateMips;
+        if (generate && !caps.supportsFormat(header.format, VK_IMAGE_TILING_OPTIMAL,
+                                             VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                             VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+            LOG_WARN("texture {}: format {} can't be blitted, sampling the base level only", texture.name,
+                     static_cast<int>(header.format));
+            generate = false;
+        }
+
+        texture.mipCount = generate ? fullMipCount(header.width, header.height)
+                                    : static_cast<uint32_t>(header.levels.size());
+        texture.tailMip = texture.mipCount - 1;
+        for (uint32_t level = 0; level < texture.mipCount; ++level) {
+            const VkExtent2D size = levelExtent(header, level);
+            if (std::max(size.width, size.height) <= TAIL_SIZE) {
+                texture.tailMip = level;
+                break;
+            }
+        }
+        // Staging offsets must be multiples of 4 and of the texel block size.
+        texture.alignment = std::lcm<VkDeviceSize>(header.blockBytes, 16);
+
+        texture.file   = std::move(loaded.file);
+        texture.header = std::move(loaded.header);
+        texture.state  = State::Ready;
+        LOG_INFO("texture {}: {}x{}, {} of {} levels in the file, tail from level {}", texture.name,
+                 header.width, header.height, texture.header.levels.size(), texture.mipCount, texture.tailMip);
+    }
+
+    uint32_t TextureStreamer::nextMip(const Texture& texture) const {
+        if (texture.state != State::Ready || texture.stagingMip != NONE) return NONE;
+        const auto fileLevels = static_cast<uint32_t>(texture.header.levels.size());
+        // Generated levels can only be rebuilt from the base level.
+        if (texture.residentMip == NONE) return fileLevels < texture.mipCount ? 0 : texture.tailMip;
+        if (texture.residentMip == 0) return NONE;
+        return texture.residentMip - 1 < fileLevels ? texture.residentMip - 1 : 0;
+    }
+
+    VkDeviceSize TextureStreamer::estimateBytes(const Texture& texture, const uint32_t firstMip) const {
+        const auto& levels = texture.header.levels;
+        const double baseTexels = static_cast<double>(texture.header.width) * texture.header.height;
+        VkDeviceSize bytes = 0;
+        for (uint32_t level = firstMip; level < texture.mipCount; ++level) {
+            if (level < levels.size()) {
+                bytes += levels[level].size;
+            } else {
+                const VkExtent2D size = levelExtent(texture.header, level);
+                bytes += static_cast<VkDeviceSize>(static_cast<double>(levels.front().size) *
+                                                   size.width * size.height / baseTexels);
+            }
+        }
+        return bytes;
+    }
+
+    void TextureStreamer::update(const VkCommandBuffer cmd, const uint64_t frameNumber, const uint64_t completedFrames) {
+        VKP_PROFILE_SCOPE("TextureStreamer::update");
+        frameNumber_ = frameNumber;
+        retired_.collect(completedFrames);
+
+        std::vector<Loaded> loaded;
+        {
+            std::lock_guard lock(mutex_);
+            loaded.swap(loaded_);
+            for (auto& staged : staged_) ready_.push_back(std::move(staged));
+            staged_.clear();
+        }
+        for (auto& entry : loaded) finishLoad(entry);
+
+        // Record staged uploads, at least one per frame however large.
+        VkDeviceSize recorded = 0;
+        while (!ready_.empty() && (recorded == 0 || recorded + ready_.front().size <= UPLOAD_BYTES_PER_FRAME)) {
+            Staged staged = std::move(ready_.front());
+            ready_.pop_front();
+            Texture& texture = textures_[staged.id];
+            texture.stagingMip = NONE;
+            stagingBytes_ -= staged.size;
+            if (staged.failed) {
+                texture.state = State::Failed;
+            } else {
+                try {
+                    rebuild(cmd, texture, staged.firstMip, &staged, frameNumber);
+                    recorded       += staged.size;
+                    uploadedBytes_ += staged.size;
+                    textureMetrics().uploadedBytes.inc(staged.size);
+                } catch (const std::exception& e) {
+                    // The texture keeps the levels it had; the staging buffer is retired all the same.
+                    LOG_ERROR("texture {}: failed to upload levels from {}: {}", texture.name, staged.firstMip, e.what());
+                    texture.state = State::Failed;
+                }
+            }
+            retired_.retire(frameNumber + 1, [this, buffer = staged.buffer, memory = staged.memory] {
+                vkDestroyBuffer(device_.device(), buffer, device_.allocator());
+                device_.freeMemory(memory);
+            });
+        }
+
+        // Next steps: missing tails first, then the most recently used textures.
+        std::vector<TextureId> candidates;
+        for (TextureId id = 0; id < textures_.size(); ++id) {
+            if (nextMip(textures_[id]) != NONE) candidates.push_back(id);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [this](const TextureId a, const TextureId b) {
+            const Texture& ta = textures_[a];
+            const Texture& tb = textures_[b];
+            if ((ta.residentMip == NONE) != (tb.residentMip == NONE)) return ta.residentMip == NONE;
+            return ta.lastUsed > tb.lastUsed;
+        });
+        for (const TextureId id : candidates) {
+            if (stagingBytes_ >= MAX_STAGING_BYTES) break;
+            Texture& texture = textures_[id];
+            const uint32_t mip    = nextMip(texture);
+            const VkDeviceSize needed = estimateBytes(texture, mip);
+            const VkDeviceSize growth = needed > texture.bytes ? needed - texture.bytes : 0;
+            // A missing tail may push out any texture's fine levels; finer levels only those of
+            // textures used less recently.
+            const uint64_t usedBefore = texture.residentMip == NONE ? UINT64_MAX : texture.lastUsed;
+            if (!evictFor(cmd, growth, usedBefore, frameNumber)) continue;
+            stage(id, mip);
+        }
+        textureMetrics().residentBytes.set(static_cast<double>(residentBytes_));
+    }
+
+    bool TextureStreamer::evictFor(
+        const VkCommandBuffer cmd, const VkDeviceSize bytes, const uint64_t usedBefore, const uint64_t frameNumber)
+    {
+        // The tail stays; a texture being staged keeps its levels until the upload lands.
+        const auto evictable = [usedBefore](const Texture& texture) {
+            return texture.residentMip < texture.tailMip && texture.stagingMip == NONE &&
+                   texture.lastUsed < usedBefore;
+        };
+        // Evict nothing unless enough can go.
+        VkDeviceSize reclaimable = 0;
+        for (const auto& texture : textures_) {
+            if (!evictable(texture)) continue;
+            const VkDeviceSize tail = estimateBytes(texture, texture.tailMip);
+            reclaimable += texture.bytes > tail ? texture.bytes - tail : 0;
+        }
+        if (residentBytes_ + bytes > budget_ + reclaimable) return false;
+
+        while (residentBytes_ + bytes > budget_) {
+            Texture* victim = nullptr;
+            for (auto& texture : textures_) {
+                if (!evictable(texture)) continue;
+                if (victim == nullptr || texture.lastUsed < victim->lastUsed) victim = &texture;
+            }
+            if (victim == nullptr) return false;
+            try {
+                rebuild(cmd, *victim, victim->residentMip + 1, nullptr, frameNumber);
+            } catch (const std::exception& e) {
+                LOG_ERROR("texture {}: failed to evict level {}: {}", victim->name, victim->residentMip, e.what());
+                return false;
+            }
+            ++evictions_;
+            textureMetrics().evictions.inc();
+        }
+        return true;
+    }
+
+    void TextureStreamer::stage(const TextureId id, const uint32_t firstMip) {
+        Texture& texture = textures_[id];
+        const uint32_t resident = texture.residentMip == NONE ? texture.mipCount : texture.residentMip;
+        const uint32_t fileEnd  = std::min(resident, static_cast<uint32_t>(texture.header.levels.size()));
+
+        struct Copy {
+            Staged::Region region;
+            uint64_t       fileOffset;
+            uint64_t       size;
+        };
+        std::vector<Copy> copies;
+        VkDeviceSize size = 0;
+        for (uint32_t level = firstMip; level < fileEnd; ++level) {
+            const Ktx2Level& source = texture.header.levels[level];
+            size = (size + texture.alignment - 1) / texture.alignment * texture.alignment;
+            copies.push_back({ { level, size }, source.offset, source.size });
+            size += source.size;
+        }
+        texture.stagingMip = firstMip;
+        stagingBytes_ += size;
+
+        core::JobSystem::get().schedule([this, id, firstMip, size, file = texture.file, copies = std::move(copies)] {
+            VKP_PROFILE_SCOPE("TextureStreamer::stage");
+            Staged staged{ id, firstMip, VK_NULL_HANDLE, VK_NULL_HANDLE, size, {}, false };
+            try {
+                device_.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                     staged.buffer, staged.memory, MemoryCategory::Staging);
+                void* mapped = nullptr;
+                if (vkMapMemory(device_.device(), staged.memory, 0, size, 0, &mapped) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to map texture staging memory");
+                }
+                // Reading the mapping faults the file's pages in here, off the render thread.
+                for (const auto& copy : copies) {
+                    std::memcpy(static_cast<std::byte*>(mapped) + copy.region.offset, file->data() + copy.fileOffset,
+                                copy.size);
+                    staged.regions.push_back(copy.region);
+                }
+                vkUnmapMemory(device_.device(), staged.memory);
+            } catch (const std::exception& e) {
+                LOG_ERROR("failed to stage texture levels: {}", e.what());
+                staged.failed = true;
+            }
+            std::lock_guard lock(mutex_);
+            staged_.push_back(std::move(staged));
+        }, &jobs_);
+    }
+
+    void TextureStreamer::rebuild(
+        const VkCommandBuffer cmd, Texture& texture, const uint32_t firstMip, const Staged* staged,
+        const uint64_t frameNumber)
+    {
+        const VkDevice   dev        = device_.device();
+        const Ktx2Image& header     = texture.header;
+        const uint32_t   levels     = texture.mipCount - firstMip;
+        const uint32_t   oldFirst   = texture.residentMip;
+        const uint32_t   copyFirst  = oldFirst == NONE ? texture.mipCount : std::max(firstMip, oldFirst);
+        const auto       fileLevels = static_cast<uint32_t>(header.levels.size());
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+        imageInfo.extent        = { levelExtent(header, firstMip).width, levelExtent(header, firstMip).height, 1 };
+        imageInfo.mipLevels     = levels;
+        imageInfo.arrayLayers   = 1;
+        imageInfo.format        = header.format;
+        imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage         = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        // Source of the next rebuild's level copies, and of mip generation.
+        imageInfo.usage        |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        VkImage        image  = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        device_.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory, MemoryCategory::Texture);
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(dev, image, &requirements);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image            = image;
+        viewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format           = header.format;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levels, 0, 1 };
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(dev, &viewInfo, device_.allocator(), &view) != VK_SUCCESS) {
+            vkDestroyImage(dev, image, device_.allocator());
+            device_.freeMemory(memory);
+            throw std::runtime_error("failed to create texture view");
+        }
+
+        const VkImageMemoryBarrier toDst = imageBarrier(
+            image, 0, levels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toDst);
+
+        // Levels that stay resident move over from the old image.
+        if (copyFirst < texture.mipCount) {
+            const uint32_t copied = texture.mipCount - copyFirst;
+            const VkImageMemoryBarrier toSrc = imageBarrier(
+                texture.image, copyFirst - oldFirst, copied, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+            vkCmdPipelineBarrier(cmd, SAMPLING_STAGES, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &toSrc);
+            std::vector<VkImageCopy> regions(copied);
+            for (uint32_t i = 0; i < copied; ++i) {
+                const VkExtent2D size = levelExtent(header, copyFirst + i);
+                regions[i].srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, copyFirst - oldFirst + i, 0, 1 };
+                regions[i].dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, copyFirst - firstMip + i, 0, 1 };
+                regions[i].extent         = { size.width, size.height, 1 };
+            }
+            vkCmdCopyImage(cmd, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copied, regions.data());
+        }
+
+        if (staged != nullptr && !staged->regions.empty()) {
+            std::vector<VkBufferImageCopy> regions;
+            for (const auto& region : staged->regions) {
+                const VkExtent2D size = levelExtent(header, region.level);
+                VkBufferImageCopy copy{};
+                copy.bufferOffset     = region.offset;
+                copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, region.level - firstMip, 0, 1 };
+                copy.imageExtent      = { size.width, size.height, 1 };
+                regions.push_back(copy);
+            }
+            vkCmdCopyBufferToImage(cmd, staged->buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(regions.size()), regions.data());
+        }
+
+        // Levels the file lacks are blitted from the next finer one, which then stays in TRANSFER_SRC.
+        uint32_t sourceLevels = 0;
+        for (uint32_t level = std::max(firstMip + 1, fileLevels); level < copyFirst; ++level) {
+            const uint32_t source = level - 1 - firstMip;
+            const VkImageMemoryBarrier toSrc = imageBarrier(
+                image, source, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &toSrc);
+            const VkExtent2D from = levelExtent(header, level - 1);
+            const VkExtent2D to   = levelExtent(header, level);
+            VkImageBlit blit{};
+            blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, source, 0, 1 };
+            blit.srcOffsets[1]  = { static_cast<int32_t>(from.width), static_cast<int32_t>(from.height), 1 };
+            blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, source + 1, 0, 1 };
+            blit.dstOffsets[1]  = { static_cast<int32_t>(to.width), static_cast<int32_t>(to.height), 1 };
+            vkCmdBlitImage(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+            sourceLevels = source + 1;
+        }
+
+        std::array<VkImageMemoryBarrier, 2> toRead{};
+        uint32_t barriers = 0;
+        if (sourceLevels > 0) {
+            toRead[barriers++] = imageBarrier(
+                image, 0, sourceLevels, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+        toRead[barriers++] = imageBarrier(
+            image, sourceLevels, levels - sourceLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, SAMPLING_STAGES,
+                             0, 0, nullptr, 0, nullptr, barriers, toRead.data());
+
+        // Frames already recorded may still sample the old image.
+        if (texture.image != VK_NULL_HANDLE) {
+            retired_.retire(frameNumber + 1, [this, oldView = texture.view, oldImage = texture.image,
+                                              oldMemory = texture.memory] {
+                vkDestroyImageView(device_.device(), oldView, device_.allocator());
+                vkDestroyImage(device_.device(), oldImage, device_.allocator());
+                device_.freeMemory(oldMemory);
+            });
+        }
+        residentBytes_      = residentBytes_ - texture.bytes + requirements.size;
+        texture.image       = image;
+        texture.memory      = memory;
+        texture.view        = view;
+        texture.bytes       = requirements.size;
+        texture.residentMip = firstMip;
+    }
+
+    TextureStats TextureStreamer::stats() const {
+        TextureStats stats;
+        stats.textures      = textures_.size();
+        stats.usable        = static_cast<size_t>(std::count_if(textures_.begin(), textures_.end(),
+                                                                [](const Texture& t) { return t.view != VK_NULL_HANDLE; }));
+        stats.residentBytes = residentBytes_;
+        stats.budgetBytes   = budget_;
+        stats.uploadedBytes = uploadedBytes_;
+        stats.evictions     = evictions_;
+        return stats;
+    }
+
+} // namespace vkp::graphics
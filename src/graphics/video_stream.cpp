@@ -0,0 +1,440 @@
+#include <vkp/graphics/video_stream.h>
+#include <vkp/graphics/pipeline.h>
+#include <vkp/core/profiler.h>
+#include <vkp/logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <csignal>
+#endif
+
+namespace vkp::graphics {
+
+    namespace {
+        constexpr auto COMPUTE_SHADER_PATH = "shaders/yuv420_shader.comp";
+
+        // Must match the push constant block in yuv420_shader.comp.
+        struct YuvPushConstants {
+            uint32_t srcWidth;
+            uint32_t srcHeight;
+            uint32_t dstWidth;
+            uint32_t dstHeight;
+            uint32_t stride;
+            uint32_t nv12;
+            uint32_t encodeSrgb;
+        };
+
+        bool isSrgb(const VkFormat format) {
+            return format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_R8G8B8A8_SRGB;
+        }
+    }
+
+    VideoStream::VideoStream(
+        Device& device,
+        const uint32_t framesInFlight,
+        VideoStreamSettings settings,
+        const VkExtent2D size)
+        : device_(device)
+        , settings_(std::move(settings))
+        , size_(size)
+        , stride_((size.width + 7) & ~7u)
+        , paddedHeight_((size.height + 1) & ~1u)
+        , frameBytes_(static_cast<VkDeviceSize>(stride_) * paddedHeight_ * 3 / 2)
+    {
+        if (settings_.path == "-") {
+            file_ = stdout;
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        } else {
+            file_ = std::fopen(settings_.path.c_str(), "wb");
+            if (file_ == nullptr) {
+                throw std::runtime_error("failed to open video output: " + settings_.path);
+            }
+            ownsFile_ = true;
+        }
+#ifndef _WIN32
+        // A closed encoder pipe should end the stream with an error, not kill the process.
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+        createPipeline();
+        createSlots(framesInFlight);
+        writeHeader();
+        writer_ = std::thread(&VideoStream::writerLoop, this);
+
+        LOG_INFO("streaming {}x{} {} video at {} fps to {}", size_.width, size_.height,
+                 settings_.format == VideoFormat::Y4M ? "y4m" : "nv12", settings_.fps,
+                 settings_.path == "-" ? "stdout" : settings_.path);
+    }
+
+    VideoStream::~VideoStream() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        frameAvailable_.notify_all();
+        writer_.join();
+
+        if (ownsFile_) std::fclose(file_);
+        else std::fflush(file_);
+        LOG_INFO("video stream finished after {} frame(s)", framesWritten_);
+
+        const VkDevice dev = device_.device();
+        for (auto& slot : slots_) {
+            vkUnmapMemory(dev, slot.memory);
+            vkDestroyBuffer(dev, slot.buffer, device_.allocator());
+            device_.freeMemory(slot.memory);
+        }
+        vkDestroyPipeline(dev, pipeline_, device_.allocator());
+        vkDestroyPipelineLayout(dev, pipelineLayout_, device_.allocator());
+        vkDestroyDescriptorPool(dev, descriptorPool_, device_.allocator());
+        vkDestroyDescriptorSetLayout(dev, setLayout_, device_.allocator());
+        vkDestroySampler(dev, sampler_, device_.allocator());
+    }
+
+    bool VideoStream::supportsFormat(const VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void VideoStream::createPipeline() {
+        const VkDevice dev = device_.device();
+
+        // texelFetch ignores filtering; the sampler only completes the combined descriptor.
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        if (vkCreateSampler(dev, &samplerInfo, device_.allocator(), &sampler_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create video sampler");
+        }
+
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        bindings[0].binding         = 0;
+        bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[1].binding         = 1;
+        bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+        setLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        setLayoutInfo.pBindings    = bindings.data();
+        if (vkCreateDescriptorSetLayout(dev, &setLayoutInfo, device_.allocator(), &setLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create video descriptor set layout");
+        }
+
+        VkPushConstantRange pushRange{};
+        pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushRange.size       = sizeof(YuvPushConstants);
+
+        VkPipelineLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount         = 1;
+        layoutInfo.pSetLayouts            = &setLayout_;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges    = &pushRange;
+        if (vkCreatePipelineLayout(dev, &layoutInfo, device_.allocator(), &pipelineLayout_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create video pipeline layout");
+        }
+
+        const VkShaderModule module = Pipeline::loadShaderModule(device_, COMPUTE_SHADER_PATH);
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = module;
+        pipelineInfo.stage.pName  = "main";
+        pipelineInfo.layout       = pipelineLayout_;
+        const VkResult result = vkCreateComputePipelines(dev, VK_NULL_HANDLE, 1, &pipelineInfo, device_.allocator(), &pipeline_);
+        vkDestroyShaderModule(dev, module, device_.allocator());
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create video conversion pipeline");
+        }
+    }
+
+    void VideoStream::createSlots(const uint32_t count) {
+        const VkDevice dev = device_.device();
+
+        std::array<VkDescriptorPoolSize, 2> poolSizes{};
+        poolSizes[0] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, count };
+        poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, count };
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = count;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes    = poolSizes.data();
+        if (vkCreateDescriptorPool(dev, &poolInfo, device_.allocator(), &descriptorPool_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create video descriptor pool");
+        }
+
+        // The shader writes straight into host memory; cached memory keeps the CPU-side
+        // memcpy fast and needs an explicit invalidate when it is not also coherent.
+        constexpr VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        VkMemoryPropertyFlags memoryFlags = cached;
+        if (!device_.caps().hasMemoryType(cached)) {
+            memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        }
+        coherent_ = (memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+        slots_.resize(count);
+        for (auto& slot : slots_) {
+            device_.createBuffer(
+                frameBytes_, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, memoryFlags, slot.buffer, slot.memory,
+                MemoryCategory::Staging);
+            if (vkMapMemory(dev, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS) {
+                throw std::runtime_error("failed to map video readback buffer");
+            }
+
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool     = descriptorPool_;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts        = &setLayout_;
+            if (vkAllocateDescriptorSets(dev, &allocInfo, &slot.set) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate video descriptor set");
+            }
+        }
+    }
+
+    void VideoStream::record(
+        const VkCommandBuffer cmd,
+        const uint32_t frameIndex,
+        const VkImage image,
+        const VkImageView view,
+        const VkImageLayout layout,
+        const VkFormat format,
+        const VkExtent2D extent,
+        const uint64_t frameNumber)
+    {
+        VKP_PROFILE_SCOPE("VideoStream::record");
+        Slot& slot = slots_[frameIndex];
+
+        // The slot's fence was waited, so its set is no longer in use by the GPU.
+        VkDescriptorImageInfo imageInfo{ sampler_, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        VkDescriptorBufferInfo bufferInfo{ slot.buffer, 0, VK_WHOLE_SIZE };
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        writes[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet          = slot.set;
+        writes[0].dstBinding      = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo      = &imageInfo;
+        writes[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet          = slot.set;
+        writes[1].dstBinding      = 1;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[1].pBufferInfo     = &bufferInfo;
+        vkUpdateDescriptorSets(device_.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        // TRANSFER is in the source scope as frame capture may have read the image just before;
+        // its restore barrier ends at ALL_COMMANDS, so this one chains after its transition.
+        VkImageMemoryBarrier toSampled{};
+        toSampled.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toSampled.srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        toSampled.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+        toSampled.oldLayout           = layout;
+        toSampled.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toSampled.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toSampled.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toSampled.image               = image;
+        toSampled.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        vkCmdPipelineBarrier(cmd,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toSampled);
+
+        const YuvPushConstants pc{
+            extent.width, extent.height, size_.width, size_.height, stride_,
+            settings_.format == VideoFormat::NV12 ? 1u : 0u,
+            isSrgb(format) ? 1u : 0u,
+        };
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_, 0, 1, &slot.set, 0, nullptr);
+        vkCmdPushConstants(cmd, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+        // One invocation per 8x2 block, 8x8 invocations per group.
+        const uint32_t blocksX = stride_ / 8;
+        const uint32_t blocksY = paddedHeight_ / 2;
+        vkCmdDispatch(cmd, (blocksX + 7) / 8, (blocksY + 7) / 8, 1);
+
+        VkImageMemoryBarrier toOriginal = toSampled;
+        toOriginal.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        toOriginal.dstAccessMask = 0;
+        toOriginal.oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toOriginal.newLayout     = layout;
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask       = VK_ACCESS_SHADER_WRITE_BIT;
+        toHost.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer              = slot.buffer;
+        toHost.size                = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(cmd,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toOriginal);
+        vkCmdPipelineBarrier(cmd,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+        slot.pending     = true;
+        slot.frameNumber = frameNumber;
+    }
+
+    void VideoStream::collect(const uint32_t frameIndex) {
+        Slot& slot = slots_[frameIndex];
+        if (!slot.pending) return;
+        slot.pending = false;
+        VKP_PROFILE_SCOPE("VideoStream::collect");
+
+        if (!coherent_) {
+            VkMappedMemoryRange range{};
+            range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = slot.memory;
+            range.size   = VK_WHOLE_SIZE;
+            vkInvalidateMappedMemoryRanges(device_.device(), 1, &range);
+        }
+
+        std::vector<uint8_t> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (frames_.size() >= MAX_QUEUED_FRAMES) {
+                VKP_PROFILE_SCOPE("wait for video writer");
+                spaceAvailable_.wait(lock, [this] { return frames_.size() < MAX_QUEUED_FRAMES; });
+            }
+            if (!freeBuffers_.empty()) {
+                frame = std::move(freeBuffers_.back());
+                freeBuffers_.pop_back();
+            }
+        }
+        frame.resize(static_cast<size_t>(frameBytes_));
+        std::memcpy(frame.data(), slot.mapped, frame.size());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frames_.push_back(std::move(frame));
+        }
+        frameAvailable_.notify_one();
+    }
+
+    void VideoStream::flush() {
+        // Slots are ring-ordered, so collect the oldest pending frame first.
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].pending) order.push_back(i);
+        }
+        std::sort(order.begin(), order.end(), [this](const uint32_t a, const uint32_t b) {
+            return slots_[a].frameNumber < slots_[b].frameNumber;
+        });
+        for (const uint32_t i : order) collect(i);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return frames_.empty() && !busy_; });
+        std::fflush(file_);
+    }
+
+    void VideoStream::writeHeader() {
+        if (settings_.format != VideoFormat::Y4M) return;
+        // C420jpeg: chroma is sited between luma samples, matching the 2x2 average.
+        const std::string header = fmt::format(
+            "YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+            size_.width, size_.height, settings_.fps);
+        std::fwrite(header.data(), 1, header.size(), file_);
+    }
+
+    void VideoStream::writeFrame(const std::vector<uint8_t>& frame) {
+        static constexpr char FRAME_TAG[] = "FRAME\n";
+        const uint8_t* luma       = frame.data();
+        const uint8_t* chroma     = luma + static_cast<size_t>(stride_) * paddedHeight_;
+        const uint32_t chromaRows = paddedHeight_ / 2;
+        const uint32_t chromaCols = (size_.width + 1) / 2;
+
+        // Padding is stripped row by row; the payload is already in its final byte layout.
+        bool ok = true;
+        auto write = [&](const uint8_t* src, const size_t bytes) {
+            ok = ok && std::fwrite(src, 1, bytes, file_) == bytes;
+        };
+
+        if (settings_.format == VideoFormat::Y4M) {
+            write(reinterpret_cast<const uint8_t*>(FRAME_TAG), sizeof(FRAME_TAG) - 1);
+        }
+        for (uint32_t y = 0; y < size_.height; ++y) {
+            write(luma + static_cast<size_t>(y) * stride_, size_.width);
+        }
+        if (settings_.format == VideoFormat::NV12) {
+            for (uint32_t y = 0; y < chromaRows; ++y) {
+                write(chroma + static_cast<size_t>(y) * stride_, chromaCols * 2);
+            }
+        } else {
+            const uint32_t chromaStride = stride_ / 2;
+            const uint8_t* v = chroma + static_cast<size_t>(chromaStride) * chromaRows;
+            for (uint32_t y = 0; y < chromaRows; ++y) {
+                write(chroma + static_cast<size_t>(y) * chromaStride, chromaCols);
+            }
+            for (uint32_t y = 0; y < chromaRows; ++y) {
+                write(v + static_cast<size_t>(y) * chromaStride, chromaCols);
+            }
+        }
+
+        if (!ok) {
+            LOG_ERROR("video output {} failed after {} frame(s), dropping the rest of the stream",
+                      settings_.path, framesWritten_);
+            failed_ = true;
+            return;
+        }
+        ++framesWritten_;
+    }
+
+    void VideoStream::writerLoop() {
+        VKP_PROFILE_THREAD("video writer");
+        for (;;) {
+            std::vector<uint8_t> frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                frameAvailable_.wait(lock, [this] { return stopping_ || !frames_.empty(); });
+                if (frames_.empty()) return;
+                frame = std::move(frames_.front());
+                frames_.pop_front();
+                busy_ = true;
+            }
+            spaceAvailable_.notify_one();
+
+            if (!failed_) {
+                VKP_PROFILE_SCOPE("write video frame");
+                writeFrame(frame);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                freeBuffers_.push_back(std::move(frame));
+                busy_ = false;
+                if (frames_.empty()) idle_.notify_all();
+            }
+        }
+    }
+
+} // namespace vkp::graphics
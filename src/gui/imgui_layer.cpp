@@ -1,25 +1,76 @@
 #include <vkp/gui/imgui_layer.h>
+#include <vkp/core/profiler.h>
 #include <vkp/logger.h>
 
+#include <algorithm>
+#include <cstdio>
+
 namespace vkp {
 
+namespace {
+    // "12345" -> "12.3k", so counts fit the overlay's width.
+    void formatCount(char* out, const size_t size, const uint64_t count) {
+        const auto value = static_cast<double>(count);
+        if (count >= 1000000000ull) std::snprintf(out, size, "%.2fG", value * 1e-9);
+        else if (count >= 1000000)  std::snprintf(out, size, "%.2fM", value * 1e-6);
+        else if (count >= 10000)    std::snprintf(out, size, "%.1fk", value * 1e-3);
+        else                        std::snprintf(out, size, "%llu", static_cast<unsigned long long>(count));
+    }
+}
+
 ImGuiLayer::ImGuiLayer(
     Window& window,
     vkp::graphics::Device& device,
-    vkp::graphics::SwapChain& swapChain,
+    const uint32_t imageCount,
     const VkRenderPass renderPass,
-    const uint32_t subpass)
+    const uint32_t subpass,
+    const VkFormat colorFormat,
+    const VkFormat depthFormat)
     : window_(window)
     , device_(device)
-    , swapChain_(swapChain)
+    , imageCount_(imageCount)
     , renderPass_(renderPass)
     , subpass_(subpass)
+    , colorFormat_(colorFormat)
+    , depthFormat_(depthFormat)
     , descriptorPool_(VK_NULL_HANDLE)
 {
 }
 
 ImGuiLayer::~ImGuiLayer() = default;
 
+void ImGuiLayer::PrepareContext() {
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+
+    // Rasterize the font atlas now instead of on the first frame.
+    ImGui::GetIO().Fonts->Build();
+}
+
+void ImGuiLayer::SetFrameStats(const core::FrameStatsRing* ring, const float budgetMs) {
+    frame_stats_ = ring;
+    budget_ms_   = budgetMs;
+    graph_.reserve(GraphSamples);
+}
+
+void ImGuiLayer::SetMemoryReport(const vkp::graphics::MemoryReport* report) {
+    memory_report_ = report;
+}
+
+void ImGuiLayer::SetDebugMessages(vkp::graphics::DebugMessageCollector* messages) {
+    debug_messages_ = messages;
+}
+
+void ImGuiLayer::SetPipelineStatistics(
+    const std::vector<vkp::graphics::GpuProfiler::StatisticsResult>* statistics) {
+    pipeline_statistics_ = statistics;
+}
+
+void ImGuiLayer::SetTextureStreamer(vkp::graphics::TextureStreamer* streamer) {
+    texture_streamer_ = streamer;
+}
+
 void ImGuiLayer::OnAttach() {
     // Descriptor pool for ImGui: only combined image samplers, large count for safety.
     constexpr VkDescriptorPoolSize pool_sizes[] = {
@@ -30,16 +81,12 @@ void ImGuiLayer::OnAttach() {
     pool_info.maxSets       = 1000;
     pool_info.poolSizeCount = 1;
     pool_info.pPoolSizes    = pool_sizes;
-    vkCreateDescriptorPool(device_.device(), &pool_info, nullptr, &descriptorPool_);
-
-    // ImGui context & style setup
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-    ImGui::StyleColorsDark();
+    vkCreateDescriptorPool(device_.device(), &pool_info, device_.allocator(), &descriptorPool_);
 
-    // GLFW backend for input handling
-    ImGui_ImplGlfw_InitForVulkan(window_.handle(), true);
+    // ImGui context & style setup, unless it was already prepared ahead of time
+    if (ImGui::GetCurrentContext() == nullptr) {
+        PrepareContext();
+    }
 
     // Vulkan backend: fill out all required info for ImGui's renderer
     ImGui_ImplVulkan_InitInfo init_info{};
@@ -52,38 +99,87 @@ void ImGuiLayer::OnAttach() {
     init_info.DescriptorPool  = descriptorPool_;
     init_info.Subpass         = subpass_;
     init_info.MinImageCount   = 2;
-    init_info.ImageCount      = static_cast<uint32_t>(swapChain_.imageCount());
+    init_info.ImageCount      = imageCount_;
     init_info.MSAASamples     = VK_SAMPLE_COUNT_1_BIT;
-    init_info.Allocator       = nullptr;
+    init_info.Allocator       = device_.allocator();
     init_info.RenderPass      = renderPass_;
+    if (renderPass_ == VK_NULL_HANDLE) {
+        // The backend builds its pipeline against these formats; colorFormat_ outlives the pointer.
+        init_info.UseDynamicRendering = true;
+        init_info.PipelineRenderingCreateInfo = {};
+        init_info.PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        init_info.PipelineRenderingCreateInfo.colorAttachmentCount    = 1;
+        init_info.PipelineRenderingCreateInfo.pColorAttachmentFormats = &colorFormat_;
+        init_info.PipelineRenderingCreateInfo.depthAttachmentFormat   = depthFormat_;
+    }
 
     ImGui_ImplVulkan_Init(&init_info);
 }
 
 void ImGuiLayer::OnDetach() const {
     // Order is important: destroy ImGui resources before Vulkan pool/context
-    vkDestroyDescriptorPool(device_.device(), descriptorPool_, nullptr);
+    vkDestroyDescriptorPool(device_.device(), descriptorPool_, device_.allocator());
     ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 }
 
-void ImGuiLayer::OnRender(VkCommandBuffer cmd) {
+void ImGuiLayer::OnInput(const WindowEvent& event) {
+    ImGuiIO& io = ImGui::GetIO();
+    switch (event.type) {
+        case WindowEvent::Type::CursorPos:
+            io.AddMousePosEvent(static_cast<float>(event.x), static_cast<float>(event.y));
+            break;
+        case WindowEvent::Type::MouseButton:
+            if (event.button >= 0 && event.button < ImGuiMouseButton_COUNT) io.AddMouseButtonEvent(event.button, event.down);
+            break;
+        case WindowEvent::Type::Scroll:
+            io.AddMouseWheelEvent(static_cast<float>(event.x), static_cast<float>(event.y));
+            break;
+        case WindowEvent::Type::Focus:
+            io.AddFocusEvent(event.down);
+            break;
+        default:
+            break;
+    }
+}
+
+void ImGuiLayer::OnRender(VkCommandBuffer cmd, const VkExtent2D extent) {
+    VKP_PROFILE_SCOPE("ImGuiLayer::OnRender");
     ImGui_ImplVulkan_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
 
-    ImGui::NewFrame();
+    // What ImGui_ImplGlfw_NewFrame would set, without touching GLFW window state off the main thread.
     ImGuiIO& io = ImGui::GetIO();
+    const double frameTime = glfwGetTime();   // thread-safe
+    io.DisplaySize             = ImVec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+    io.DisplayFramebufferScale = ImVec2(1.f, 1.f);
+    io.DeltaTime               = last_frame_time_ > 0.0 ? std::max(static_cast<float>(frameTime - last_frame_time_), 1e-6f)
+                                                        : 1.f / 60.f;
+    last_frame_time_ = frameTime;
+
+    ImGui::NewFrame();
 
     // Only update stats at a fixed interval to avoid UI flicker
     if (double now = ImGui::GetTime(); now - stats_last_update_time_ >= stats_update_interval_) {
         stats_fps_           = io.Framerate;
         stats_frame_time_ms_ = io.DeltaTime * 1000.0f;
         stats_last_update_time_ = now;
+        if (frame_stats_ != nullptr) {
+            const auto windowNs = static_cast<uint64_t>(StatsWindowSec * 1e9);
+            const uint64_t nowNs = core::Profiler::now();
+            summary_ = core::summarize(frame_stats_->since(nowNs > windowNs ? nowNs - windowNs : 0), budget_ms_);
+        }
+        // Copied under the collector's lock, so at the stats rate rather than every frame.
+        if (debug_messages_ != nullptr) performance_warnings_ = debug_messages_->performanceWarnings();
+    }
+
+    // The graph follows every frame; it is cheap next to the percentiles above.
+    graph_.clear();
+    if (frame_stats_ != nullptr) {
+        for (const auto& sample : frame_stats_->latest(GraphSamples)) graph_.push_back(sample.frame_ms);
     }
 
     // Overlay stats window in top-right, always visible, no interaction
-    auto [width, height] = swapChain_.getSwapChainExtent();
+    auto [width, height] = extent;
     ImGui::SetNextWindowPos(
         ImVec2(static_cast<float>(width) - StatsPos_x, StatsPos_y),
         ImGuiCond_Always
@@ -99,10 +195,180 @@ void ImGuiLayer::OnRender(VkCommandBuffer cmd) {
     ImGui::Text("FPS: %.f", stats_fps_);
     ImGui::Text("FrameTime: %.1f ms", stats_frame_time_ms_);
 
+    if (frame_stats_ != nullptr) {
+        const float graphMax = std::max(budget_ms_ * 2.f, summary_.max_ms);
+        ImGui::PlotLines("##frametime", graph_.data(), static_cast<int>(graph_.size()), 0,
+                         nullptr, 0.f, graphMax, ImVec2(StatsPos_x - 20.f, 50.f));
+        ImGui::Text("frame p50 %.1f  p99 %.1f  max %.1f", summary_.p50_ms, summary_.p99_ms, summary_.max_ms);
+        if (summary_.gpu_max_ms > 0.f) {
+            ImGui::Text("gpu   p50 %.1f  p99 %.1f  max %.1f",
+                        summary_.gpu_p50_ms, summary_.gpu_p99_ms, summary_.gpu_max_ms);
+        }
+        const ImVec4 color = summary_.over_budget > 0 ? ImVec4(1.f, 0.4f, 0.3f, 1.f) : ImVec4(0.6f, 1.f, 0.6f, 1.f);
+        ImGui::TextColored(color, "over %.1f ms: %zu / %zu (%.0fs)",
+                           budget_ms_, summary_.over_budget, summary_.count, StatsWindowSec);
+    }
+
+    if (pipeline_statistics_ != nullptr) {
+        const double pixels = static_cast<double>(extent.width) * static_cast<double>(extent.height);
+        char vertices[16], primitives[16], fragments[16];
+        for (const auto& stats : *pipeline_statistics_) {
+            formatCount(vertices, sizeof(vertices), stats.vertexInvocations);
+            formatCount(primitives, sizeof(primitives), stats.clippingPrimitives);
+            formatCount(fragments, sizeof(fragments), stats.fragmentInvocations);
+            const double perPixel = pixels > 0.0 ? static_cast<double>(stats.fragmentInvocations) / pixels : 0.0;
+            ImGui::Text("%-6s fs %s  %.2f/px", stats.name, fragments, perPixel);
+            ImGui::Text("       vs %s  prims %s", vertices, primitives);
+        }
+    }
+
+    if (memory_report_ != nullptr) {
+        constexpr float MiB = 1024.f * 1024.f;
+        for (size_t i = 0; i < memory_report_->heaps.size(); ++i) {
+            const auto& heap = memory_report_->heaps[i];
+            if (heap.usage == 0 && !heap.deviceLocal) continue;
+            const float fraction = heap.budget > 0 ? static_cast<float>(heap.usage) / static_cast<float>(heap.budget) : 0.f;
+            char label[64];
+            std::snprintf(label, sizeof(label), "%.0f / %.0f MiB", heap.usage / MiB, heap.budget / MiB);
+            ImGui::Text("heap %zu%s", i, heap.deviceLocal ? " (local)" : "");
+            ImGui::SameLine();
+            if (fraction >= 0.9f) ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(1.f, 0.4f, 0.3f, 1.f));
+            ImGui::ProgressBar(fraction, ImVec2(-1.f, 0.f), label);
+            if (fraction >= 0.9f) ImGui::PopStyleColor();
+        }
+        VkDeviceSize tracked = 0;
+        for (size_t c = 0; c < memory_report_->categories.size(); ++c) {
+            const VkDeviceSize bytes = memory_report_->categories[c];
+            if (bytes == 0) continue;
+            tracked += bytes;
+            ImGui::Text("  %-16s %7.1f MiB",
+                        vkp::graphics::memoryCategoryName(static_cast<vkp::graphics::MemoryCategory>(c)),
+                        bytes / MiB);
+        }
+        if (memory_report_->budgetExtension) {
+            VkDeviceSize usage = 0;
+            for (const auto& heap : memory_report_->heaps) usage += heap.usage;
+            if (usage > tracked) ImGui::Text("  %-16s %7.1f MiB", "untracked", (usage - tracked) / MiB);
+        }
+    }
+
+    if (texture_streamer_ != nullptr) {
+        constexpr float MiB = 1024.f * 1024.f;
+        const auto stats = texture_streamer_->stats();
+        ImGui::Text("textures %zu/%zu  %.0f / %.0f MiB", stats.usable, stats.textures,
+                    stats.residentBytes / MiB, stats.budgetBytes / MiB);
+        for (vkp::graphics::TextureId id = 0; id < texture_streamer_->count() && id < MaxTextureRows; ++id) {
+            const VkExtent2D resident = texture_streamer_->residentExtent(id);
+            const VkExtent2D full     = texture_streamer_->extent(id);
+            ImGui::Text("  %-14.14s %4u / %u", texture_streamer_->name(id).c_str(), resident.width, full.width);
+        }
+    }
+
+    if (debug_messages_ != nullptr) {
+        const auto frame = debug_messages_->lastFrame();
+        const auto total = debug_messages_->total();
+        const ImVec4 color = frame.errors > 0 ? ImVec4(1.f, 0.4f, 0.3f, 1.f)
+                           : frame.warnings + frame.performance > 0 ? ImVec4(1.f, 0.8f, 0.3f, 1.f)
+                           : ImVec4(0.6f, 1.f, 0.6f, 1.f);
+        ImGui::TextColored(color, "vk err %llu  warn %llu  perf %llu",
+                           static_cast<unsigned long long>(frame.errors),
+                           static_cast<unsigned long long>(frame.warnings),
+                           static_cast<unsigned long long>(frame.performance));
+        ImGui::Text("total  %llu  %llu  %llu",
+                    static_cast<unsigned long long>(total.errors),
+                    static_cast<unsigned long long>(total.warnings),
+                    static_cast<unsigned long long>(total.performance));
+    }
+
     ImGui::End();
 
+    if (debug_messages_ != nullptr) RenderValidationWindow();
+    if (texture_streamer_ != nullptr) RenderTexturesWindow();
+
     ImGui::Render();
     ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
 }
 
+void ImGuiLayer::RenderValidationWindow() {
+    ImGui::SetNextWindowPos(ImVec2(20.f, 20.f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(420.f, 260.f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Validation")) {
+        ImGui::End();
+        return;
+    }
+
+    // The filter applies to messages counted and logged from now on.
+    auto severities = static_cast<unsigned int>(debug_messages_->severityFilter());
+    auto types      = static_cast<unsigned int>(debug_messages_->typeFilter());
+    bool changed = false;
+    changed |= ImGui::CheckboxFlags("verbose", &severities, VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT);
+    ImGui::SameLine();
+    changed |= ImGui::CheckboxFlags("info", &severities, VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT);
+    ImGui::SameLine();
+    changed |= ImGui::CheckboxFlags("warning", &severities, VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT);
+    ImGui::SameLine();
+    changed |= ImGui::CheckboxFlags("error", &severities, VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT);
+    changed |= ImGui::CheckboxFlags("general", &types, VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT);
+    ImGui::SameLine();
+    changed |= ImGui::CheckboxFlags("validation", &types, VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT);
+    ImGui::SameLine();
+    changed |= ImGui::CheckboxFlags("performance", &types, VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT);
+    if (changed) debug_messages_->setFilter(severities, types);
+
+    ImGui::Separator();
+    if (performance_warnings_.empty()) {
+        ImGui::TextDisabled("no performance warnings");
+    }
+    for (const auto& warning : performance_warnings_) {
+        ImGui::Text("%6llu  %s", static_cast<unsigned long long>(warning.count), warning.id.c_str());
+        if (ImGui::IsItemHovered()) ImGui::SetTooltip("%s", warning.message.c_str());
+    }
+    ImGui::End();
+}
+
+void ImGuiLayer::RenderTexturesWindow() {
+    ImGui::SetNextWindowPos(ImVec2(20.f, 300.f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(320.f, 380.f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+    // Collapsed, the window binds no texture, so none counts as used.
+    if (!ImGui::Begin("Textures")) {
+        ImGui::End();
+        return;
+    }
+
+    for (vkp::graphics::TextureId id = 0; id < texture_streamer_->count(); ++id) {
+        const VkExtent2D resident = texture_streamer_->residentExtent(id);
+        char label[96];
+        std::snprintf(label, sizeof(label), "%s  %u / %u##%u", texture_streamer_->name(id).c_str(), resident.width,
+                      texture_streamer_->extent(id).width, id);
+        if (ImGui::Selectable(label, id == preview_texture_)) preview_texture_ = id;
+    }
+    ImGui::Separator();
+
+    if (preview_texture_ >= texture_streamer_->count() || !texture_streamer_->usable(preview_texture_)) {
+        ImGui::TextDisabled("not resident yet");
+        ImGui::End();
+        return;
+    }
+    // The view changes whenever a level streams in or is evicted. The old set may still be used by
+    // frames in flight, so it is freed with them.
+    const VkImageView view = texture_streamer_->view(preview_texture_);
+    if (view != preview_view_) {
+        if (preview_set_ != VK_NULL_HANDLE) {
+            texture_streamer_->retire([set = preview_set_] { ImGui_ImplVulkan_RemoveTexture(set); });
+        }
+        preview_set_  = ImGui_ImplVulkan_AddTexture(texture_streamer_->sampler(), view,
+                                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        preview_view_ = view;
+    }
+    texture_streamer_->touch(preview_texture_);
+
+    const VkExtent2D full  = texture_streamer_->extent(preview_texture_);
+    const float      width = std::min(ImGui::GetContentRegionAvail().x, static_cast<float>(full.width));
+    ImGui::Image(reinterpret_cast<ImTextureID>(preview_set_),
+                 ImVec2(width, width * static_cast<float>(full.height) / static_cast<float>(full.width)));
+    ImGui::End();
+}
+
 } // namespace vkp
@@ -1,8 +1,16 @@
 #include <vkp/gui/window.h>
+#include <vkp/core/startup_profiler.h>
 #include <vkp/logger.h>
 namespace vkp {
+    namespace {
+        uint64_t packExtent(int width, int height) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(width)) << 32) | static_cast<uint32_t>(height);
+        }
+    }
+
     Window::Window(int width, int height, const std::string& title, int pos_x, int pos_y)
-        : width(width), height(height), title(title), window(nullptr) {
+        : extent(packExtent(width, height)), title(title), window(nullptr) {
+        VKP_STARTUP_SCOPE("window");
         if (!glfwInit()) {
             LOG_FATAL("Failed to initialize GLFW.");
         }
@@ -26,6 +34,10 @@ namespace vkp {
         // Set user pointer and framebuffer resize callback for proper resizing
         glfwSetWindowUserPointer(window, this);
         glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+        glfwSetCursorPosCallback(window, cursorPosCallback);
+        glfwSetMouseButtonCallback(window, mouseButtonCallback);
+        glfwSetScrollCallback(window, scrollCallback);
+        glfwSetWindowFocusCallback(window, focusCallback);
 
         init();
     }
@@ -40,9 +52,56 @@ namespace vkp {
 
     void Window::framebufferResizeCallback(GLFWwindow *window, int width, int height) {
         auto window_ = static_cast<Window *>(glfwGetWindowUserPointer(window));
-        window_->framebufferResized = true;
-        window_->width = width;
-        window_->height = height;
+        window_->extent.store(packExtent(width, height), std::memory_order_release);
+        window_->framebufferResized.store(true, std::memory_order_release);
+        window_->postEvent({ WindowEvent::Type::Resize, width, height });
+    }
+
+    void Window::cursorPosCallback(GLFWwindow* window, double x, double y) {
+        auto window_ = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        // GLFW reports screen coordinates; the overlay is laid out in framebuffer pixels.
+        int windowWidth = 0, windowHeight = 0, fbWidth = 0, fbHeight = 0;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        if (windowWidth > 0 && windowHeight > 0) {
+            x *= static_cast<double>(fbWidth) / windowWidth;
+            y *= static_cast<double>(fbHeight) / windowHeight;
+        }
+        WindowEvent event{ WindowEvent::Type::CursorPos };
+        event.x = x;
+        event.y = y;
+        window_->postEvent(event);
+    }
+
+    void Window::mouseButtonCallback(GLFWwindow* window, int button, int action, int /*mods*/) {
+        WindowEvent event{ WindowEvent::Type::MouseButton };
+        event.button = button;
+        event.down   = action == GLFW_PRESS;
+        static_cast<Window*>(glfwGetWindowUserPointer(window))->postEvent(event);
+    }
+
+    void Window::scrollCallback(GLFWwindow* window, double x, double y) {
+        WindowEvent event{ WindowEvent::Type::Scroll };
+        event.x = x;
+        event.y = y;
+        static_cast<Window*>(glfwGetWindowUserPointer(window))->postEvent(event);
+    }
+
+    void Window::focusCallback(GLFWwindow* window, int focused) {
+        WindowEvent event{ WindowEvent::Type::Focus };
+        event.down = focused != 0;
+        static_cast<Window*>(glfwGetWindowUserPointer(window))->postEvent(event);
+    }
+
+    bool Window::postEvent(const WindowEvent& event) {
+        if (events.tryPush(event)) return true;
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    VkExtent2D Window::getExtent() const {
+        const uint64_t packed = extent.load(std::memory_order_acquire);
+        return { static_cast<uint32_t>(packed >> 32), static_cast<uint32_t>(packed) };
     }
 
     void Window::init() const {
@@ -50,7 +109,8 @@ namespace vkp {
         if (!primary) return; // Defensive: avoid null deref if no monitor
         int x, y, w, h;
         glfwGetMonitorWorkarea(primary, &x, &y, &w, &h);
-        glfwSetWindowPos(window, x + (w - width) / 2, y + (h - height) / 2);
+        const VkExtent2D size = getExtent();
+        glfwSetWindowPos(window, x + (w - static_cast<int>(size.width)) / 2, y + (h - static_cast<int>(size.height)) / 2);
     }
 
     bool Window::shouldClose() const {
@@ -61,8 +121,8 @@ namespace vkp {
         glfwPollEvents();
     }
 
-    void Window::createSurface(VkInstance instance, VkSurfaceKHR* surface) const {
-        if (glfwCreateWindowSurface(instance, window, nullptr, surface) != VK_SUCCESS) {
+    void Window::createSurface(VkInstance instance, VkSurfaceKHR* surface, const VkAllocationCallbacks* allocator) const {
+        if (glfwCreateWindowSurface(instance, window, allocator, surface) != VK_SUCCESS) {
             throw std::runtime_error("failed to create window surface");
         }
     }
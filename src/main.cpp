@@ -1,9 +1,43 @@
-#include <vkp/graphics/renderer.h>
+#include <vkp/core/job_system.h>
+#include <vkp/core/software_renderer.h>
+#include <vkp/core/startup_profiler.h>
+#include <vkp/graphics/render_host.h>
+#include <vkp/graphics/renderer_conf.h>
+#include <vkp/graphics/renderer_module.h>
 #include <vkp/logger.h>
 
-int main() {
-    vkp::graphics::Renderer engine;
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    // The offscreen sequence of `conf`, rendered on the CPU.
+    int renderOnCpu(const vkp::graphics::renderer_conf& conf, const uint32_t threads, const bool scaling) {
+        if (conf.video_path != nullptr) LOG_WARN("the software renderer writes no video, only --capture frames");
+        vkp::core::SoftwareSequence sequence;
+        sequence.width         = static_cast<uint32_t>(conf.start_width);
+        sequence.height        = static_cast<uint32_t>(conf.start_height);
+        sequence.frames        = std::max(conf.offscreen_frames, 1u);
+        sequence.startTime     = conf.sequence_start;
+        sequence.timeStep      = conf.sequence_step > 0.0 ? conf.sequence_step : 1.0 / std::max(conf.video_fps, 1u);
+        sequence.threads       = threads;
+        sequence.captureDir    = conf.capture_dir;
+        sequence.captureFormat = conf.capture_format;
+        sequence.scaling       = scaling;
+        return vkp::core::renderSoftwareSequence(sequence) ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv) {
     vkp::graphics::renderer_conf conf;
+    bool     software        = false;
+    uint32_t softwareThreads = 0;
+    bool     softwareScaling = false;
+    vkp::core::JobSystem::Options jobOptions;
+    VkDebugUtilsMessageSeverityFlagsEXT vkSeverities = vkp::graphics::DebugMessageCollector::DEFAULT_SEVERITIES;
+    VkDebugUtilsMessageTypeFlagsEXT     vkTypes      = vkp::graphics::DebugMessageCollector::ALL_TYPES;
 
     conf.start_pos_x = 100;
     conf.start_pos_y = 100;
@@ -11,9 +45,144 @@ int main() {
     conf.start_height = 720;
     conf.name = "vkpipe demo v1";
 
-    if (!engine.init(conf)) {
-        LOG_ERROR("Application failed to create.");
-        return 1;
+    for (int i = 1; i < argc; ++i) {
+        // --capture <dir> [png|ppm|raw]
+        if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            conf.capture_dir = argv[++i];
+            if (i + 1 < argc && vkp::core::parseImageFileFormat(argv[i + 1], conf.capture_format)) {
+                ++i;
+            }
+        // --video <file|-> [y4m|nv12]
+        } else if (std::strcmp(argv[i], "--video") == 0 && i + 1 < argc) {
+            conf.video_path = argv[++i];
+            if (i + 1 < argc && vkp::graphics::parseVideoFormat(argv[i + 1], conf.video_format)) {
+                ++i;
+            }
+            // Keep stdout clean for the encoder.
+            if (std::strcmp(conf.video_path, "-") == 0) {
+                logger::set_console_to_stderr(true);
+            }
+        } else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            conf.video_fps = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        // --offscreen <frames> [--start <seconds>] [--step <seconds>]: render a sequence without presenting
+        } else if (std::strcmp(argv[i], "--offscreen") == 0 && i + 1 < argc) {
+            conf.offscreen_frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            conf.sequence_start = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            conf.sequence_step = std::strtod(argv[++i], nullptr);
+        // --metrics <unix:/path.sock|port>
+        } else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            conf.metrics_endpoint = argv[++i];
+        // --no-dynamic-rendering: keep render pass and framebuffer objects even where dynamic rendering works
+        } else if (std::strcmp(argv[i], "--no-dynamic-rendering") == 0) {
+            conf.dynamic_rendering = false;
+        // --no-submit-thread: submit and present on the render thread
+        } else if (std::strcmp(argv[i], "--no-submit-thread") == 0) {
+            conf.submit_thread = false;
+        // --frames <n>: close the window loop after n frames, e.g. to compare CPU frame times
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            conf.window_frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        // --vk-messages <list>: validation layer severities and types to count and log, e.g. "info,warning,error,performance"
+        } else if (std::strcmp(argv[i], "--vk-messages") == 0 && i + 1 < argc) {
+            if (!vkp::graphics::parseDebugMessageFilter(argv[++i], vkSeverities, vkTypes)) {
+                LOG_WARN("unknown word in '{}', expected verbose, info, warning, error, general, validation or performance",
+                         argv[i]);
+            }
+        // --texture <file.ktx2>: stream a texture in the background, may be repeated
+        } else if (std::strcmp(argv[i], "--texture") == 0 && i + 1 < argc) {
+            conf.textures.push_back(argv[++i]);
+        // --texture-budget <MiB>: device memory for streamed textures
+        } else if (std::strcmp(argv[i], "--texture-budget") == 0 && i + 1 < argc) {
+            conf.texture_budget_mb = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        // --temporal <off|checker|quarter>
+        } else if (std::strcmp(argv[i], "--temporal") == 0 && i + 1 < argc) {
+            if (!vkp::graphics::parseTemporalMode(argv[++i], conf.temporal_mode)) {
+                LOG_WARN("unknown temporal mode '{}', expected off, checker or quarter", argv[i]);
+            }
+        // --sdf-volume <resolution> [threshold in voxels]: march a baked distance volume
+        } else if (std::strcmp(argv[i], "--sdf-volume") == 0 && i + 1 < argc) {
+            conf.sdf_volume = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            if (i + 1 < argc) {
+                char* end = nullptr;
+                const float threshold = std::strtof(argv[i + 1], &end);
+                if (end != argv[i + 1] && *end == '\0') {
+                    conf.sdf_threshold = threshold;
+                    ++i;
+                }
+            }
+        // --sdf-benchmark <file.csv>: with --offscreen, time the analytic and baked SDF
+        } else if (std::strcmp(argv[i], "--sdf-benchmark") == 0 && i + 1 < argc) {
+            conf.sdf_benchmark = argv[++i];
+        // --software [threads]: render the offscreen sequence on the CPU, without Vulkan
+        } else if (std::strcmp(argv[i], "--software") == 0) {
+            software = true;
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') {
+                softwareThreads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+        // --software-scaling: with --software, first time the sequence on 1, 2, 4, ... threads
+        } else if (std::strcmp(argv[i], "--software-scaling") == 0) {
+            softwareScaling = true;
+        // --jobs <workers>: job system worker threads, by default one per hardware thread but one
+        } else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobOptions.workers = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        // --pin-threads: pin each job worker to its own core
+        } else if (std::strcmp(argv[i], "--pin-threads") == 0) {
+            jobOptions.pinThreads = true;
+        } else {
+            LOG_WARN("ignoring unknown argument '{}'", argv[i]);
+        }
+    }
+
+    // Started here so this thread, which also owns GLFW, is the job system's main thread.
+    vkp::core::JobSystem::configure(jobOptions);
+    vkp::core::JobSystem::get();
+
+    if (software) {
+        return renderOnCpu(conf, softwareThreads, softwareScaling);
+    }
+
+    // Constructed after parsing so the console is redirected before the device logs anything.
+    std::unique_ptr<vkp::graphics::RenderHost> host;
+    try {
+        host = std::make_unique<vkp::graphics::RenderHost>();
+    } catch (const std::runtime_error& e) {
+        // Without a usable driver an offscreen sequence can still be rendered on the CPU.
+        if (conf.offscreen_frames == 0) throw;
+        LOG_WARN("no usable Vulkan device ({}), rendering the sequence on the CPU", e.what());
+        return renderOnCpu(conf, softwareThreads, softwareScaling);
+    }
+    host->device().debugMessages().setFilter(vkSeverities, vkTypes);
+
+#ifdef VKP_HOT_RELOAD
+    // The frame logic lives in a library next to the executable and is swapped when it is rebuilt,
+    // while the window, device and swap chain stay in the host.
+    vkp::graphics::RendererModule module(vkp::graphics::RendererModule::besideExecutable(VKP_RENDERER_MODULE));
+    if (conf.offscreen_frames == 0) {
+        host->watchForReload([&module] { return module.changed(); });
+    }
+#else
+    vkp::graphics::RendererModule module(*vkpRendererModule());
+#endif
+
+    for (;;) {
+        const vkp::graphics::RendererModuleApi& api = module.api();
+        bool ok = false;
+        {
+            const std::unique_ptr<vkp::graphics::Renderer, void (*)(vkp::graphics::Renderer*)> engine(
+                api.create(*host), api.destroy);
+            if (!api.init(*engine, conf)) {
+                LOG_ERROR("Application failed to create.");
+                return 1;
+            }
+            ok = api.run(*engine);
+        }
+        if (!ok || !host->reloadRequested() || host->window().shouldClose()) {
+            return ok ? 0 : -1;
+        }
+        // Timed up to the reloaded renderer's first frame.
+        vkp::core::StartupProfiler::get().restart();
+        module.reload();
+        host->clearReload();
     }
-    return engine.run() ? 0 : -1;
 }
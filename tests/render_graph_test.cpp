@@ -0,0 +1,143 @@
+// Plans a multi-pass frame graph without a device and checks what compile() decided: which passes
+// were culled, which transients share memory and the barriers recorded around each pass.
+
+#include <vkp/graphics/render_graph.h>
+
+#include <cstdio>
+
+using namespace vkp::graphics;
+
+namespace {
+
+    int failures = 0;
+
+    void check(const bool condition, const char* what, const int line) {
+        if (condition) return;
+        std::fprintf(stderr, "render_graph_test.cpp:%d: %s\n", line, what);
+        ++failures;
+    }
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+    const RenderGraph::ImageBarrier* findImage(const RenderGraph::Barrier& barrier, const ResourceId resource) {
+        for (const auto& image : barrier.images) {
+            if (image.resource == resource) return &image;
+        }
+        return nullptr;
+    }
+
+    void noop(VkCommandBuffer, const RenderGraph&) {}
+
+} // namespace
+
+int main() {
+    constexpr VkExtent2D extent{ 1280, 720 };
+    RenderGraph graph;
+
+    ImportedImage present{};
+    present.format      = VK_FORMAT_B8G8R8A8_SRGB;
+    present.extent      = extent;
+    present.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    present.finalStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    const ResourceId output  = graph.importImage("output", present);
+    const ResourceId gbuffer = graph.createImage("gbuffer", { VK_FORMAT_R16G16B16A16_SFLOAT, extent });
+    const ResourceId depth   = graph.createImage("depth", { VK_FORMAT_D32_SFLOAT, extent });
+    const ResourceId lit     = graph.createImage("lit", { VK_FORMAT_R16G16B16A16_SFLOAT, extent });
+    const ResourceId bloom   = graph.createImage("bloom", { VK_FORMAT_R16G16B16A16_SFLOAT, extent });
+    const ResourceId debug   = graph.createImage("debug", { VK_FORMAT_R8G8B8A8_UNORM, extent });
+
+    graph.addPass("gbuffer", [&](PassBuilder& pass) {
+        pass.colorAttachment(gbuffer, VkClearColorValue{});
+        pass.depthAttachment(depth, 1.0f);
+    }, noop);
+    graph.addPass("lighting", [&](PassBuilder& pass) {
+        pass.read(gbuffer, ResourceUsage::SampledFragment);
+        pass.colorAttachment(lit, VkClearColorValue{});
+    }, noop);
+    // Nothing reads its output.
+    graph.addPass("debug", [&](PassBuilder& pass) {
+        pass.read(gbuffer, ResourceUsage::SampledFragment);
+        pass.colorAttachment(debug, VkClearColorValue{});
+    }, noop);
+    graph.addPass("bloom", [&](PassBuilder& pass) {
+        pass.read(lit, ResourceUsage::SampledCompute);
+        pass.write(bloom, ResourceUsage::StorageCompute);
+    }, noop);
+    graph.addPass("composite", [&](PassBuilder& pass) {
+        pass.read(lit, ResourceUsage::SampledFragment);
+        pass.read(bloom, ResourceUsage::SampledFragment);
+        pass.colorAttachment(output, VkClearColorValue{});
+    }, noop);
+    graph.compile();
+
+    // Culling: only the debug pass goes, and its target is never created.
+    const auto& stats = graph.stats();
+    CHECK(stats.passes == 5);
+    CHECK(stats.culledPasses == 1);
+    CHECK(graph.culled("debug"));
+    CHECK(!graph.culled("gbuffer") && !graph.culled("lighting") && !graph.culled("bloom") && !graph.culled("composite"));
+    CHECK(graph.memoryBlock(debug) < 0);
+
+    // Aliasing: depth is done before lit is first written, gbuffer before bloom.
+    CHECK(stats.transientImages == 4);
+    CHECK(stats.memoryBlocks == 2);
+    CHECK(graph.memoryBlock(depth) == graph.memoryBlock(lit));
+    CHECK(graph.memoryBlock(gbuffer) == graph.memoryBlock(bloom));
+    CHECK(graph.memoryBlock(gbuffer) != graph.memoryBlock(lit));
+    CHECK(stats.allocatedBytes < stats.transientBytes);
+
+    // The gbuffer pass discards what the previous frame left in its targets.
+    const auto& first = graph.barrierBefore("gbuffer");
+    const auto* gbufferWrite = findImage(first, gbuffer);
+    const auto* depthWrite   = findImage(first, depth);
+    CHECK(gbufferWrite && gbufferWrite->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED
+          && gbufferWrite->newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    CHECK(depthWrite && depthWrite->newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+          && depthWrite->aspect == VK_IMAGE_ASPECT_DEPTH_BIT);
+
+    // Lighting samples the gbuffer once its colour writes are done, and takes over depth's memory.
+    const auto& lighting = graph.barrierBefore("lighting");
+    const auto* gbufferRead = findImage(lighting, gbuffer);
+    CHECK(gbufferRead && gbufferRead->oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+          && gbufferRead->newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+          && gbufferRead->srcAccess == VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+          && gbufferRead->dstAccess == VK_ACCESS_SHADER_READ_BIT);
+    CHECK((lighting.srcStages & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT) != 0);
+    CHECK((lighting.srcStages & VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT) != 0);
+    CHECK((lighting.dstStages & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT) != 0);
+    const auto* litWrite = findImage(lighting, lit);
+    CHECK(litWrite && litWrite->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+
+    // Bloom is a compute pass reading lit and writing its own storage image.
+    const auto& bloomBarrier = graph.barrierBefore("bloom");
+    const auto* litRead = findImage(bloomBarrier, lit);
+    CHECK(litRead && litRead->newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    const auto* bloomWrite = findImage(bloomBarrier, bloom);
+    CHECK(bloomWrite && bloomWrite->newLayout == VK_IMAGE_LAYOUT_GENERAL);
+    CHECK((bloomBarrier.dstStages & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) != 0);
+
+    // Composite reads bloom's storage writes; lit already is in the sampled layout, and its
+    // colour write was made visible before bloom, but not yet to the fragment stage.
+    const auto& composite = graph.barrierBefore("composite");
+    const auto* bloomRead = findImage(composite, bloom);
+    CHECK(bloomRead && bloomRead->oldLayout == VK_IMAGE_LAYOUT_GENERAL
+          && bloomRead->newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+          && bloomRead->srcAccess == VK_ACCESS_SHADER_WRITE_BIT);
+    CHECK((composite.srcStages & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) != 0);
+    const auto* litResample = findImage(composite, lit);
+    CHECK(litResample && litResample->oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+          && litResample->srcAccess == VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    const auto* outputWrite = findImage(composite, output);
+    CHECK(outputWrite && outputWrite->newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    // The imported output ends up ready to present.
+    const auto* presentBarrier = findImage(graph.finalBarrier(), output);
+    CHECK(presentBarrier && presentBarrier->oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+          && presentBarrier->newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    // One batched barrier per live pass, plus the final one.
+    CHECK(stats.barriers == 5);
+
+    if (failures == 0) std::printf("render_graph_test: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}